@@ -13,6 +13,7 @@
 #include "renderer/texture_gim.h"
 #include "renderer/mesh_ndxr.h"
 #include "renderer/mesh_sm.h"
+#include "phys/collision.h"
 #include "render/bitmap.h"
 #include "zip.h"
 #include "util/xml.h"
@@ -72,7 +73,7 @@ inline void write_vert(const renderer::mesh_sm::vert &v, obj_writer &w)
 
 //------------------------------------------------------------
 
-std::string write_mesh(nya_memory::tmp_buffer_ref data, std::string folder, std::string name, float scale, zip_t *zip)
+std::string write_mesh(nya_memory::tmp_buffer_ref data, std::string folder, std::string name, float scale, zip_t *zip, phys::mesh *col_mesh = 0)
 {
     renderer::mesh_sm mesh;
     if (!mesh.load(data.get_data(), data.get_size()))
@@ -86,6 +87,14 @@ std::string write_mesh(nya_memory::tmp_buffer_ref data, std::string folder, std:
 
     std::set<int> used_tex;
 
+    std::vector<nya_math::vec3> col_tris;
+    auto add_col_tri = [&col_tris](const nya_math::vec3 &a, const nya_math::vec3 &b, const nya_math::vec3 &c)
+    {
+        col_tris.push_back(a);
+        col_tris.push_back(b);
+        col_tris.push_back(c);
+    };
+
     int group_idx = 0;
     for (auto &g: mesh.groups)
     {
@@ -118,6 +127,7 @@ std::string write_mesh(nya_memory::tmp_buffer_ref data, std::string folder, std:
                 write_vert(s.verts[2], w);
                 write_vert(s.verts[1], w);
                 w.add_face(3);
+                add_col_tri(s.verts[0].pos, s.verts[2].pos, s.verts[1].pos);
             }
             else if (vcount == 4)
             {
@@ -126,6 +136,8 @@ std::string write_mesh(nya_memory::tmp_buffer_ref data, std::string folder, std:
                 write_vert(s.verts[3], w);
                 write_vert(s.verts[1], w);
                 w.add_face(4);
+                add_col_tri(s.verts[0].pos, s.verts[2].pos, s.verts[3].pos);
+                add_col_tri(s.verts[0].pos, s.verts[3].pos, s.verts[1].pos);
             }
             else
             {
@@ -136,11 +148,13 @@ std::string write_mesh(nya_memory::tmp_buffer_ref data, std::string folder, std:
                     {
                         write_vert(s.verts[i-2], w);
                         write_vert(s.verts[i-1], w);
+                        add_col_tri(s.verts[i].pos, s.verts[i-2].pos, s.verts[i-1].pos);
                     }
                     else
                     {
                         write_vert(s.verts[i-1], w);
                         write_vert(s.verts[i-2], w);
+                        add_col_tri(s.verts[i].pos, s.verts[i-1].pos, s.verts[i-2].pos);
                     }
                     w.add_face(3);
                 }
@@ -148,6 +162,9 @@ std::string write_mesh(nya_memory::tmp_buffer_ref data, std::string folder, std:
         }
     }
 
+    if (col_mesh)
+        col_mesh->add_shape(col_tris);
+
     bool not_transparent = false;
     bool transparent = false;
     for (auto &g: mesh.groups)
@@ -185,6 +202,17 @@ std::string write_mesh(nya_memory::tmp_buffer_ref data, std::string folder, std:
 
 //------------------------------------------------------------
 
+void write_collision(phys::collision &col, zip_t *zip)
+{
+    col.build_index();
+    const auto data = col.write();
+    zip_entry_open(zip, "collision.bin");
+    zip_entry_write(zip, data.data(), data.size());
+    zip_entry_close(zip);
+}
+
+//------------------------------------------------------------
+
 bool write_texture(nya_memory::tmp_buffer_ref tex_data, std::string name, zip_t *zip)
 {
     if (!tex_data.get_size())
@@ -302,14 +330,16 @@ bool convert_location5(const void *data, size_t size, std::string name, std::str
     const int bord_size = 2;
 
     std::vector<std::string> mesh_names;
+    phys::collision col;
 
     auto obj_data = load_resource(p, 16);
     poc_file op;
     if (op.open(obj_data.get_data(), obj_data.get_size()))
     {
         mesh_names.resize(op.get_chunks_count());
+        col.meshes.resize(op.get_chunks_count());
         for (int i = 0; i < op.get_chunks_count(); ++i)
-            mesh_names[i] = write_mesh(load_resource(op, i), "objects/", base_name("object", i), scale, zip);
+            mesh_names[i] = write_mesh(load_resource(op, i), "objects/", base_name("object", i), scale, zip, &col.meshes[i]);
     }
     obj_data.free();
 
@@ -512,6 +542,7 @@ bool convert_location5(const void *data, size_t size, std::string name, std::str
                                  "y=\"" + std::to_string(o.pos.y * scale) + "\" " +
                                  "z=\"" + std::to_string(o.pos.z * scale) + "\" " +
                                  "file=\"" + mesh_names[o.idx] + "\"/>\n";
+        col.add_instance(o.idx, o.pos * scale, 0.0f);
     }
     objects_str += "</objects>\n\n";
     obj.free();
@@ -519,6 +550,8 @@ bool convert_location5(const void *data, size_t size, std::string name, std::str
     zip_entry_write(zip, objects_str.c_str(), objects_str.size());
     zip_entry_close(zip);
 
+    write_collision(col, zip);
+
     zip_close(zip);
 
     return true;
@@ -693,7 +726,7 @@ bool write_color_curve(nya_math::vec3 in_min, nya_math::vec3 in_gamma, nya_math:
 
 //------------------------------------------------------------
 
-std::string write_mesh_ndxr(nya_memory::tmp_buffer_ref data, std::string folder, const std::vector<unsigned int> &location_tex_hashes, std::string name, zip_t *zip)
+std::string write_mesh_ndxr(nya_memory::tmp_buffer_ref data, std::string folder, const std::vector<unsigned int> &location_tex_hashes, std::string name, zip_t *zip, phys::mesh *col_mesh = 0)
 {
     renderer::mesh_ndxr mesh;
     if(!mesh.load(data.get_data(), data.get_size(), nya_render::skeleton(), true))
@@ -719,6 +752,8 @@ std::string write_mesh_ndxr(nya_memory::tmp_buffer_ref data, std::string folder,
         w.add_tc(v.tc);
     }
 
+    std::vector<nya_math::vec3> col_tris;
+
     for (auto &g: mesh.groups)
     {
         int rg_idx = 0;
@@ -752,11 +787,17 @@ std::string write_mesh_ndxr(nya_memory::tmp_buffer_ref data, std::string folder,
                 }
 
                 w.add_face(mesh.indices2b[i],mesh.indices2b[i-2+flip],mesh.indices2b[i-1-flip]);
+                col_tris.push_back(mesh.verts[mesh.indices2b[i]].pos);
+                col_tris.push_back(mesh.verts[mesh.indices2b[i-2+flip]].pos);
+                col_tris.push_back(mesh.verts[mesh.indices2b[i-1-flip]].pos);
                 flip = 1 - flip;
             }
         }
     }
 
+    if (col_mesh)
+        col_mesh->add_shape(col_tris);
+
     bool transparent = false;
     //ToDo
     if (transparent)
@@ -829,9 +870,13 @@ bool convert_location6(const void *data, size_t size, std::string name, std::str
     printf("\tobjects\n");
 
     std::vector<std::string> mesh_names;
+    phys::collision col;
 
     for (auto f: loc_folder.folders[0].files)
-        mesh_names.push_back(write_mesh_ndxr(load_resource(p, f), "objects/", location_tex_hashes, base_name("object", int(mesh_names.size())), zip));
+    {
+        col.meshes.resize(col.meshes.size() + 1);
+        mesh_names.push_back(write_mesh_ndxr(load_resource(p, f), "objects/", location_tex_hashes, base_name("object", int(mesh_names.size())), zip, &col.meshes.back()));
+    }
 
     auto obj_pos_data = load_resource(p, loc_folder.files[11]);
     nya_memory::memory_reader obj_pos_reader(obj_pos_data.get_data(), obj_pos_data.get_size());
@@ -872,6 +917,8 @@ bool convert_location6(const void *data, size_t size, std::string name, std::str
             "z=\"" + std::to_string(pos.z) + "\" " +
             "group=\"" + std::to_string(group_idx) + "\" " + //ToDo
             "file=\"" + mesh_names[model_idx] + "\"/>\n";
+
+            col.add_instance(model_idx, pos, 0.0f);
         }
     }
 
@@ -881,6 +928,8 @@ bool convert_location6(const void *data, size_t size, std::string name, std::str
     zip_entry_write(zip, objects_str.c_str(), objects_str.size());
     zip_entry_close(zip);
 
+    write_collision(col, zip);
+
     printf("\tobject textures\n");
 
     for (auto tidx: loc_folder.folders[1].files)
@@ -5,11 +5,14 @@
 #include "game/mission.h"
 #include "game/deathmatch.h"
 #include "game/team_deathmatch.h"
+#include "game/battle.h"
 #include "game/free_flight.h"
 #include "game/network_client.h"
 #include "game/network_server.h"
 #include "game/hangar.h"
 #include "game/world.h"
+#include "game/fixed_step.h"
+#include "game/replay.h"
 #include "gui/menu.h"
 
 #include "scene/camera.h"
@@ -18,9 +21,12 @@
 #include "util/resources.h"
 #include "util/config.h"
 #include "util/platform.h"
+#include "util/profiler.h"
 
 #include <thread>
 #include <chrono>
+#include <sstream>
+#include <time.h>
 
 #include "GLFW/glfw3.h"
 
@@ -44,12 +50,34 @@ int main()
     config::register_var("master_volume", "10");
     config::register_var("music_volume", "5");
     config::register_var("difficulty", "hard");
+    config::register_var("sim_rate", "60");
+    config::register_var("sim_max_lag", "250");
+    config::register_var("sim_max_ticks", "8"); //per frame in network games, they don't drop lag but catch up over several frames
+    config::register_var("ai_budget", "1000");
+    config::register_var("ai_workers", "0");
+    config::register_var("net_text_events", "false");
+    config::register_var("sim_lod_coarse_dist", "8000");
+    config::register_var("sim_lod_dormant_dist", "20000");
+    config::register_var("sim_lod_coarse_interval", "100");
+    config::register_var("sim_lod_dormant_interval", "500");
+    config::register_var("record", ""); //replay file name to record offline sessions
+    config::register_var("replay", ""); //replay file name to run headless and exit
+    config::register_var("profiler", "false"); //F9 toggles, F10 writes profiler_trace
+    config::register_var("profiler_trace", "trace.json");
+    config::register_var("benchmark", ""); //bots x units list to run headless and exit, like 16x32,64x128
+    config::register_var("benchmark_ticks", "1800");
+    config::register_var("benchmark_location", "ms01");
+    config::register_var("benchmark_out", "benchmark.csv");
+
+    //replays and benchmarks don't show a window, the renderer still needs a gl context to load models and skeletons
+    const bool no_window = !config::get_var("replay").empty() || !config::get_var("benchmark").empty();
 
     platform platform;
-    if (!platform.init(config::get_var_int("screen_width"), config::get_var_int("screen_height"), "Open Horizon 7th demo"))
+    if (!platform.init(config::get_var_int("screen_width"), config::get_var_int("screen_height"), "Open Horizon 7th demo", !no_window))
         return -1;
 
-    platform.set_fullscreen(config::get_var_bool("fullscreen"), config::get_var_int("screen_width"), config::get_var_int("screen_height"));
+    if (!no_window)
+        platform.set_fullscreen(config::get_var_bool("fullscreen"), config::get_var_int("screen_width"), config::get_var_int("screen_height"));
 
     std::vector<joystick_config> joysticks;
 
@@ -74,6 +102,7 @@ int main()
     game::free_flight game_mode_ff(world);
     game::deathmatch game_mode_dm(world);
     game::team_deathmatch game_mode_tdm(world);
+    game::battle game_mode_battle(world);
     game::hangar hangar(scene);
     game::game_mode *active_game_mode = 0;
     game::plane_controls controls;
@@ -103,6 +132,146 @@ int main()
     bool viewer_mode = false;
     bool is_client = false, is_server = false;
 
+    game::replay record;
+    bool recording = false;
+
+    auto start_session = [&](const game::replay_session &s)
+    {
+        srand(s.seed);
+        world.set_seed(s.seed);
+        world.set_deterministic(recording || !config::get_var("replay").empty());
+
+        if (s.mode == "ms")
+        {
+            active_game_mode = &game_mode_ms;
+            game_mode_ms.start(s.plane.c_str(), s.color, s.mission.c_str());
+        }
+        else if (s.mode == "dm")
+        {
+            active_game_mode = &game_mode_dm;
+            game_mode_dm.start(s.plane.c_str(), s.color, 0, s.location.c_str(), s.bots_count);
+        }
+        else if (s.mode == "tdm")
+        {
+            active_game_mode = &game_mode_tdm;
+            game_mode_tdm.start(s.plane.c_str(), s.color, 0, s.location.c_str(), s.bots_count);
+        }
+        else if (s.mode == "ff")
+        {
+            active_game_mode = &game_mode_ff;
+            game_mode_ff.start(s.plane.c_str(), s.color, s.location.c_str());
+        }
+    };
+
+    auto stop_recording = [&]()
+    {
+        if (!recording)
+            return;
+
+        recording = false;
+        record.set_hash(world.get_state_hash());
+        record.save(config::get_var("record").c_str());
+    };
+
+    profiler::set_enabled(config::get_var_bool("profiler"));
+
+    if (!config::get_var("replay").empty())
+    {
+        game::replay r;
+        if (!r.load(config::get_var("replay").c_str()))
+            return -1;
+
+        scene.loading(false);
+        start_session(r.get_session());
+
+        const auto &frames = r.get_frames();
+        size_t frame = 0;
+        auto update_render = [&](size_t ticks)
+        {
+            for (; frame < frames.size() && frames[frame].ticks <= ticks; ++frame)
+                world.update_render(frames[frame].dt, frames[frame].k);
+        };
+
+        const unsigned long start_time = nya_system::get_time();
+        update_render(0);
+        for (size_t i = 0; i < r.get_ticks_count() && active_game_mode; ++i)
+        {
+            const int dt = r.get_tick(i, controls);
+            active_game_mode->update(dt, controls);
+            update_render(i + 1);
+        }
+
+        const unsigned long elapsed = nya_system::get_time() - start_time;
+        const uint32_t hash = world.get_state_hash();
+        printf("replay: %d ticks in %lums, %.3fms per tick\n", int(r.get_ticks_count()), elapsed, r.get_ticks_count() ? float(elapsed) / r.get_ticks_count() : 0.0f);
+        printf("replay: state hash %08x, recorded %08x%s\n", hash, r.get_hash(), hash == r.get_hash() ? "" : " - NONDETERMINISM DETECTED");
+
+        if (profiler::is_enabled())
+            profiler::write_chrome_trace(config::get_var("profiler_trace").c_str());
+
+        active_game_mode->end();
+        sound::release_context();
+        platform.terminate();
+        return hash == r.get_hash() ? 0 : 1;
+    }
+
+    if (!config::get_var("benchmark").empty())
+    {
+        scene.loading(false);
+        world.set_deterministic(true);
+
+        const auto planes = game::get_aircraft_ids({"fighter"});
+        const int ticks = config::get_var_int("benchmark_ticks");
+        const int sim_rate = config::get_var_int("sim_rate");
+        const int dt = 1000 / (sim_rate > 0 ? sim_rate : 60);
+        const std::string location = config::get_var("benchmark_location");
+
+        FILE *out = config::get_var("benchmark_out").empty() ? 0 : fopen(config::get_var("benchmark_out").c_str(), "wb");
+        const char *header = "bots,units,ticks,start_ms,tick_p50_ms,tick_p90_ms,tick_p99_ms,tick_max_ms,memory_mb,memory_delta_mb,"
+                             "units_full,units_coarse,units_dormant,bots_full,bots_coarse,bots_dormant\n";
+        printf("%s", header);
+        if (out)
+            fprintf(out, "%s", header);
+
+        std::istringstream list(config::get_var("benchmark"));
+        std::string size;
+        while (std::getline(list, size, ','))
+        {
+            int bots = 0, units = 0;
+            if (sscanf(size.c_str(), "%dx%d", &bots, &units) < 1)
+            {
+                printf("invalid benchmark size: %s\n", size.c_str());
+                continue;
+            }
+
+            srand(0);
+            world.set_seed(0);
+            const auto r = game_mode_battle.run_benchmark(planes.empty() ? "f22a" : planes.front().c_str(), location.c_str(), bots, units, ticks, dt);
+
+            char buf[512];
+            snprintf(buf, sizeof(buf), "%d,%d,%d,%.1f,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%d,%d,%d,%d,%d,%d\n", r.bots, r.units, r.ticks, r.start_time,
+                     r.tick_p50, r.tick_p90, r.tick_p99, r.tick_max, r.memory / 1048576.0f, r.memory_delta / 1048576.0f,
+                     r.units_lod.count[game::sim_lod_full], r.units_lod.count[game::sim_lod_coarse], r.units_lod.count[game::sim_lod_dormant],
+                     r.bots_lod.count[game::sim_lod_full], r.bots_lod.count[game::sim_lod_coarse], r.bots_lod.count[game::sim_lod_dormant]);
+            printf("%s", buf);
+            if (out)
+            {
+                fprintf(out, "%s", buf);
+                fflush(out);
+            }
+        }
+
+        if (out)
+            fclose(out);
+
+        if (profiler::is_enabled())
+            profiler::write_chrome_trace(config::get_var("profiler_trace").c_str());
+
+        sound::release_context();
+        platform.terminate();
+        return 0;
+    }
+
     gui::menu::on_action on_menu_action = [&](const std::string &event)
     {
         if (event == "start")
@@ -116,6 +285,13 @@ int main()
             const int color = atoi(menu.get_var("color").c_str());
 
             is_client = false, is_server = false;
+            game::replay_session session;
+            session.mode = menu.get_var("mode");
+            session.plane = plane;
+            session.location = location;
+            session.mission = menu.get_var("mission");
+            session.color = color;
+            session.seed = (unsigned int)time(0);
 
             scene.loading(true);
             nya_render::clear(true, true);
@@ -141,30 +317,16 @@ int main()
                 is_client = true;
             }
 
-            if (mode == "ms")
-            {
-                active_game_mode = &game_mode_ms;
-                game_mode_ms.start(plane.c_str(), color,  menu.get_var("mission").c_str());
-            }
-            else if (mode == "dm")
-            {
-                const int bots_count = (is_client || is_server) ? 0 : 11;
-
-                active_game_mode = &game_mode_dm;
-                game_mode_dm.start(plane.c_str(), color, 0, location.c_str(), bots_count);
-            }
+            if (mode == "dm")
+                session.bots_count = (is_client || is_server) ? 0 : 11;
             else if (mode == "tdm")
-            {
-                const int bots_count = (is_client || is_server) ? 0 : 7;
+                session.bots_count = (is_client || is_server) ? 0 : 7;
 
-                active_game_mode = &game_mode_tdm;
-                game_mode_tdm.start(plane.c_str(), color, 0, location.c_str(), bots_count);
-            }
-            else if (mode == "ff")
-            {
-                active_game_mode = &game_mode_ff;
-                game_mode_ff.start(plane.c_str(), color, location.c_str());
-            }
+            recording = !is_client && !is_server && !config::get_var("record").empty();
+            if (recording)
+                record.start(session);
+
+            start_session(session);
         }
         else if (event == "connect")
         {
@@ -223,6 +385,7 @@ int main()
         }
         else if (event == "exit")
         {
+            stop_recording();
             server.close();
             client.disconnect();
             platform.terminate();
@@ -235,9 +398,14 @@ int main()
 
     bool reset_camera = false;
 
+    game::fixed_step sim_step;
+    sim_step.set_rate(config::get_var_int("sim_rate"));
+
     unsigned long app_time = nya_system::get_time();
     while (!platform.should_terminate())
     {
+        profile_scope("frame");
+
         unsigned long time = nya_system::get_time();
         int dt = int(time - app_time);
 
@@ -261,13 +429,28 @@ int main()
         }
 
         if (!active_game_mode)
+        {
             menu.update(dt, menu_controls);
+            sim_step.reset();
+        }
 
         if (active_game_mode)
         {
             if (!paused)
             {
-                active_game_mode->update(speed10x ? dt * 10 : dt, controls);
+                sim_step.set_max_lag(is_client || is_server ? 0 : config::get_var_int("sim_max_lag"));
+                sim_step.set_max_ticks(is_client || is_server ? config::get_var_int("sim_max_ticks") : 0);
+                sim_step.add_time(speed10x ? dt * 10 : dt);
+                for (int sim_dt = sim_step.next_tick(); sim_dt > 0; sim_dt = sim_step.next_tick())
+                {
+                    if (recording)
+                        record.add_tick(sim_dt, controls);
+                    active_game_mode->update(sim_dt, controls);
+                }
+
+                world.update_render(dt, sim_step.get_alpha());
+                if (recording)
+                    record.add_frame(dt, sim_step.get_alpha());
 
                 //camera - tracking enemy
                 auto p = world.get_player();
@@ -404,6 +587,7 @@ int main()
             {
                 if (paused)
                     scene.pause(paused = !paused);
+                stop_recording();
                 active_game_mode->end();
                 active_game_mode = 0;
                 server.close();
@@ -432,6 +616,11 @@ int main()
             scene.camera.add_delta_rot(-controls.cam_rot.x * nya_math::constants::pi_2, -controls.cam_rot.y * nya_math::constants::pi);
         }
 
+        if (platform.was_pressed(GLFW_KEY_F9))
+            profiler::set_enabled(!profiler::is_enabled());
+        if (platform.was_pressed(GLFW_KEY_F10) && profiler::write_chrome_trace(config::get_var("profiler_trace").c_str()))
+            printf("profiler trace written to %s\n", config::get_var("profiler_trace").c_str());
+
         if (platform.was_pressed(GLFW_KEY_COMMA))
             debug_variable::set(debug_variable::get() - 1);
         if (platform.was_pressed(GLFW_KEY_PERIOD))
@@ -445,6 +634,7 @@ int main()
         }
     }
 
+    stop_recording();
     server.close();
     client.disconnect();
     sound::release_context();
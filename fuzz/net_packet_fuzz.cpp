@@ -0,0 +1,240 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+//feeds random and mutated udp packets to net_packet::read
+//usage: net_packet_fuzz [iterations] [seed], build with -fsanitize=address,undefined to catch out of bounds reads
+//with -DNET_PACKET_LIBFUZZER it's a libFuzzer target instead
+
+#include "game/network_packet.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace
+{
+//------------------------------------------------------------
+
+class fuzz_random
+{
+public:
+    explicit fuzz_random(uint32_t seed): m_state(seed ? seed : 1) {}
+
+    uint32_t next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    uint32_t get(uint32_t count) { return count ? next() % count : 0; }
+    float get_float(float from, float to) { return from + (to - from) * (next() % 65536) / 65535.0f; }
+
+private:
+    uint32_t m_state;
+};
+
+//------------------------------------------------------------
+
+const float location_half_size = 32768.0f;
+
+nya_math::vec3 random_vec(fuzz_random &r, float range)
+{
+    return nya_math::vec3(r.get_float(-range, range), r.get_float(-range, range), r.get_float(-range, range));
+}
+
+nya_math::quat random_rot(fuzz_random &r)
+{
+    return nya_math::quat(r.get_float(-1.5f, 1.5f), r.get_float(-3.1f, 3.1f), r.get_float(-3.1f, 3.1f));
+}
+
+//------------------------------------------------------------
+
+//valid packets of both types, written with and without baselines
+void make_packets(fuzz_random &r, std::vector<std::string> &result)
+{
+    game::net_quantizer q;
+    q.set_location_size(location_half_size);
+    game::net_channel sender, receiver;
+
+    for (int i = 0; i < 64; ++i)
+    {
+        game::net_packet p;
+        p.t = i % 2 ? game::net_packet::type_missiles : game::net_packet::type_planes;
+        p.client_id = r.get(16);
+        p.token = r.next();
+        p.time = r.next();
+
+        const uint32_t count = r.get(8) + 1;
+        for (uint32_t j = 0; j < count && !p.is_full(); ++j)
+        {
+            if (p.t == game::net_packet::type_planes)
+            {
+                game::net_plane s;
+                s.pos = random_vec(r, location_half_size);
+                s.vel = random_vec(r, 500.0f);
+                s.rot = random_rot(r);
+                s.ctrl_rot = random_vec(r, 1.0f);
+                s.ctrl_throttle = r.get_float(0.0f, 1.0f);
+                s.ctrl_mgun = r.get(2) != 0;
+                p.add(j, s);
+            }
+            else
+            {
+                game::net_missile s;
+                s.pos = random_vec(r, location_half_size);
+                s.vel = random_vec(r, 1000.0f);
+                s.rot = random_rot(r);
+                s.target_dir = random_vec(r, 1.0f);
+                s.target = r.get(16);
+                s.engine_started = r.get(2) != 0;
+                p.add(100 + j, s);
+            }
+        }
+
+        std::string data;
+        p.write(data, sender, q);
+        result.push_back(data);
+
+        //acked, the next ones get baselines
+        game::net_packet in;
+        if (in.read(data, receiver, q))
+            sender.on_ack(receiver.get_ack(), receiver.get_ack_bits());
+    }
+}
+
+//------------------------------------------------------------
+
+void mutate(fuzz_random &r, std::string &data)
+{
+    const int count = int(r.get(4)) + 1;
+    for (int i = 0; i < count; ++i)
+    {
+        switch (r.get(6))
+        {
+            case 0: if (!data.empty()) data[r.get(uint32_t(data.size()))] ^= char(1 << r.get(8)); break;
+            case 1: if (!data.empty()) data[r.get(uint32_t(data.size()))] = char(r.next()); break;
+            case 2: data.resize(r.get(uint32_t(data.size()) + 1)); break;
+            case 3: data.append(r.get(32), char(r.next())); break;
+            case 4: //record count, the last two header bytes
+                if (data.size() >= game::net_packet::header_size)
+                {
+                    const uint16_t c = uint16_t(r.next());
+                    memcpy(&data[game::net_packet::header_size - 2], &c, 2);
+                }
+                break;
+            case 5: if (!data.empty()) data.insert(data.begin() + r.get(uint32_t(data.size())), char(r.next())); break;
+        }
+    }
+}
+
+//------------------------------------------------------------
+
+bool is_finite(const nya_math::vec3 &v) { return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z); }
+
+//returns false if an accepted packet gives broken records
+bool fuzz_one(const void *data, size_t size, game::net_channel &c, const game::net_quantizer &q, bool &accepted)
+{
+    game::net_packet p;
+    accepted = p.read(data, size, c, q);
+    if (!accepted)
+        return true;
+
+    if (size < game::net_packet::header_size || p.t >= game::net_packet::types_count)
+        return false;
+
+    if ((p.planes.size() + p.missiles.size()) * game::net_packet::record_min_size > size - game::net_packet::header_size)
+        return false;
+
+    for (auto &pl: p.planes)
+    {
+        if (!is_finite(pl.state.pos) || !is_finite(pl.state.vel))
+            return false;
+    }
+
+    for (auto &m: p.missiles)
+    {
+        if (!is_finite(m.state.pos) || !is_finite(m.state.vel) || !is_finite(m.state.target_dir))
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------
+}
+
+#ifdef NET_PACKET_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static game::net_quantizer q;
+    static game::net_channel c;
+    q.set_location_size(location_half_size);
+    bool accepted;
+    if (!fuzz_one(data, size, c, q, accepted))
+        abort();
+    return 0;
+}
+
+#else
+
+int main(int argc, char **argv)
+{
+    const int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+    const uint32_t seed = argc > 2 ? (uint32_t)strtoul(argv[2], 0, 10) : 1;
+
+    fuzz_random r(seed);
+    std::vector<std::string> packets;
+    make_packets(r, packets);
+
+    game::net_quantizer q;
+    q.set_location_size(location_half_size);
+
+    //unchanged packets must pass
+    game::net_channel c;
+    for (auto &p: packets)
+    {
+        game::net_packet in;
+        if (!in.read(p, c, q))
+        {
+            printf("valid packet rejected\n");
+            return -1;
+        }
+    }
+
+    int accepted = 0;
+    std::string data;
+    for (int i = 0; i < iterations; ++i)
+    {
+        if (r.get(4) == 0)
+        {
+            data.resize(r.get(game::net_packet::max_size + 64));
+            for (auto &d: data)
+                d = char(r.next());
+        }
+        else
+        {
+            data = packets[r.get(uint32_t(packets.size()))];
+            mutate(r, data);
+        }
+
+        if (r.get(64) == 0)
+            c = game::net_channel();
+
+        bool read;
+        if (!fuzz_one(data.data(), data.size(), c, q, read))
+        {
+            printf("iteration %d: accepted a broken packet, seed %u\n", i, seed);
+            return -1;
+        }
+
+        accepted += read ? 1 : 0;
+    }
+
+    printf("%d iterations, %d packets accepted\n", iterations, accepted);
+    return 0;
+}
+
+#endif
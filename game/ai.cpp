@@ -29,9 +29,6 @@ void ai::update(const world &w, int dt)
             m_state = state_wander;
     }
 
-    //if (m_state != state_pursuit)
-        find_best_target();
-
     if (!m_target.expired())
     {
         p->select_target(m_target.lock());
@@ -70,7 +67,7 @@ void ai::update(const world &w, int dt)
         p->controls.rot.x = vec3::up().dot(p->phys->rot.rotate(vec3::up())) < 0.0f ? 1.0f : -1.0f;
     }
 
-    if (!p->targets.empty() && p->targets.front().locked)
+    if (m_fire && !p->targets.empty() && p->targets.front().locked)
     {
         p->controls.missile = !p->controls.missile;
         p->controls.mgun = true; //ToDo
@@ -81,6 +78,20 @@ void ai::update(const world &w, int dt)
 
 //------------------------------------------------------------
 
+void ai::think(bool search_targets)
+{
+    if (m_plane.expired())
+        return;
+
+    if (search_targets)
+        find_best_target();
+
+    auto p = m_plane.lock();
+    m_fire = !p->targets.empty() && p->targets.front().locked;
+}
+
+//------------------------------------------------------------
+
 bool ai::stabilize_course(const vec3 &dir)
 {
     //ToDo
@@ -15,9 +15,13 @@ class ai
 public:
     void set_plane(const plane_ptr &p) { m_plane = p; }
     void set_follow(const plane_ptr &p, const vec3 &formation_offset);
-    void update(const world &w, int dt);
+    void update(const world &w, int dt); //steering, cheap, every tick
+    void think(bool search_targets = true); //target selection and weapon decisions, see ai_scheduler
     void reset_state() { m_state = state_wander; }
 
+    plane_ptr get_plane() const { return m_plane.lock(); }
+    bool is_engaging() const { return m_state == state_pursuit; }
+
     ai() { reset_state(); }
 
 private:
@@ -28,6 +32,7 @@ private:
 private:
     w_ptr<plane> m_plane;
     object_wptr m_target;
+    bool m_fire = false;
 
     enum state
     {
@@ -0,0 +1,158 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "ai_scheduler.h"
+#include "world.h"
+#include "util/profiler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace game
+{
+//------------------------------------------------------------
+
+int ai_scheduler::get_interval(const ai &a, const vec3 &player_pos, bool has_player, sim_lod_tier lod) const
+{
+    auto p = a.get_plane();
+    if (!p || p->hp <= 0)
+        return -1;
+
+    if (lod == sim_lod_dormant)
+        return m_far_interval * 4;
+
+    int interval = m_far_interval;
+    if (has_player && lod == sim_lod_full)
+    {
+        const float near_dist = 3000.0f;
+        const float k = nya_math::clamp(((p->get_pos() - player_pos).length() - near_dist) / (radar_range - near_dist), 0.0f, 1.0f);
+        interval = m_near_interval + int((m_far_interval - m_near_interval) * k);
+    }
+
+    if (a.is_engaging())
+        interval /= 2;
+
+    return std::max(interval, 1);
+}
+
+//------------------------------------------------------------
+
+void ai_scheduler::update(std::vector<ai> &agents, world &w, int dt)
+{
+    profile_scope("ai");
+
+    typedef std::chrono::steady_clock clock;
+    const auto start = clock::now();
+    auto elapsed = [start]() { return (int)std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count(); };
+
+    if (m_agents.size() != agents.size())
+    {
+        m_agents.clear();
+        m_agents.resize(agents.size());
+        for (auto &a: m_agents)
+            a.wait = m_far_interval; //think asap, the budget spreads them
+    }
+
+    auto player = w.get_player();
+    const vec3 player_pos = player ? player->get_pos() : vec3();
+
+    m_due.clear();
+    m_stats.lod = sim_lod::stats();
+    for (size_t i = 0; i < agents.size(); ++i)
+    {
+        auto &a = m_agents[i];
+        auto p = agents[i].get_plane();
+        if (p)
+        {
+            a.lod = w.get_sim_lod().get_tier(p->get_pos(), a.lod);
+            ++m_stats.lod.count[a.lod];
+            if (p->phys)
+                p->phys->update_interval = w.get_sim_lod().get_interval(a.lod);
+        }
+
+        a.interval = get_interval(agents[i], player_pos, (bool)player, a.lod);
+        if (a.interval < 0)
+        {
+            a.wait = m_far_interval; //dead, think right after respawn
+            continue;
+        }
+
+        a.wait += dt;
+        if (a.wait >= a.interval)
+            m_due.push_back(i);
+    }
+
+    //most overdue first
+    std::sort(m_due.begin(), m_due.end(), [this](size_t a, size_t b)
+              { return m_agents[a].wait * m_agents[b].interval > m_agents[b].wait * m_agents[a].interval; });
+
+    m_think.clear();
+    if (m_workers > 1)
+    {
+        size_t count = m_due.size();
+        if (m_budget > 0 && m_think_cost > 0.0f)
+            count = std::min(count, std::max(size_t(1), size_t(m_budget * m_workers / m_think_cost)));
+
+        m_think.assign(m_due.begin(), m_due.begin() + count);
+        think(agents, m_think);
+    }
+    else
+    {
+        for (auto i: m_due)
+        {
+            const auto &a = m_agents[i];
+            const bool starving = a.wait >= a.interval * 4;
+            if (m_budget > 0 && !m_think.empty() && !starving && elapsed() >= m_budget)
+                break;
+
+            agents[i].think(a.lod != sim_lod_dormant);
+            m_think.push_back(i);
+        }
+    }
+
+    for (auto i: m_think)
+        m_agents[i].wait = 0;
+
+    const int time = elapsed();
+    if (!m_think.empty())
+    {
+        const size_t workers = std::max(std::min(size_t(m_workers), m_think.size()), size_t(1));
+        const float cost = float(time) * workers / m_think.size();
+        m_think_cost = m_think_cost > 0.0f ? m_think_cost * 0.9f + cost * 0.1f : cost;
+    }
+
+    m_stats.updated = (int)m_think.size();
+    m_stats.deferred = int(m_due.size() - m_think.size());
+    m_stats.overruns = m_budget > 0 && time > m_budget ? 1 : 0;
+    m_stats.total_overruns += m_stats.overruns;
+
+    for (auto &a: agents)
+        a.update(w, dt);
+}
+
+//------------------------------------------------------------
+
+void ai_scheduler::think(std::vector<ai> &agents, const std::vector<size_t> &idxs)
+{
+    const size_t workers = std::min(size_t(m_workers), idxs.size());
+    if (workers < 2)
+    {
+        for (auto i: idxs)
+            agents[i].think(m_agents[i].lod != sim_lod_dormant);
+        return;
+    }
+
+    //think only reads the world and writes the agent's own state
+    auto think_range = [this, &agents, &idxs](size_t from, size_t to)
+    {
+        profile_scope("ai think");
+        for (size_t i = from; i < to && i < idxs.size(); ++i)
+            agents[idxs[i]].think(m_agents[idxs[i]].lod != sim_lod_dormant);
+    };
+
+    const size_t chunk = (idxs.size() + workers - 1) / workers;
+    m_pool.run(workers, [&think_range, chunk](size_t i) { think_range(i * chunk, (i + 1) * chunk); });
+}
+
+//------------------------------------------------------------
+}
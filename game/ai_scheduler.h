@@ -0,0 +1,61 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "ai.h"
+#include "sim_lod.h"
+#include "util/worker_pool.h"
+
+namespace game
+{
+//------------------------------------------------------------
+
+class ai_scheduler
+{
+public:
+    void set_budget(int us) { m_budget = us; } //per tick cpu time for the think step, 0 - unlimited
+    void set_intervals(int near_ms, int far_ms) { m_near_interval = near_ms; m_far_interval = far_ms; }
+    void set_workers(int count) { m_workers = count; m_pool.set_workers(count - 1); } //0 or 1 to think on the calling thread
+
+    void update(std::vector<ai> &agents, world &w, int dt);
+    void reset() { m_agents.clear(); m_stats = stats(); }
+
+    struct stats
+    {
+        int updated = 0;
+        int deferred = 0;
+        int overruns = 0; //ticks that exceeded the budget
+        unsigned int total_overruns = 0;
+        sim_lod::stats lod; //bots per tier
+    };
+
+    const stats &get_stats() const { return m_stats; }
+
+private:
+    int get_interval(const ai &a, const vec3 &player_pos, bool has_player, sim_lod_tier lod) const;
+    void think(std::vector<ai> &agents, const std::vector<size_t> &idxs);
+
+private:
+    struct agent
+    {
+        int wait = 0;
+        int interval = 0;
+        sim_lod_tier lod = sim_lod_full;
+    };
+
+    std::vector<agent> m_agents;
+    std::vector<size_t> m_due;
+    std::vector<size_t> m_think;
+    stats m_stats;
+    float m_think_cost = 0.0f; //average, us
+    int m_budget = 1000;
+    int m_near_interval = 100;
+    int m_far_interval = 600;
+    int m_workers = 0;
+    worker_pool m_pool;
+};
+
+//------------------------------------------------------------
+}
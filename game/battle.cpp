@@ -0,0 +1,182 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "battle.h"
+#include "world.h"
+#include "util/platform.h"
+#include <algorithm>
+#include <chrono>
+
+namespace game
+{
+//------------------------------------------------------------
+
+namespace
+{
+//spreads count points over a square grid area centered at the origin
+vec3 get_grid_pos(int idx, int count, float area_size, random_sequence &r)
+{
+    const int side = std::max(int(ceilf(sqrtf(float(count)))), 1);
+    const float step = area_size / side;
+    const float jitter = step * 0.25f;
+    vec3 p;
+    p.x = (idx % side + 0.5f) * step - area_size * 0.5f + r.get(-1000, 1000) * 0.001f * jitter;
+    p.z = (idx / side + 0.5f) * step - area_size * 0.5f + r.get(-1000, 1000) * 0.001f * jitter;
+    return p;
+}
+}
+
+//------------------------------------------------------------
+
+void battle::start(const char *plane, int color, int special, const char *location, int bots_count, int units_count)
+{
+    deathmatch::start(plane, color, special, location, bots_count);
+
+    //area grows with the planes count to keep density close to the regular deathmatch
+    const float area_size = std::max(8096.0f, sqrtf(float(m_planes.size()) / 12.0f) * 8096.0f);
+
+    m_respawn_points.resize(std::max(m_planes.size(), size_t(8)));
+    auto &r = m_world.get_random();
+    for (int i = 0; i < (int)m_respawn_points.size(); ++i)
+    {
+        auto &p = m_respawn_points[i];
+        p.first = get_grid_pos(i, (int)m_respawn_points.size(), area_size, r);
+        p.first.y = m_world.get_height(p.first.x, p.first.z) + 400.0f + r.get(1000);
+        p.second = quat(0.0, 2.0 * nya_math::constants::pi * r.get(360) / 360.0f, 0.0);
+    }
+
+    for (auto &p: m_planes)
+    {
+        auto rp = get_respawn_point();
+        p->set_pos(rp.first);
+        p->set_rot(rp.second);
+    }
+
+    add_units(units_count, area_size);
+}
+
+//------------------------------------------------------------
+
+void battle::add_units(int count, float area_size)
+{
+    m_units.clear();
+    if (count <= 0)
+        return;
+
+    std::vector<const object_desc *> vehicles, objects;
+    for (auto &o: get_objects_list())
+    {
+        if (o.params.hp <= 0 || o.model.empty())
+            continue;
+
+        if (o.params.speed_max > 0.01f)
+        {
+            if (o.params.height_max < 0.01f) //ground vehicles only
+                vehicles.push_back(&o);
+        }
+        else
+            objects.push_back(&o);
+    }
+
+    if (vehicles.empty() && objects.empty())
+    {
+        printf("battle: no ground units in objects list\n");
+        return;
+    }
+
+    auto &r = m_world.get_random();
+    for (int i = 0; i < count; ++i)
+    {
+        const bool vehicle = objects.empty() || (!vehicles.empty() && i % 2 == 0);
+        const auto &list = vehicle ? vehicles : objects;
+        const auto desc = list[r.get(uint32_t(list.size()))];
+
+        auto u = m_world.add_unit(desc->id.c_str());
+        if (!u)
+            continue;
+
+        vec3 pos = get_grid_pos(i, count, area_size, r);
+        pos.y = m_world.get_height(pos.x, pos.z) + desc->y;
+
+        u->set_pos(pos);
+        u->set_yaw(angle_deg(r.get(360)));
+        u->set_align(i % 2 ? unit::align_enemy : unit::align_ally);
+
+        if (vehicle)
+        {
+            const float path_size = 1000.0f;
+            unit::path path;
+            for (int j = 0; j < 4; ++j)
+            {
+                vec3 p = pos + vec3(j == 1 || j == 2 ? path_size : 0.0f, 0.0f, j >= 2 ? path_size : 0.0f);
+                p.y = m_world.get_height(p.x, p.z);
+                path.push_back(p);
+            }
+
+            u->set_path(path, true);
+            u->set_target_search(unit::search_all);
+        }
+
+        m_units.push_back(u);
+    }
+}
+
+//------------------------------------------------------------
+
+void battle::end()
+{
+    m_units.clear();
+    deathmatch::end();
+}
+
+//------------------------------------------------------------
+
+battle::benchmark_result battle::run_benchmark(const char *plane, const char *location, int bots_count, int units_count, int ticks, int dt)
+{
+    typedef std::chrono::steady_clock clock;
+    auto get_ms = [](clock::time_point from) { return std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - from).count() / 1000.0f; };
+
+    benchmark_result r;
+    r.bots = bots_count;
+    r.units = units_count;
+
+    const size_t memory_before = platform::get_memory_usage();
+
+    const auto start_time = clock::now();
+    start(plane, 0, 0, location, bots_count, units_count);
+    r.start_time = get_ms(start_time);
+    r.units = get_units_count();
+
+    std::vector<float> times(ticks > 0 ? ticks : 0);
+    plane_controls controls;
+    for (auto &t: times)
+    {
+        const auto tick_time = clock::now();
+        update(dt, controls);
+        t = get_ms(tick_time);
+    }
+
+    r.ticks = (int)times.size();
+    r.memory = platform::get_memory_usage();
+    r.memory_delta = r.memory > memory_before ? r.memory - memory_before : 0;
+
+    if (!times.empty())
+    {
+        std::sort(times.begin(), times.end());
+        auto percentile = [&times](float p) { return times[std::min(size_t(p * times.size()), times.size() - 1)]; };
+        r.tick_p50 = percentile(0.5f);
+        r.tick_p90 = percentile(0.9f);
+        r.tick_p99 = percentile(0.99f);
+        r.tick_max = times.back();
+    }
+
+    r.units_lod = m_world.get_sim_lod().get_stats();
+    r.bots_lod = get_ai_stats().lod;
+
+    end();
+    return r;
+}
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,48 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "deathmatch.h"
+#include "units.h"
+
+namespace game
+{
+//------------------------------------------------------------
+
+//generated deathmatch with lots of bots and ground units, for scaling tests
+
+class battle: public deathmatch
+{
+public:
+    void start(const char *plane, int color, int special, const char *location, int bots_count, int units_count);
+    virtual void end() override;
+
+    int get_units_count() const { return (int)m_units.size(); }
+
+    battle(world &w): deathmatch(w) {}
+
+public:
+    struct benchmark_result
+    {
+        int bots = 0, units = 0;
+        int ticks = 0;
+        float tick_p50 = 0.0f, tick_p90 = 0.0f, tick_p99 = 0.0f, tick_max = 0.0f; //ms
+        float start_time = 0.0f; //ms
+        size_t memory = 0, memory_delta = 0; //resident bytes
+        sim_lod::stats units_lod, bots_lod; //at the last tick
+    };
+
+    //headless, fixed dt, player flies with empty controls
+    benchmark_result run_benchmark(const char *plane, const char *location, int bots_count, int units_count, int ticks, int dt);
+
+private:
+    void add_units(int count, float area_size);
+
+private:
+    std::vector<unit_ptr> m_units;
+};
+
+//------------------------------------------------------------
+}
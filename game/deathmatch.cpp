@@ -5,6 +5,7 @@
 #include "deathmatch.h"
 #include "world.h"
 #include "util/xml.h"
+#include "util/config.h"
 
 namespace game
 {
@@ -37,8 +38,12 @@ void deathmatch::start(const char *plane, int color, int special, const char *lo
     assert(!planes.empty());
 
     m_bots.clear();
+    m_ai_scheduler.reset();
+    m_ai_scheduler.set_budget(m_world.is_deterministic() ? 0 : config::get_var_int("ai_budget"));
+    m_ai_scheduler.set_workers(config::get_var_int("ai_workers"));
 
-    m_planes.push_back(m_world.add_plane(plane, m_world.get_player_name(), color, true)); //player
+    if (plane) //no player on dedicated servers
+        m_planes.push_back(m_world.add_plane(plane, m_world.get_player_name(), color, true));
 
     for (int i = 0; i < bots_count; ++i)
     {
@@ -46,7 +51,7 @@ void deathmatch::start(const char *plane, int color, int special, const char *lo
 
         ai b;
 
-        const char *plane_name = planes[rand() % planes.size()].c_str(); //ToDo
+        const char *plane_name = planes[m_world.get_random().get(uint32_t(planes.size()))].c_str(); //ToDo
         p = m_world.add_plane(plane_name, "BOT", 0, false);
         b.set_plane(p);
         m_bots.push_back(b);
@@ -66,11 +71,11 @@ void deathmatch::start(const char *plane, int color, int special, const char *lo
 
 void deathmatch::update(int dt, const plane_controls &player_controls)
 {
-    if (m_world.get_player()->hp > 0)
-        m_world.get_player()->controls = player_controls;
+    auto player = m_world.get_player();
+    if (player && player->hp > 0)
+        player->controls = player_controls;
 
-    for (auto &b: m_bots)
-        b.update(m_world, dt);
+    m_ai_scheduler.update(m_bots, m_world, dt);
 
     m_world.update(dt);
 
@@ -85,7 +90,7 @@ void deathmatch::update(int dt, const plane_controls &player_controls)
         auto p = m_world.get_plane(i);
         if (p->hp <= 0)
         {
-            auto respawn_time = p->local_game_data.get<int>("respawn_time");
+            auto respawn_time = p->local_game_data.get_int(game_data::key_respawn_time);
             if (respawn_time > 0)
             {
                 respawn_time -= dt;
@@ -95,7 +100,7 @@ void deathmatch::update(int dt, const plane_controls &player_controls)
             else
                 respawn_time = 2000;
 
-            p->local_game_data.set("respawn_time", respawn_time);
+            p->local_game_data.set(game_data::key_respawn_time, respawn_time);
         }
     }
 }
@@ -136,9 +141,9 @@ void deathmatch::on_kill(const object_ptr &k, const object_ptr &v)
 
     auto kp = m_world.get_plane(k);
     if (kp)
-        kp->net_game_data.set("score", kp->net_game_data.get<int>("score") + 1);
+        kp->net_game_data.set(game_data::key_score, kp->net_game_data.get_int(game_data::key_score) + 1);
     else
-        vp->net_game_data.set("score", vp->net_game_data.get<int>("score") - 1);
+        vp->net_game_data.set(game_data::key_score, vp->net_game_data.get_int(game_data::key_score) - 1);
 }
 
 //------------------------------------------------------------
@@ -152,7 +157,7 @@ void deathmatch::update_scores()
     {
         auto &s = score_table[i];
         s.second = m_world.get_plane(i);
-        s.first = s.second->net_game_data.get<int>("score");
+        s.first = s.second->net_game_data.get_int(game_data::key_score);
     }
 
     std::sort(score_table.rbegin(), score_table.rend());
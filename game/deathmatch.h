@@ -5,7 +5,7 @@
 #pragma once
 
 #include "game.h"
-#include "ai.h"
+#include "ai_scheduler.h"
 
 namespace game
 {
@@ -20,6 +20,8 @@ public:
 
     deathmatch(world &w): game_mode(w) {}
 
+    const ai_scheduler::stats &get_ai_stats() const { return m_ai_scheduler.get_stats(); }
+
 protected:
     void on_kill(const object_ptr &k, const object_ptr &v);
     virtual void update_scores();
@@ -33,6 +35,7 @@ protected:
 
     std::vector<plane_ptr> m_planes;
     std::vector<ai> m_bots;
+    ai_scheduler m_ai_scheduler;
 };
 
 //------------------------------------------------------------
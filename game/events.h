@@ -0,0 +1,209 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "math/quaternion.h"
+#include <functional>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+enum event_type
+{
+    event_type_explosion,
+    event_type_plane_damage,
+    event_type_plane_respawn,
+    event_type_plane_hp,
+};
+
+//pod, sent over network as is
+
+struct event_explosion
+{
+    static const event_type type = event_type_explosion;
+    nya_math::vec3 pos;
+    float radius;
+};
+
+struct event_plane_damage
+{
+    static const event_type type = event_type_plane_damage;
+    unsigned int plane_id;
+    int damage;
+};
+
+struct event_plane_respawn
+{
+    static const event_type type = event_type_plane_respawn;
+    unsigned int plane_id;
+    nya_math::vec3 pos;
+    nya_math::quat rot;
+};
+
+struct event_plane_hp
+{
+    static const event_type type = event_type_plane_hp;
+    unsigned int plane_id;
+    int hp;
+};
+
+//text form for the general messages, see world::read_text_event
+
+std::string to_string(const event_explosion &e);
+std::string to_string(const event_plane_damage &e);
+std::string to_string(const event_plane_respawn &e);
+std::string to_string(const event_plane_hp &e);
+
+//------------------------------------------------------------
+
+template<typename t> class event_ring
+{
+public:
+    void push(const t &e)
+    {
+        if (m_count == m_buf.size())
+        {
+            std::vector<t> buf(m_buf.empty() ? 16 : m_buf.size() * 2);
+            for (size_t i = 0; i < m_count; ++i)
+                buf[i] = m_buf[(m_first + i) % m_buf.size()];
+            m_buf.swap(buf);
+            m_first = 0;
+        }
+
+        m_buf[(m_first + m_count++) % m_buf.size()] = e;
+    }
+
+    bool pop(t &e)
+    {
+        if (!m_count)
+            return false;
+
+        e = m_buf[m_first];
+        m_first = (m_first + 1) % m_buf.size();
+        --m_count;
+        return true;
+    }
+
+    void clear() { m_first = m_count = 0; }
+
+private:
+    std::vector<t> m_buf;
+    size_t m_first = 0, m_count = 0;
+};
+
+//------------------------------------------------------------
+
+class event_bus
+{
+public:
+    template<typename t> void set_handler(const std::function<void(const t &e)> &h) { get<t>().handler = h; }
+
+    template<typename t> void post(const t &e) { get<t>().events.push(e); }
+
+    //to the network, see read
+    template<typename t> void send(const t &e)
+    {
+        m_outgoing.push_back((char)t::type);
+        m_outgoing.append((const char *)&e, sizeof(e));
+    }
+
+    bool has_outgoing() const { return !m_outgoing.empty(); }
+    const std::string &get_outgoing() const { return m_outgoing; }
+    void clear_outgoing() { m_outgoing.clear(); }
+
+    //posts received events
+    bool read(const std::string &data)
+    {
+        for (size_t i = 0; i < data.size();)
+        {
+            const size_t size = data.size() - i - 1;
+            const char *e = data.data() + i + 1;
+            size_t read_size = 0;
+            switch (data[i])
+            {
+                case event_type_explosion: read_size = read<event_explosion>(e, size); break;
+                case event_type_plane_damage: read_size = read<event_plane_damage>(e, size); break;
+                case event_type_plane_respawn: read_size = read<event_plane_respawn>(e, size); break;
+                case event_type_plane_hp: read_size = read<event_plane_hp>(e, size); break;
+            }
+
+            if (!read_size)
+            {
+                printf("invalid event data\n");
+                return false;
+            }
+
+            i += read_size + 1;
+        }
+
+        return true;
+    }
+
+    void dispatch()
+    {
+        dispatch(m_explosion);
+        dispatch(m_plane_damage);
+        dispatch(m_plane_respawn);
+        dispatch(m_plane_hp);
+    }
+
+    void clear()
+    {
+        m_explosion.events.clear();
+        m_plane_damage.events.clear();
+        m_plane_respawn.events.clear();
+        m_plane_hp.events.clear();
+        m_outgoing.clear();
+    }
+
+private:
+    template<typename t> struct queue
+    {
+        event_ring<t> events;
+        std::function<void(const t &e)> handler;
+    };
+
+    template<typename t> size_t read(const char *data, size_t size)
+    {
+        if (size < sizeof(t))
+            return 0;
+
+        t e;
+        memcpy(&e, data, sizeof(t));
+        post(e);
+        return sizeof(t);
+    }
+
+    template<typename t> void dispatch(queue<t> &q)
+    {
+        t e;
+        while (q.events.pop(e))
+        {
+            if (q.handler)
+                q.handler(e);
+        }
+    }
+
+    template<typename t> queue<t> &get() { return get((const t *)0); }
+    queue<event_explosion> &get(const event_explosion *) { return m_explosion; }
+    queue<event_plane_damage> &get(const event_plane_damage *) { return m_plane_damage; }
+    queue<event_plane_respawn> &get(const event_plane_respawn *) { return m_plane_respawn; }
+    queue<event_plane_hp> &get(const event_plane_hp *) { return m_plane_hp; }
+
+private:
+    queue<event_explosion> m_explosion;
+    queue<event_plane_damage> m_plane_damage;
+    queue<event_plane_respawn> m_plane_respawn;
+    queue<event_plane_hp> m_plane_hp;
+    std::string m_outgoing;
+};
+
+//------------------------------------------------------------
+}
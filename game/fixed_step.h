@@ -0,0 +1,70 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+namespace game
+{
+//------------------------------------------------------------
+
+//time is accumulated in microseconds, at 60 hz ticks are 16 or 17 ms to keep the rate exact
+
+class fixed_step
+{
+public:
+    void set_rate(int hz) { m_step_us = hz > 0 ? (hz < 1000 ? 1000000 / hz : 1000) : 0; m_step_rem_us = 0; } //0 - variable step
+    void set_max_lag(int ms) { m_max_lag = ms; } //0 - never drop time
+    void set_max_ticks(int count) { m_max_ticks = count; } //per add_time, the rest is kept for the next ones, 0 - no limit
+    int get_step() const { return m_step_us / 1000; }
+
+    void add_time(int dt)
+    {
+        m_accumulator += dt * 1000ll;
+        m_ticks = 0;
+        if (m_max_lag > 0 && m_accumulator > m_max_lag * 1000ll)
+        {
+            m_dropped_time += m_accumulator - m_max_lag * 1000ll;
+            m_accumulator = m_max_lag * 1000ll;
+        }
+    }
+
+    //returns dt for the next sim tick or 0 if there's not enough time accumulated
+    int next_tick()
+    {
+        if (m_step_us <= 0)
+        {
+            const int dt = int(m_accumulator / 1000);
+            m_accumulator -= dt * 1000ll;
+            return dt;
+        }
+
+        if (m_accumulator < m_step_us || (m_max_ticks > 0 && m_ticks >= m_max_ticks))
+            return 0;
+
+        ++m_ticks;
+        m_accumulator -= m_step_us;
+        m_step_rem_us += m_step_us;
+        const int dt = m_step_rem_us / 1000;
+        m_step_rem_us %= 1000;
+        return dt;
+    }
+
+    //0..1 part of the next tick already passed, for render interpolation
+    float get_alpha() const { return m_step_us > 0 && m_accumulator < m_step_us ? float(m_accumulator) / m_step_us : 1.0f; }
+
+    int get_dropped_time() const { return int(m_dropped_time / 1000); } //ms
+    void reset() { m_accumulator = 0; }
+
+private:
+    int m_step_us = 16666;
+    int m_step_rem_us = 0;
+    int m_max_lag = 250;
+    int m_max_ticks = 0;
+    int m_ticks = 0;
+    long long m_accumulator = 0;
+    long long m_dropped_time = 0;
+};
+
+//------------------------------------------------------------
+}
@@ -38,7 +38,7 @@ void free_flight::update(int dt, const plane_controls &player_controls)
         auto p = m_world.get_plane(i);
         if (p->hp <= 0)
         {
-            auto respawn_time = p->local_game_data.get<int>("respawn_time");
+            auto respawn_time = p->local_game_data.get_int(game_data::key_respawn_time);
             if (respawn_time > 0)
             {
                 respawn_time -= dt;
@@ -48,7 +48,7 @@ void free_flight::update(int dt, const plane_controls &player_controls)
             else
                 respawn_time = 2000;
 
-            p->local_game_data.set("respawn_time", respawn_time);
+            p->local_game_data.set(game_data::key_respawn_time, respawn_time);
         }
     }
 }
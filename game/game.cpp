@@ -8,38 +8,31 @@
 #include "math/scalar.h"
 #include "util/util.h"
 #include "util/config.h"
+#include "util/arms_params.h"
 
 namespace game
 {
 //------------------------------------------------------------
 
-static const float kmph_to_meps = 1.0 / 3.6f;
-
-//------------------------------------------------------------
-
 wpn_params::wpn_params(std::string id, std::string model)
 {
-    const std::string action = "." + id + ".action.";
-    const std::string lockon = "." + id + ".lockon.";
-    const std::string lockon_dfm = "." + id + ".lockon_dfm.";
-
     this->id = id;
     this->model = model;
 
-    auto &param = get_arms_param();
+    auto &param = params::arms_params::get(id);
 
-    lockon_range = param.get_float(lockon + "range");
-    lockon_time = param.get_float(lockon_dfm + "timeLockon") * 1000;
-    lockon_count = param.get_float(lockon + "lockonNum");
-    lockon_air = param.get_int(lockon + "target_air") > 0;
-    lockon_ground = param.get_int(lockon + "target_grd") > 0;
-    action_range = param.get_float(action + "range");
-    reload_time = param.get_float(lockon + "reload") * 1000;
+    lockon_range = param.lockon_range;
+    lockon_time = param.lockon_time;
+    lockon_count = param.lockon_count;
+    lockon_air = param.lockon_air;
+    lockon_ground = param.lockon_ground;
+    action_range = param.range;
+    reload_time = param.reload_time;
 
-    speed_init = param.get_float("." + id + ".action.speedInit") * kmph_to_meps;
-    gravity = param.get_float("." + id + ".action.gravity");
+    speed_init = param.speed_init;
+    gravity = param.gravity;
 
-    float lon_angle = param.get_float(lockon + "angle") * 0.5f * nya_math::constants::pi / 180.0f;
+    float lon_angle = param.lockon_angle * 0.5f;
     //I dunno
     if (id == "SAAM")
         lon_angle *= 0.3f;
@@ -151,25 +144,30 @@ void missile::update_homing(int dt, world &w)
 
 void missile::update(int dt, world &w)
 {
-    render->mdl.set_pos(phys->pos);
-    render->mdl.set_rot(phys->rot);
-
-    render->engine_started = phys->accel_started;
-
     if (time > 0)
         time -= dt;
 
-    if (net && !net->source)
+    //remote missiles hit planes on the host, see world::get_hit_check
+    const bool remote = net && !net->source;
+    if (remote && (!w.is_host() || time <= 0))
         return;
 
     if (!target.expired())
     {
         auto t = target.lock();
-        bool hit = line_sphere_intersect(phys->pos, phys->pos + phys->vel * (dt * 0.001f), t->get_pos(), t->get_hit_radius());
+        vec3 tpos;
+        const auto check = w.get_hit_check(owner.lock(), t, tpos);
+        if (check == world::hit_skip)
+            return;
+
+        //remote state is refreshed at the net rate, check all the way from the previous tick
+        const vec3 from = remote && last_tick.valid ? last_tick.pos : phys->pos;
+        const vec3 to = remote ? phys->pos : phys->pos + phys->vel * (dt * 0.001f);
+        bool hit = line_sphere_intersect(from, to, tpos, t->get_hit_radius());
 
         if (!hit)
         {
-            auto dir = t->get_pos() - phys->pos;
+            auto dir = tpos - phys->pos;
             hit = dir.length() < 5.0; //proximity detonation
         }
 
@@ -179,11 +177,12 @@ void missile::update(int dt, world &w)
             //if (vec3::normalize(target.lock()->phys->vel) * dir.normalize() < -0.5)  //direct shoot
             //    missile_damage *= 3;
 
-            w.spawn_explosion(phys->pos, dmg / 2.0);
+            if (!remote) //owner sends its own
+                w.spawn_explosion(phys->pos, dmg / 2.0);
 
             const bool target_alive = t->hp > 0;
             const bool hit = w.area_damage(phys->pos, dmg_radius, dmg, owner.lock());
-            if (!hit && target_alive)
+            if (!hit && target_alive && check == world::hit_apply)
             {
                 t->take_damage(dmg, w);
                 if (t->hp <= 0 )
@@ -200,14 +199,6 @@ void missile::update(int dt, world &w)
     }
 }
 
-//------------------------------------------------------------
-
-void bomb::update(int dt, world &w)
-{
-    render->mdl.set_pos(phys->pos);
-    render->mdl.set_rot(phys->rot);
-}
-
 //------------------------------------------------------------
 }
 
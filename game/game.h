@@ -9,6 +9,7 @@
 #include "sound/sound.h"
 #include "gui/hud.h"
 #include "network_data.h"
+#include "render_snapshot.h"
 #include <memory>
 #include <list>
 
@@ -113,6 +114,7 @@ struct missile
     net_missile_ptr net;
     phys::missile_ptr phys;
     renderer::missile_ptr render;
+    tick_transform last_tick;
     ivalue time;
     w_ptr<plane> owner;
     object_wptr target;
@@ -147,8 +149,6 @@ struct bomb
     fvalue dmg_radius;
     fvalue dmg;
     bvalue dead;
-
-    void update(int dt, world &w);
 };
 
 typedef ptr<bomb> bomb_ptr;
@@ -177,9 +177,5 @@ inline bool line_sphere_intersect(const vec3 &start, const vec3 &end, const vec3
     return (inter_pt - sp_center).length_sq() <= sp_radius * sp_radius;
 }
 
-//------------------------------------------------------------
-
-inline const params::text_params &get_arms_param() { static params::text_params ap("Arms/ArmsParam.txt"); return ap; }
-
 //------------------------------------------------------------
 }
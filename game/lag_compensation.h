@@ -0,0 +1,99 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "math/vector.h"
+#include <unordered_map>
+
+namespace game
+{
+//------------------------------------------------------------
+
+//recent positions of planes on the host
+//hits by remote players are checked against targets where the shooter saw them
+
+class lag_compensation
+{
+public:
+    enum
+    {
+        history_size = 32,
+        record_interval = 15, //ms, history covers about half a second
+        max_rewind = 400
+    };
+
+    void begin_update(unsigned int time) { m_time = time; ++m_frame; }
+
+    void update(const void *key, const nya_math::vec3 &pos)
+    {
+        auto &h = m_history[key];
+        h.frame = m_frame;
+
+        if (h.count > 0 && int(m_time - h.samples[h.last].time) < record_interval)
+            return;
+
+        h.last = (h.last + 1) % history_size;
+        h.samples[h.last].time = m_time;
+        h.samples[h.last].pos = pos;
+        if (h.count < history_size)
+            ++h.count;
+    }
+
+    //forget removed objects
+    void end_update()
+    {
+        for (auto it = m_history.begin(); it != m_history.end();)
+        {
+            if (it->second.frame != m_frame)
+                it = m_history.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    //view time is limited to max_rewind, false if there's no history for the key
+    bool get_pos(const void *key, unsigned int view_time, nya_math::vec3 &pos) const
+    {
+        auto it = m_history.find(key);
+        if (it == m_history.end() || !it->second.count)
+            return false;
+
+        if (int(m_time - view_time) > max_rewind)
+            view_time = m_time - max_rewind;
+
+        const history &h = it->second;
+        const sample *newer = &h.samples[h.last];
+        if (int(view_time - newer->time) >= 0)
+        {
+            pos = newer->pos;
+            return true;
+        }
+
+        for (int i = 1; i < h.count; ++i)
+        {
+            const sample &s = h.samples[(h.last + history_size - i) % history_size];
+            if (int(view_time - s.time) >= 0)
+            {
+                const float k = float(int(view_time - s.time)) / int(newer->time - s.time);
+                pos = s.pos + (newer->pos - s.pos) * k;
+                return true;
+            }
+
+            newer = &s;
+        }
+
+        pos = newer->pos; //older than the history
+        return true;
+    }
+
+private:
+    struct sample { unsigned int time = 0; nya_math::vec3 pos; };
+    struct history { sample samples[history_size]; int last = 0, count = 0; unsigned int frame = 0; };
+    std::unordered_map<const void *, history> m_history;
+    unsigned int m_time = 0, m_frame = 0;
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,113 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "match_pool.h"
+#include "util/profiler.h"
+#include <algorithm>
+
+namespace game
+{
+//------------------------------------------------------------
+
+void match_pool::set_workers(int count)
+{
+    if (!m_threads.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+
+        m_start.notify_all();
+        for (auto &t: m_threads)
+            t.join();
+        m_threads.clear();
+        m_quit = false;
+    }
+
+    //new threads wait for the next round, not the ones already run
+    unsigned int generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        generation = m_generation;
+    }
+
+    for (int i = 0; i < count; ++i)
+        m_threads.push_back(std::thread(&match_pool::work, this, generation));
+}
+
+//------------------------------------------------------------
+
+void match_pool::add(game_mode *m)
+{
+    if (m && std::find(m_matches.begin(), m_matches.end(), m) == m_matches.end())
+        m_matches.push_back(m);
+}
+
+//------------------------------------------------------------
+
+void match_pool::remove(game_mode *m)
+{
+    m_matches.erase(std::remove(m_matches.begin(), m_matches.end(), m), m_matches.end());
+}
+
+//------------------------------------------------------------
+
+void match_pool::update(int dt)
+{
+    profile_scope("matches");
+
+    m_dt = dt;
+    m_next = 0;
+
+    if (m_threads.empty() || m_matches.size() < 2)
+    {
+        update_matches();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_working = m_threads.size();
+    ++m_generation;
+    m_start.notify_all();
+    m_done.wait(lock, [this]{ return m_working == 0; });
+}
+
+//------------------------------------------------------------
+
+void match_pool::update_matches()
+{
+    const plane_controls no_player;
+    for (size_t i = m_next++; i < m_matches.size(); i = m_next++)
+    {
+        profile_scope("match update");
+        m_matches[i]->update(m_dt, no_player);
+    }
+}
+
+//------------------------------------------------------------
+
+void match_pool::work(unsigned int generation)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, generation]{ return m_quit || m_generation != generation; });
+            if (m_quit)
+                return;
+
+            generation = m_generation;
+        }
+
+        update_matches();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_working == 0)
+            m_done.notify_one();
+    }
+}
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,50 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "game.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace game
+{
+//------------------------------------------------------------
+
+//ticks independent matches on worker threads
+//every match owns its world, start and end them on the pool owner's thread
+
+class match_pool
+{
+public:
+    void set_workers(int count); //0 to update on the calling thread
+
+    void add(game_mode *m);
+    void remove(game_mode *m);
+    size_t get_count() const { return m_matches.size(); }
+
+    void update(int dt); //returns when every match is updated
+
+    ~match_pool() { set_workers(0); }
+
+private:
+    void work(unsigned int generation);
+    void update_matches();
+
+private:
+    std::vector<game_mode *> m_matches;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start, m_done;
+    unsigned int m_generation = 0;
+    size_t m_working = 0;
+    bool m_quit = false;
+    int m_dt = 0;
+    std::atomic<size_t> m_next;
+};
+
+//------------------------------------------------------------
+}
@@ -12,7 +12,7 @@ namespace game
 {
 //------------------------------------------------------------
 
-namespace { mission *current_mission = 0; }
+namespace { mission *get_mission(lua_State *state) { return (mission *)script::get_user_data(state); } }
 
 void mission::start(const char *plane, int color, const char *mission)
 {
@@ -94,6 +94,7 @@ void mission::start(const char *plane, int color, const char *mission)
         if (follow)
             u->set_follow(follow);
 
+        m_units_idx[u.get()] = m_units.size();
         m_units.push_back(mu);
     }
 
@@ -133,6 +134,7 @@ void mission::start(const char *plane, int color, const char *mission)
         if (!script.empty())
             script_res->read_all(&script[0]);
         m_script.load(script);
+        m_script.set_user_data(this);
         auto error = m_script.get_error();
         if (!error.empty())
             printf("script error: %s\n", error.c_str());
@@ -180,7 +182,6 @@ void mission::start(const char *plane, int color, const char *mission)
 
     m_finished = false;
     m_hide_hud = false;
-    current_mission = this;
     script_call("init");
     update_zones();
 
@@ -214,10 +215,8 @@ void mission::update(int dt, const plane_controls &player_controls)
         dt = 100;
 
     m_player->controls = player_controls;
-    current_mission = this;
 
-    static std::vector<std::pair<std::string, std::string> > to_call;
-    to_call.clear();
+    std::vector<std::pair<std::string, std::string> > to_call;
     for (auto &t: m_timers)
     {
         if (!t.active)
@@ -231,6 +230,7 @@ void mission::update(int dt, const plane_controls &player_controls)
         to_call.push_back({t.func, t.id});
     }
 
+    std::vector<unit_ptr> units;
     for (auto &z: m_zones)
     {
         if (!z.active)
@@ -249,8 +249,14 @@ void mission::update(int dt, const plane_controls &player_controls)
             }
         }
 
-        for (auto &u: m_units)
+        m_world.find_units(z.pos, z.radius, units);
+        for (auto &fu: units)
         {
+            auto ui = m_units_idx.find(fu.get());
+            if (ui == m_units_idx.end())
+                continue;
+
+            auto &u = m_units[ui->second];
             if (dist_xz_sq(z.pos, u.u->get_pos()) < z.radius_sq - treshold)
             {
                 if (!z.is_inside(u.u) && !z.on_enter.empty())
@@ -278,14 +284,9 @@ void mission::update(int dt, const plane_controls &player_controls)
             {
                 if (!z.on_leave.empty())
                 {
-                    for (auto &u: m_units)
-                    {
-                        if (u.u == il)
-                        {
-                            to_call.push_back({z.on_leave, u.name});
-                            break;
-                        }
-                    }
+                    auto ui = m_units_idx.find(il.get());
+                    if (ui != m_units_idx.end())
+                        to_call.push_back({z.on_leave, m_units[ui->second].name});
                 }
 
                 i.reset();
@@ -345,6 +346,7 @@ void mission::update(int dt, const plane_controls &player_controls)
 void mission::end()
 {
     m_units.clear();
+    m_units_idx.clear();
     m_player.reset();
     m_paths.clear();
     m_radio.clear();
@@ -378,6 +380,8 @@ void mission::on_kill(const object_ptr &k, const object_ptr &v)
 
 int mission::start_timer(lua_State *state)
 {
+    auto self = get_mission(state);
+
     auto args_count = script::get_args_count(state);
     if (args_count < 2)
     {
@@ -389,9 +393,9 @@ int mission::start_timer(lua_State *state)
     if (id.empty())
         return 0;
 
-    auto t = std::find_if(current_mission->m_timers.begin(), current_mission->m_timers.end(), [id](const timer &t){ return t.id == id; });
-    if (t == current_mission->m_timers.end())
-        t = current_mission->m_timers.insert(t, timer()), t->id = id;
+    auto t = std::find_if(self->m_timers.begin(), self->m_timers.end(), [id](const timer &t){ return t.id == id; });
+    if (t == self->m_timers.end())
+        t = self->m_timers.insert(t, timer()), t->id = id;
 
     t->time = script::get_int(state, 1) * 1000;
 
@@ -408,6 +412,8 @@ int mission::start_timer(lua_State *state)
 
 int mission::setup_timer(lua_State *state)
 {
+    auto self = get_mission(state);
+
     auto args_count = script::get_args_count(state);
     if (args_count < 1)
     {
@@ -419,9 +425,9 @@ int mission::setup_timer(lua_State *state)
     if (id.empty())
         return 0;
 
-    auto t = std::find_if(current_mission->m_timers.begin(), current_mission->m_timers.end(), [id](const timer &t){ return t.id == id; });
-    if (t == current_mission->m_timers.end())
-        t = current_mission->m_timers.insert(t, timer()), t->id = id;
+    auto t = std::find_if(self->m_timers.begin(), self->m_timers.end(), [id](const timer &t){ return t.id == id; });
+    if (t == self->m_timers.end())
+        t = self->m_timers.insert(t, timer()), t->id = id;
 
     if (args_count > 1)
         t->name = to_wstring(script::get_string(state, 1));
@@ -435,6 +441,8 @@ int mission::setup_timer(lua_State *state)
 
 int mission::stop_timer(lua_State *state)
 {
+    auto self = get_mission(state);
+
     auto args_count = script::get_args_count(state);
     if (args_count < 1)
     {
@@ -446,8 +454,8 @@ int mission::stop_timer(lua_State *state)
     if (id.empty())
         return 0;
 
-    auto t = std::find_if(current_mission->m_timers.begin(), current_mission->m_timers.end(), [id](const timer &t){ return t.id == id; });
-    if (t != current_mission->m_timers.end())
+    auto t = std::find_if(self->m_timers.begin(), self->m_timers.end(), [id](const timer &t){ return t.id == id; });
+    if (t != self->m_timers.end())
         t->active = false;
 
     return 0;
@@ -457,6 +465,8 @@ int mission::stop_timer(lua_State *state)
 
 int mission::set_active(lua_State *state)
 {
+    auto self = get_mission(state);
+
     auto args_count = script::get_args_count(state);
     if (args_count < 1)
     {
@@ -469,18 +479,18 @@ int mission::set_active(lua_State *state)
         return 0;
 
     bool active = args_count < 2 ? true : script::get_bool(state, 1);
-    for (auto &u: current_mission->m_units)
+    for (auto &u: self->m_units)
     {
         if (u.name != name || !u.u)
             continue;
 
         u.u->set_active(active);
         if (!u.on_init.empty())
-            current_mission->script_call(u.on_init, {u.name}), u.on_init.clear();
+            self->script_call(u.on_init, {u.name}), u.on_init.clear();
     }
 
     bool need_update_zones = false;
-    for (auto &z: current_mission->m_zones)
+    for (auto &z: self->m_zones)
     {
         if (z.name != name || z.active == active)
             continue;
@@ -490,7 +500,7 @@ int mission::set_active(lua_State *state)
     }
 
     if (need_update_zones)
-        current_mission->update_zones();
+        self->update_zones();
 
     return 0;
 }
@@ -499,6 +509,8 @@ int mission::set_active(lua_State *state)
 
 int mission::set_path(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function set_path\n");
@@ -509,12 +521,12 @@ int mission::set_path(lua_State *state)
     if (name.empty())
         return 0;
 
-    auto p = current_mission->m_paths.find(script::get_string(state, 1));
-    for (auto &u: current_mission->m_units)
+    auto p = self->m_paths.find(script::get_string(state, 1));
+    for (auto &u: self->m_units)
     {
         if (u.name == name && u.u)
         {
-            if (p == current_mission->m_paths.end())
+            if (p == self->m_paths.end())
                 u.u->set_path({}, false);
             else
                 u.u->set_path(p->second.first, p->second.second);
@@ -528,6 +540,8 @@ int mission::set_path(lua_State *state)
 
 int mission::set_follow(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function set_follow\n");
@@ -538,8 +552,8 @@ int mission::set_follow(lua_State *state)
     if (name.empty())
         return 0;
 
-    auto f = current_mission->get_object(script::get_string(state, 1));
-    for (auto &u: current_mission->m_units) if (u.name == name && u.u) u.u->set_follow(f);
+    auto f = self->get_object(script::get_string(state, 1));
+    for (auto &u: self->m_units) if (u.name == name && u.u) u.u->set_follow(f);
 
     return 0;
 }
@@ -548,6 +562,8 @@ int mission::set_follow(lua_State *state)
 
 int mission::set_target(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function set_target\n");
@@ -558,8 +574,8 @@ int mission::set_target(lua_State *state)
     if (name.empty())
         return 0;
 
-    auto t = current_mission->get_object(script::get_string(state, 1));
-    for (auto &u: current_mission->m_units) if (u.name == name && u.u) u.u->set_target(t);
+    auto t = self->get_object(script::get_string(state, 1));
+    for (auto &u: self->m_units) if (u.name == name && u.u) u.u->set_target(t);
 
     return 0;
 }
@@ -568,6 +584,8 @@ int mission::set_target(lua_State *state)
 
 int mission::set_target_search(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function set_target_search\n");
@@ -589,7 +607,7 @@ int mission::set_target_search(lua_State *state)
     else
         return 0;
 
-    for (auto &u: current_mission->m_units) if (u.name == name && u.u) u.u->set_target_search(mode);
+    for (auto &u: self->m_units) if (u.name == name && u.u) u.u->set_target_search(mode);
 
     return 0;
 }
@@ -598,6 +616,8 @@ int mission::set_target_search(lua_State *state)
 
 int mission::set_align(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function set_align\n");
@@ -621,7 +641,7 @@ int mission::set_align(lua_State *state)
     else
         return 0;
 
-    for (auto &u: current_mission->m_units) if (u.name == name && u.u) u.u->set_align(a);
+    for (auto &u: self->m_units) if (u.name == name && u.u) u.u->set_align(a);
 
     return 0;
 }
@@ -630,6 +650,8 @@ int mission::set_align(lua_State *state)
 
 int mission::set_speed(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function set_speed\n");
@@ -641,7 +663,7 @@ int mission::set_speed(lua_State *state)
         return 0;
 
     const float speed = script::get_int(state, 1);
-    for (auto &u: current_mission->m_units) if (u.name == name && u.u) u.u->set_speed(speed);
+    for (auto &u: self->m_units) if (u.name == name && u.u) u.u->set_speed(speed);
 
     return 0;
 }
@@ -650,6 +672,8 @@ int mission::set_speed(lua_State *state)
 
 int mission::set_speed_limit(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function set_speed_limit\n");
@@ -661,7 +685,7 @@ int mission::set_speed_limit(lua_State *state)
         return 0;
 
     const float speed = script::get_int(state, 1);
-    for (auto &u: current_mission->m_units) if (u.name == name && u.u) u.u->set_speed_limit(speed);
+    for (auto &u: self->m_units) if (u.name == name && u.u) u.u->set_speed_limit(speed);
 
     return 0;
 }
@@ -670,6 +694,8 @@ int mission::set_speed_limit(lua_State *state)
 
 int mission::get_height(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 1)
     {
         printf("invalid args count in function get_height\n");
@@ -679,12 +705,12 @@ int mission::get_height(lua_State *state)
     auto id = script::get_string(state, 0);
     if (id == "player")
     {
-        auto p = current_mission->m_world.get_player();
+        auto p = self->m_world.get_player();
         script::push_float(state, p ? p->get_pos().y : 0.0f);
         return 1;
     }
 
-    auto o = current_mission->get_object(id);
+    auto o = self->get_object(id);
     script::push_float(state, o ? o->get_pos().y : 0.0f);
     return 1;
 }
@@ -693,6 +719,8 @@ int mission::get_height(lua_State *state)
 
 int mission::get_pos(lua_State *state)
 {
+    auto self = get_mission(state);
+
     int args_count = script::get_args_count(state);
     if (args_count < 1)
     {
@@ -703,19 +731,19 @@ int mission::get_pos(lua_State *state)
     auto id = script::get_string(state, 0);
     if (id == "player")
     {
-        auto p = current_mission->m_world.get_player();
+        auto p = self->m_world.get_player();
         script::push_vec3(state, p ? p->get_pos() : nya_math::vec3());
         return 1;
     }
 
-    auto o = current_mission->get_object(id);
+    auto o = self->get_object(id);
     if (o)
     {
         script::push_vec3(state, o->get_pos());
         return 1;
     }
 
-    for (auto &p: current_mission->m_paths)
+    for (auto &p: self->m_paths)
     {
         if(p.first != id)
             continue;
@@ -757,6 +785,8 @@ int mission::get_pos(lua_State *state)
 
 int mission::set_pos(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function set_pos\n");
@@ -768,13 +798,13 @@ int mission::set_pos(lua_State *state)
 
     if (id == "player")
     {
-        auto p = current_mission->m_world.get_player();
+        auto p = self->m_world.get_player();
         if (p)
             p->set_pos(pos);
         return 0;
     }
 
-    for (auto &u: current_mission->m_units)
+    for (auto &u: self->m_units)
     {
         if (u.name == id)
         {
@@ -790,6 +820,8 @@ int mission::set_pos(lua_State *state)
 
 int mission::destroy(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 1)
     {
         printf("invalid args count in function destroy\n");
@@ -799,14 +831,14 @@ int mission::destroy(lua_State *state)
     std::string name = script::get_string(state, 0);
     if (name == "player")
     {
-        current_mission->m_world.get_player()->take_damage(9000, current_mission->m_world);
+        self->m_world.get_player()->take_damage(9000, self->m_world);
         return 0;
     }
 
     if (name.empty())
         return 0;
 
-    for (auto &u: current_mission->m_units) if (u.name == name && u.u) u.u->take_damage(9000, current_mission->m_world);
+    for (auto &u: self->m_units) if (u.name == name && u.u) u.u->take_damage(9000, self->m_world);
 
     return 0;
 }
@@ -815,6 +847,8 @@ int mission::destroy(lua_State *state)
 
 int mission::setup_radio(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 3)
     {
         printf("invalid args count in function setup_radio\n");
@@ -825,7 +859,7 @@ int mission::setup_radio(lua_State *state)
     if (id.empty())
         return 0;
 
-    auto &r = current_mission->m_radio[id];
+    auto &r = self->m_radio[id];
     r.first = to_wstring(script::get_string(state, 1));
     r.second = gui::hud::white;
     auto cs = script::get_string(state, 2);
@@ -843,8 +877,10 @@ int mission::setup_radio(lua_State *state)
 
 int mission::clear_radio(lua_State *state)
 {
-    current_mission->m_radio_messages.clear();
-    current_mission->set_radio_message({});
+    auto self = get_mission(state);
+
+    self->m_radio_messages.clear();
+    self->set_radio_message({});
     return 0;
 }
 
@@ -852,6 +888,8 @@ int mission::clear_radio(lua_State *state)
 
 int mission::add_radio(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 2)
     {
         printf("invalid args count in function add_radio\n");
@@ -859,15 +897,15 @@ int mission::add_radio(lua_State *state)
     }
 
     auto id = script::get_string(state, 0);
-    auto r = current_mission->m_radio.find(id);
-    if (r == current_mission->m_radio.end())
+    auto r = self->m_radio.find(id);
+    if (r == self->m_radio.end())
         return 0;
 
     const int time = script::get_args_count(state) > 2 ? script::get_int(state, 2) * 1000 : 2000;
-    current_mission->m_radio_messages.push_back({id, to_wstring(script::get_string(state, 1)), time});
+    self->m_radio_messages.push_back({id, to_wstring(script::get_string(state, 1)), time});
 
-    if (current_mission->m_radio_messages.size() == 1)
-        current_mission->set_radio_message(current_mission->m_radio_messages.back());
+    if (self->m_radio_messages.size() == 1)
+        self->set_radio_message(self->m_radio_messages.back());
     return 0;
 }
 
@@ -875,16 +913,18 @@ int mission::add_radio(lua_State *state)
 
 int mission::set_hud_visible(lua_State *state)
 {
+    auto self = get_mission(state);
+
     if (script::get_args_count(state) < 1)
     {
         printf("invalid args count in function set_hud_visible\n");
         return 0;
     }
 
-    if (current_mission->m_finished)
+    if (self->m_finished)
         return 0;
 
-    current_mission->m_hide_hud = !script::get_bool(state, 0);
+    self->m_hide_hud = !script::get_bool(state, 0);
     return 0;
 }
 
@@ -892,11 +932,13 @@ int mission::set_hud_visible(lua_State *state)
 
 int mission::mission_clear(lua_State *state)
 {
-    if (current_mission->m_finished)
+    auto self = get_mission(state);
+
+    if (self->m_finished)
         return 0;
 
-    current_mission->m_world.popup_mission_clear();
-    current_mission->m_finished = true;
+    self->m_world.popup_mission_clear();
+    self->m_finished = true;
     return 0;
 }
 
@@ -904,10 +946,12 @@ int mission::mission_clear(lua_State *state)
 
 int mission::mission_update(lua_State *state)
 {
-    if (current_mission->m_finished)
+    auto self = get_mission(state);
+
+    if (self->m_finished)
         return 0;
 
-    current_mission->m_world.popup_mission_update();
+    self->m_world.popup_mission_update();
     return 0;
 }
 
@@ -915,11 +959,13 @@ int mission::mission_update(lua_State *state)
 
 int mission::mission_fail(lua_State *state)
 {
-    if (current_mission->m_finished)
+    auto self = get_mission(state);
+
+    if (self->m_finished)
         return 0;
 
-    current_mission->m_world.popup_mission_fail();
-    current_mission->m_finished = true;
+    self->m_world.popup_mission_fail();
+    self->m_finished = true;
     return 0;
 }
 
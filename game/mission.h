@@ -92,6 +92,7 @@ private:
     };
 
     std::vector<mission_unit> m_units;
+    std::map<const object *, size_t> m_units_idx;
     std::string m_player_on_destroy;
 
 private:
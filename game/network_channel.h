@@ -0,0 +1,467 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "network_data.h"
+#include <unordered_map>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+//state packed into fixed fields, records only carry the fields that differ from the baseline
+
+struct net_quantized
+{
+    enum { max_size = 32 };
+    uint8_t data[max_size] = {};
+
+    struct layout
+    {
+        int count;
+        uint8_t offset[8], size[8];
+    };
+
+    static const layout &get_plane_layout()
+    {
+        //pos, vel, rot, ctrl_rot, throttle, brake, flags
+        static const layout l = { 7, { 0, 8, 14, 18, 21, 22, 23 }, { 8, 6, 4, 3, 1, 1, 1 } };
+        return l;
+    }
+
+    static const layout &get_missile_layout()
+    {
+        //pos, vel, rot, target_dir, target, flags
+        static const layout l = { 6, { 0, 8, 14, 18, 24, 28 }, { 8, 6, 4, 6, 4, 1 } };
+        return l;
+    }
+
+    bool is_equal(const layout &l, int field, const net_quantized &q) const
+    {
+        return memcmp(data + l.offset[field], q.data + l.offset[field], l.size[field]) == 0;
+    }
+};
+
+//------------------------------------------------------------
+
+class net_quantizer
+{
+public:
+    //positions are relative to the location bounds, outside ones are clamped
+    void set_location_size(float half_size) { m_half_size = half_size > 1.0f ? half_size : 1.0f; }
+
+    void quantize(const net_plane &p, net_quantized &q) const
+    {
+        set_pos(q, 0, p.pos);
+        set_vec(q, 8, p.vel, max_speed);
+        set_rot(q, 14, p.rot);
+        for (int i = 0; i < 3; ++i)
+            q.data[18 + i] = uint8_t(int8_t(to_int(p.ctrl_rot[i], 1.0f, 127)));
+        q.data[21] = to_byte(p.ctrl_throttle);
+        q.data[22] = to_byte(p.ctrl_brake);
+        q.data[23] = (p.ctrl_mgun ? 1 : 0) | (p.ctrl_mgp ? 2 : 0);
+    }
+
+    void dequantize(const net_quantized &q, net_plane &p) const
+    {
+        p.pos = get_pos(q, 0);
+        p.vel = get_vec(q, 8, max_speed);
+        p.rot = get_rot(q, 14);
+        for (int i = 0; i < 3; ++i)
+            p.ctrl_rot[i] = int8_t(q.data[18 + i]) / 127.0f;
+        p.ctrl_throttle = q.data[21] / 255.0f;
+        p.ctrl_brake = q.data[22] / 255.0f;
+        p.ctrl_mgun = (q.data[23] & 1) != 0;
+        p.ctrl_mgp = (q.data[23] & 2) != 0;
+    }
+
+    void quantize(const net_missile &m, net_quantized &q) const
+    {
+        set_pos(q, 0, m.pos);
+        set_vec(q, 8, m.vel, max_speed);
+        set_rot(q, 14, m.rot);
+        set_vec(q, 18, m.target_dir, 1.0f);
+        const uint32_t target = m.target;
+        memcpy(q.data + 24, &target, 4);
+        q.data[28] = m.engine_started ? 1 : 0;
+    }
+
+    void dequantize(const net_quantized &q, net_missile &m) const
+    {
+        m.pos = get_pos(q, 0);
+        m.vel = get_vec(q, 8, max_speed);
+        m.rot = get_rot(q, 14);
+        m.target_dir = get_vec(q, 18, 1.0f);
+        uint32_t target;
+        memcpy(&target, q.data + 24, 4);
+        m.target = target;
+        m.engine_started = (q.data[28] & 1) != 0;
+    }
+
+private:
+    static int to_int(float v, float range, int max)
+    {
+        const float f = v / range * max;
+        if (!(f > -max))
+            return -max;
+
+        return f < max ? int(floorf(f + 0.5f)) : max;
+    }
+
+    static uint8_t to_byte(float v) { return uint8_t(to_uint(v, 1.0f, 8)); }
+
+    //x and z 21 bit, y 22 bit
+    void set_pos(net_quantized &q, int offset, const nya_math::vec3 &p) const
+    {
+        const uint64_t x = to_uint(p.x + m_half_size, m_half_size * 2.0f, 21);
+        const uint64_t z = to_uint(p.z + m_half_size, m_half_size * 2.0f, 21);
+        const uint64_t y = to_uint(p.y - min_height, max_height - min_height, 22);
+        const uint64_t v = x | (z << 21) | (y << 42);
+        memcpy(q.data + offset, &v, 8);
+    }
+
+    nya_math::vec3 get_pos(const net_quantized &q, int offset) const
+    {
+        uint64_t v;
+        memcpy(&v, q.data + offset, 8);
+        const float s = m_half_size * 2.0f / ((1 << 21) - 1);
+        const float sy = (max_height - min_height) / ((1 << 22) - 1);
+        return nya_math::vec3((v & 0x1fffff) * s - m_half_size, (v >> 42) * sy + min_height, ((v >> 21) & 0x1fffff) * s - m_half_size);
+    }
+
+    static uint64_t to_uint(float v, float range, int bits)
+    {
+        const uint32_t max = (1u << bits) - 1;
+        const float f = v / range * max;
+        if (!(f > 0.0f))
+            return 0;
+
+        return f < max ? uint32_t(f + 0.5f) : max;
+    }
+
+    static void set_vec(net_quantized &q, int offset, const nya_math::vec3 &v, float range)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            const int16_t c = int16_t(to_int(v[i], range, 32767));
+            memcpy(q.data + offset + i * 2, &c, 2);
+        }
+    }
+
+    static nya_math::vec3 get_vec(const net_quantized &q, int offset, float range)
+    {
+        nya_math::vec3 v;
+        for (int i = 0; i < 3; ++i)
+        {
+            int16_t c;
+            memcpy(&c, q.data + offset + i * 2, 2);
+            v[i] = c * range / 32767;
+        }
+
+        return v;
+    }
+
+    //smallest three: index of the largest component and three others, 10 bit each
+    static void set_rot(net_quantized &q, int offset, const nya_math::quat &r)
+    {
+        const float c[4] = { r.v.x, r.v.y, r.v.z, r.w };
+        int largest = 0;
+        for (int i = 1; i < 4; ++i)
+        {
+            if (fabsf(c[i]) > fabsf(c[largest]))
+                largest = i;
+        }
+
+        const float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+        uint32_t v = largest;
+        for (int i = 0, shift = 2; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+
+            v |= uint32_t(to_int(c[i] * sign, max_rot_component, 511) + 511) << shift;
+            shift += 10;
+        }
+
+        memcpy(q.data + offset, &v, 4);
+    }
+
+    static nya_math::quat get_rot(const net_quantized &q, int offset)
+    {
+        uint32_t v;
+        memcpy(&v, q.data + offset, 4);
+
+        float c[4];
+        const int largest = v & 3;
+        float sum = 0.0f;
+        for (int i = 0, shift = 2; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+
+            c[i] = (int((v >> shift) & 1023) - 511) * max_rot_component / 511;
+            sum += c[i] * c[i];
+            shift += 10;
+        }
+
+        c[largest] = sum < 1.0f ? sqrtf(1.0f - sum) : 0.0f;
+
+        nya_math::quat r;
+        r.v.x = c[0], r.v.y = c[1], r.v.z = c[2], r.w = c[3];
+        return r;
+    }
+
+private:
+    float m_half_size = 65536.0f;
+    static constexpr float min_height = -2048.0f;
+    static constexpr float max_height = 30720.0f;
+    static constexpr float max_speed = 2048.0f;
+    static constexpr float max_rot_component = 0.70710678f;
+};
+
+//------------------------------------------------------------
+
+struct net_stats
+{
+    unsigned int client_id = 0;
+    uint64_t bytes_sent = 0, bytes_received = 0;
+    unsigned int sent_per_second = 0, received_per_second = 0;
+
+    //tcp messages, batched into frames once per update
+    uint64_t tcp_messages_sent = 0, tcp_frames_sent = 0, tcp_bytes_sent = 0;
+    uint64_t tcp_bytes_received = 0;
+
+    int rtt = 0; //ms, estimated by the client's clock sync
+};
+
+//------------------------------------------------------------
+
+//ms from sending a state to receiving it, by the synced clock
+
+struct net_latency
+{
+    enum { bucket_size = 5, buckets_count = 200 }; //ms, last bucket is a second and more
+
+    uint32_t buckets[buckets_count] = {};
+    uint64_t count = 0;
+
+    void add(int ms)
+    {
+        ++buckets[ms <= 0 ? 0 : std::min(ms / bucket_size, buckets_count - 1)];
+        ++count;
+    }
+
+    void merge(const net_latency &l)
+    {
+        for (int i = 0; i < buckets_count; ++i)
+            buckets[i] += l.buckets[i];
+        count += l.count;
+    }
+
+    //upper bound of the bucket, 0..1
+    int get_percentile(float p) const
+    {
+        uint64_t sum = 0;
+        for (int i = 0; i < buckets_count; ++i)
+        {
+            sum += buckets[i];
+            if (sum > 0 && sum >= p * count)
+                return (i + 1) * bucket_size;
+        }
+
+        return 0;
+    }
+
+    void clear() { *this = net_latency(); }
+};
+
+//------------------------------------------------------------
+
+//sequence numbers, acks and the last states sent to and received from one peer
+
+class net_channel
+{
+public:
+    enum { history_size = 32 };
+
+    //sender
+
+    uint16_t next_seq()
+    {
+        const uint16_t seq = m_seq++;
+        m_acked[seq % acked_size] = invalid_ack;
+        if ((seq & 255) == 0)
+            prune(seq);
+        return seq;
+    }
+
+    //newest sent state the peer has, 0 if none
+    const net_quantized *get_baseline(uint32_t id, uint16_t &seq) const
+    {
+        auto it = m_sent.find(id);
+        if (it == m_sent.end())
+            return 0;
+
+        const auto &h = it->second;
+        for (int i = 0; i < h.count; ++i)
+        {
+            const auto &e = h.entries[(h.next + history_size - 1 - i) % history_size];
+            if (m_acked[e.seq % acked_size] == e.seq)
+            {
+                seq = e.seq;
+                return &e.q;
+            }
+        }
+
+        return 0;
+    }
+
+    void add_sent(uint32_t id, uint16_t seq, const net_quantized &q) { m_sent[id].add(seq, q); }
+
+    void on_ack(uint16_t ack, uint32_t bits)
+    {
+        m_acked[ack % acked_size] = ack;
+        for (int i = 0; i < 32; ++i)
+        {
+            if (bits & (1u << i))
+            {
+                const uint16_t s = uint16_t(ack - 1 - i);
+                m_acked[s % acked_size] = s;
+            }
+        }
+    }
+
+    //receiver
+
+    void on_receive(uint16_t seq)
+    {
+        if (!m_has_ack)
+        {
+            m_has_ack = true;
+            m_ack = seq;
+            m_ack_bits = 0;
+            return;
+        }
+
+        const int diff = int16_t(seq - m_ack);
+        if (diff > 0)
+        {
+            m_ack_bits = diff < 32 ? (m_ack_bits << diff) | (1u << (diff - 1)) : (diff == 32 ? 1u << 31 : 0);
+            m_ack = seq;
+        }
+        else if (diff < 0 && diff >= -32)
+            m_ack_bits |= 1u << (-diff - 1);
+    }
+
+    bool has_ack() const { return m_has_ack; }
+    uint16_t get_ack() const { return m_ack; }
+    uint32_t get_ack_bits() const { return m_ack_bits; }
+
+    const net_quantized *get_received(uint32_t id, uint16_t seq) const
+    {
+        auto it = m_received.find(id);
+        if (it == m_received.end())
+            return 0;
+
+        const auto &h = it->second;
+        for (int i = 0; i < h.count; ++i)
+        {
+            if (h.entries[i].seq == seq)
+                return &h.entries[i].q;
+        }
+
+        return 0;
+    }
+
+    void add_received(uint32_t id, uint16_t seq, const net_quantized &q) { m_received[id].add(seq, q); m_last_received_seq = seq; }
+
+public:
+    //bytes over the udp channel
+    uint64_t bytes_sent = 0, bytes_received = 0;
+
+    //per second rates are updated once a second
+    void update_stats(unsigned int time)
+    {
+        if (!m_stats_time)
+            m_stats_time = time;
+
+        const unsigned int dt = time - m_stats_time;
+        if (dt < 1000)
+            return;
+
+        m_stats.sent_per_second = (unsigned int)((bytes_sent - m_stats.bytes_sent) * 1000 / dt);
+        m_stats.received_per_second = (unsigned int)((bytes_received - m_stats.bytes_received) * 1000 / dt);
+        m_stats.bytes_sent = bytes_sent;
+        m_stats.bytes_received = bytes_received;
+        m_stats_time = time;
+    }
+
+    net_stats get_stats() const
+    {
+        net_stats s = m_stats;
+        s.bytes_sent = bytes_sent, s.bytes_received = bytes_received;
+        return s;
+    }
+
+    void reset() { *this = net_channel(); }
+
+    net_channel() { for (auto &a: m_acked) a = invalid_ack; }
+
+private:
+    struct history
+    {
+        struct entry { uint16_t seq = 0; net_quantized q; };
+        entry entries[history_size];
+        int count = 0, next = 0;
+
+        void add(uint16_t seq, const net_quantized &q)
+        {
+            entries[next].seq = seq, entries[next].q = q;
+            next = (next + 1) % history_size;
+            if (count < history_size)
+                ++count;
+        }
+
+        uint16_t get_last_seq() const { return entries[(next + history_size - 1) % history_size].seq; }
+    };
+
+    //drops states of objects that weren't sent or received for a while
+    void prune(uint16_t seq)
+    {
+        for (auto m: { &m_sent, &m_received })
+        {
+            const uint16_t last = m == &m_sent ? seq : m_last_received_seq;
+            for (auto it = m->begin(); it != m->end();)
+            {
+                if (int16_t(last - it->second.get_last_seq()) > 1024)
+                    it = m->erase(it);
+                else
+                    ++it;
+            }
+        }
+    }
+
+    enum { acked_size = 1024 };
+    static const uint32_t invalid_ack = 0xffffffff;
+
+    uint16_t m_seq = 0;
+    uint32_t m_acked[acked_size];
+    std::unordered_map<uint32_t, history> m_sent;
+
+    bool m_has_ack = false;
+    uint16_t m_ack = 0;
+    uint32_t m_ack_bits = 0;
+    uint16_t m_last_received_seq = 0;
+    std::unordered_map<uint32_t, history> m_received;
+
+    unsigned int m_stats_time = 0;
+    net_stats m_stats;
+};
+
+//------------------------------------------------------------
+}
@@ -5,7 +5,6 @@
 #include "network_client.h"
 #include "network_helpers.h"
 #include "system/system.h"
-#include "miso/protocol/app_protocol_simple.h"
 #include "miso/ipv4.h"
 
 #include <thread>
@@ -17,15 +16,14 @@ namespace game
 
 bool network_client::connect(const char *address, short port)
 {
-    if (!address || m_client.is_open())
+    if (!address || m_io.is_running() || m_client.is_open())
         return false;
 
     m_error.clear();
 
     const int timeout = 2000;
 
-    static miso::app_protocol_simple protocol;
-    m_client.set_app_protocol(&protocol);
+    m_client.set_app_protocol(&m_protocol);
     if (!m_client.connect_wait(miso::ipv4_address(address), port, timeout))
     {
         m_error = "Unable to connect";
@@ -71,6 +69,15 @@ bool network_client::connect(const char *address, short port)
                 {
                     ss >> m_id;
                     ss >> m_last_obj_id;
+
+                    m_udp_token = 0;
+                    ss >> m_udp_token;
+                    m_channel.reset();
+                    if (m_udp_token && m_udp.open())
+                        m_udp_server = udp_socket::resolve(address, port);
+
+                    m_last_io_send_time = nya_system::get_time();
+                    m_io.start([this](net_io &io) { this->poll_io(io); }, &m_udp);
                     return true;
                 }
 
@@ -92,166 +99,311 @@ bool network_client::connect(const char *address, short port)
 
 void network_client::start()
 {
+    if (!m_io.is_open())
+        return;
+
+    m_start_requested = true; //sent once the clock is synced, see update
+}
+
+//------------------------------------------------------------
+
+void network_client::disconnect()
+{
+    m_planes.clear();
+
+    m_io.stop();
+    m_udp.close();
+    m_udp_server = udp_socket::address();
+    m_udp_ready = false;
+    m_channel.reset();
+    m_clock.reset();
+    m_start_requested = m_started = false;
+    m_plane_snapshots.clear();
+    m_missile_snapshots.clear();
+    m_latency.clear();
+
     if (!m_client.is_open())
         return;
 
-    m_client.send_message("sync_time");
-    bool ready = false;
-    while (m_client.is_connected() && !ready)
+    m_client.send_message("disconnect");
+    m_client.disconnect();
+}
+
+//------------------------------------------------------------
+
+template<typename rs, typename snapshots, typename state> bool receive_object(rs &objs, snapshots &s, unsigned int client_id, unsigned int t, unsigned int id,
+                                                                          const state &from, unsigned int time, net_latency &l)
+{
+    l.add(int(time - t));
+
+    auto o = objs.get(id);
+    if (!o || o->r.client_id == client_id)
+        return false;
+
+    state st = *o->net;
+    net_packet::apply(from, st);
+    s[id].add(t, st, time);
+    o->last_time = std::max(o->last_time, t);
+    return true;
+}
+
+//------------------------------------------------------------
+
+template<typename rs, typename snapshots> void network_client::interpolate(rs &objs, snapshots &s)
+{
+    for (auto it = s.begin(); it != s.end();)
     {
-        m_client.update();
-        for (int j = 0; j < m_client.get_message_count(); ++j)
+        auto o = objs.get(it->first);
+        if (!o)
         {
-            if(m_client.get_message(j)=="ready")
-                ready = true;
+            it = s.erase(it);
+            continue;
         }
+
+        auto state = *o->net;
+        if (!o->net->source && it->second.sample(m_time, state, m_interp_stats))
+            net_packet::apply(state, *o->net);
+        ++it;
     }
+}
 
-    const auto time = nya_system::get_time();
-    m_client.send_message("sync");
+//------------------------------------------------------------
+
+//network thread, the only one that touches the sockets while connected
+void network_client::poll_io(net_io &io)
+{
+    const unsigned long now = nya_system::get_time();
 
-    ready = false;
-    while (m_client.is_connected() && !ready)
+    net_io_msg m;
+    while (io.get_posted(m))
     {
-        m_client.update();
-        for (int j = 0; j < m_client.get_message_count(); ++j)
+        if (m.t == net_io_msg::type_tcp)
         {
-            std::istringstream ss(m_client.get_message(j));
-            std::string command;
-            ss >> command;
-            if (command == "time")
-                ss >> m_time, ready = true;
+            m_client.send_message(m.data);
+            m_last_io_send_time = now;
         }
+        else if (m.t == net_io_msg::type_udp)
+            m_udp.send(m.address, m.data);
+        else if (m.t == net_io_msg::type_disconnect)
+            m_client.disconnect();
     }
 
-    auto ping = nya_system::get_time() - time;
-    m_time += ping / 2; // client->server->client, assume symmetric lag
+    if (!m_client.is_open())
+    {
+        io.set_open(false);
+        return;
+    }
+
+    //the sim thread might be busy loading
+    const unsigned int keepalive_interval = 1000;
+    if (now - m_last_io_send_time > keepalive_interval)
+    {
+        m_client.send_message("keepalive");
+        m_last_io_send_time = now;
+    }
 
-    m_client.send_message("start");
+    m_client.update();
+
+    std::vector<std::string> msgs;
+    for (size_t i = 0; i < m_client.get_message_count(); ++i)
+    {
+        auto &f = m_client.get_message(i);
+        if (!msg_batch::is_batch(f))
+            msgs.assign(1, f);
+        else if (!msg_batch::split(f, msgs))
+        {
+            printf("invalid batch\n");
+            continue;
+        }
+
+        for (auto &s: msgs)
+        {
+            net_io_msg t;
+            t.parsed = parse_tcp_msg(s);
+            t.data = std::move(s);
+            io.deliver(std::move(t));
+        }
+    }
+
+    net_io_msg u;
+    u.t = net_io_msg::type_udp;
+    while (m_udp.receive(u.data, u.address))
+        io.deliver(std::move(u));
+
+    io.set_open(m_client.is_open());
 }
 
 //------------------------------------------------------------
 
-void network_client::disconnect()
+void network_client::update()
 {
-    m_planes.clear();
+    net_io_msg m;
+    while (m_io.receive(m))
+    {
+        if (m.t == net_io_msg::type_tcp && m.parsed)
+            process_msg(*m.parsed);
+        else if (m.t == net_io_msg::type_tcp)
+            process_msg(m.data);
+        else if (m.t == net_io_msg::type_udp)
+            receive_udp(m.data, m.address);
+    }
 
-    if (!m_client.is_open())
+    //remote objects are shown a bit in the past, between received states
+    interpolate(m_planes, m_plane_snapshots);
+    interpolate(m_missiles, m_missile_snapshots);
+
+    if (!m_io.is_open())
         return;
 
-    m_client.send_message("disconnect");
-    m_client.disconnect();
+    const unsigned int now = (unsigned int)nya_system::get_time();
+    if (m_clock.need_ping(now))
+    {
+        m_io.post_tcp(0, "ping " + std::to_string(now) + " " + std::to_string(m_clock.get_rtt()) + " " + std::to_string(get_interp_delay()));
+        m_clock.on_ping(now);
+    }
+
+    if (m_start_requested && m_clock.is_ready())
+    {
+        m_time = m_last_send_time = m_clock.get_server_time(now);
+        m_io.post_tcp(0, "start");
+        m_start_requested = false;
+        m_started = true;
+    }
 }
 
 //------------------------------------------------------------
 
-template<typename rs> bool receive_object(rs &objs, unsigned int client_id, std::istringstream &is, unsigned int time)
+void network_client::process_msg(const net_tcp_msg &m)
 {
-    unsigned int t, id;
-    is >> t, is >> id;
-
-    for (auto &o: objs.objects)
+    switch (m.t)
     {
-        if (o.r.id == id && o.r.client_id != client_id)
-        {
-            if (o.last_time > time)
-                return false;
-
-            read(is, o.net);
-            const int time_fix = int(time - t);
-            o.net->pos += o.net->vel * (0.001f * time_fix);
-            o.last_time = t;
-            return true;
-        }
+        case net_tcp_msg::type_plane: receive_object(m_planes, m_plane_snapshots, m_id, m.time, m.id, m.plane, m_time, m_latency); break;
+        case net_tcp_msg::type_game_data: m_game_data_msg.push_back(m.game_data); break;
+        case net_tcp_msg::type_add_plane: m_planes.add_msgs.push_back(m.add_plane); break;
+        case net_tcp_msg::type_ping: break; //clients don't answer pings
     }
-
-    return false;
 }
 
 //------------------------------------------------------------
 
-void network_client::update()
+void network_client::process_msg(const std::string &m)
 {
-    m_client.update();
+    std::istringstream is(m);
+    std::string cmd;
+    is >> cmd;
 
-    for (size_t i = 0; i < m_client.get_message_count(); ++i)
+    if (cmd == "missile")
+    {
+        unsigned int t, id;
+        is >> t, is >> id;
+        net_missile state;
+        read(is, state);
+        if (is)
+            receive_object(m_missiles, m_missile_snapshots, m_id, t, id, state, m_time, m_latency);
+    }
+    else if (cmd == "message")
+    {
+        std::string str;
+        std::getline(is, str);
+        m_general_msg.push_back(str);
+    }
+    else if (cmd == "events")
+    {
+        m_events.push_back(m.substr(cmd.size() + 1));
+    }
+    else if (cmd == "remove_plane")
+    {
+        unsigned int plane_id;
+        is >> plane_id;
+        m_planes.remove(plane_id);
+    }
+    else if (cmd == "add_missile")
+    {
+        msg_add_missile am;
+        read(is, am);
+        m_missiles.add_msgs.push_back(am);
+    }
+    else if (cmd == "remove_missile")
     {
-        auto &m = m_client.get_message(i);
+        unsigned int missile_id;
+        is >> missile_id;
+        m_missiles.remove(missile_id);
+    }
+    else if (cmd == "pong")
+    {
+        unsigned int send_time, server_time;
+        is >> send_time, is >> server_time;
+        if (is)
+            m_clock.add_sample(send_time, server_time, (unsigned int)nya_system::get_time());
+    }
+    else if (cmd == "disconnect")
+    {
+        net_io_msg d;
+        d.t = net_io_msg::type_disconnect;
+        m_io.post(std::move(d));
+    }
+    else
+        printf("client received: %s\n", m.c_str());
+}
 
-        std::istringstream is(m);
-        std::string cmd;
-        is >> cmd;
+//------------------------------------------------------------
 
-        if (cmd == "plane")
-        {
-            receive_object(m_planes, m_id, is, m_time);
-        }
-        else if (cmd == "missile")
-        {
-            receive_object(m_missiles, m_id, is, m_time);
-        }
-        else if (cmd == "message")
-        {
-            std::string str;
-            std::getline(is, str);
-            m_general_msg.push_back(str);
-        }
-        else if (cmd == "game_data")
-        {
-            msg_game_data mg;
-            read(is, mg);
-            m_game_data_msg.push_back(mg);
-        }
-        else if (cmd == "add_plane")
-        {
-            msg_add_plane ap;
-            read(is, ap);
-            m_planes.add_msgs.push_back(ap);
-        }
-        else if (cmd == "remove_plane")
-        {
-            unsigned int plane_id;
-            is >> plane_id;
-            m_planes.remove(plane_id);
-        }
-        else if (cmd == "add_missile")
-        {
-            msg_add_missile am;
-            read(is, am);
-            m_missiles.add_msgs.push_back(am);
-        }
-        else if (cmd == "remove_missile")
-        {
-            unsigned int missile_id;
-            is >> missile_id;
-            m_missiles.remove(missile_id);
-        }
-        else if (cmd == "disconnect")
-        {
-            m_client.disconnect();
-        }
-        else
-            printf("client received: %s\n", m.c_str());
+template<typename rs, typename records, typename snapshots>
+void receive_states(rs &objs, const records &states, snapshots &snaps, unsigned int client_id, unsigned int t, unsigned int time)
+{
+    for (auto &s: states)
+    {
+        auto o = objs.get(s.id);
+        if (!o || o->r.client_id == client_id)
+            continue;
+
+        snaps[s.id].add(t, s.state, time);
+        o->last_time = std::max(o->last_time, t);
     }
 }
 
 //------------------------------------------------------------
 
-template<typename rs> void send_requests(rs &requests, miso::client_tcp &client, const std::string &msg)
+void network_client::receive_udp(const std::string &data, const udp_socket::address &from)
+{
+    net_packet p;
+    if (from != m_udp_server || !p.read_header(data) || p.client_id != m_id || p.token != m_udp_token)
+        return;
+
+    if (!p.read(data, m_channel, m_quantizer))
+        return;
+
+    m_udp_ready = true;
+    if (p.t == net_packet::type_planes || p.t == net_packet::type_missiles)
+        m_latency.add(int(m_time - p.time));
+
+    if (p.t == net_packet::type_planes)
+        receive_states(m_planes, p.planes, m_plane_snapshots, m_id, p.time, m_time);
+    else if (p.t == net_packet::type_missiles)
+        receive_states(m_missiles, p.missiles, m_missile_snapshots, m_id, p.time, m_time);
+}
+
+//------------------------------------------------------------
+
+template<typename rs> void send_requests(rs &requests, net_io &io, const std::string &msg)
 {
     if (requests.empty())
         return;
 
     for (auto &r: requests)
-        client.send_message(msg + " " + to_string(r));
+        io.post_tcp(0, msg + " " + to_string(r));
     requests.clear();
 }
 
 //------------------------------------------------------------
 
-template<typename rs> void send_objects(rs &objs, miso::client_tcp &client, unsigned int time, const std::string &msg)
+//returns true if anything was sent via udp
+template<typename rs> bool send_objects(rs &objs, net_io &io, net_packet *p, const udp_socket::address &to,
+                                        net_channel &c, const net_quantizer &q, unsigned int time, const std::string &msg)
 {
-    send_requests(objs.add_requests, client, "add_" + msg);
+    send_requests(objs.add_requests, io, "add_" + msg);
+
+    bool sent = false;
 
     for (auto &o: objs.objects)
     {
@@ -259,27 +411,58 @@ template<typename rs> void send_objects(rs &objs, miso::client_tcp &client, unsi
             continue;
 
         if (o.net.unique())
-            client.send_message("remove_" + msg + " " + std::to_string(o.r.id));
+            io.post_tcp(0, "remove_" + msg + " " + std::to_string(o.r.id));
+        else if (p)
+        {
+            p->add(o.r.id, *o.net);
+            if (p->is_full())
+                sent |= send(io, to, *p, c, q);
+        }
         else
-            client.send_message(msg + " " + std::to_string(time) + " " + std::to_string(o.r.id) + " "+ to_string(o.net));
+            io.post_tcp(0, msg + " " + std::to_string(time) + " " + std::to_string(o.r.id) + " "+ to_string(o.net));
     }
 
+    if (p)
+        sent |= send(io, to, *p, c, q);
+
     objs.remove_src_unique();
+    return sent;
 }
 
 //------------------------------------------------------------
 
 void network_client::update_post(int dt)
 {
-    m_time += dt;
-    if (m_time - m_last_send_time < 1000 / net_fps)
+    m_time = m_clock.adjust(m_time + dt, (unsigned int)nya_system::get_time());
+    if (!m_started || m_time - m_last_send_time < 1000 / net_fps)
         return;
     m_last_send_time = m_time;
 
-    send_objects(m_planes, m_client, m_time, "plane");
-    send_objects(m_missiles, m_client, m_time, "missile");
-    send_requests(m_general_msg_requests, m_client, "message");
-    send_requests(m_game_data_msg_requests, m_client, "game_data");
+    net_packet p;
+    p.client_id = m_id;
+    p.token = m_udp_token;
+    p.time = m_time;
+
+    if (m_udp.is_open() && !m_udp_ready)
+        send(m_io, m_udp_server, p, m_channel, m_quantizer); //hello until the server answers
+
+    net_packet *udp_p = m_udp_ready ? &p : 0;
+    p.t = net_packet::type_planes;
+    bool sent = send_objects(m_planes, m_io, udp_p, m_udp_server, m_channel, m_quantizer, m_time, "plane");
+    p.t = net_packet::type_missiles;
+    sent |= send_objects(m_missiles, m_io, udp_p, m_udp_server, m_channel, m_quantizer, m_time, "missile");
+
+    //server needs acks to pick baselines
+    if (m_udp_ready && !sent)
+    {
+        p.t = net_packet::type_ack;
+        send(m_io, m_udp_server, p, m_channel, m_quantizer);
+    }
+
+    m_channel.update_stats(m_time);
+    send_requests(m_general_msg_requests, m_io, "message");
+    send_requests(m_events_requests, m_io, "events");
+    send_requests(m_game_data_msg_requests, m_io, "game_data");
 }
 
 //------------------------------------------------------------
@@ -291,6 +474,31 @@ const server_info &network_client::get_server_info() const
 
 //------------------------------------------------------------
 
+unsigned int network_client::get_interp_delay() const
+{
+    if (m_plane_snapshots.empty())
+        return 0;
+
+    unsigned int delay = 0;
+    for (auto &s: m_plane_snapshots)
+        delay += s.second.get_delay();
+    return delay / (unsigned int)m_plane_snapshots.size();
+}
+
+//------------------------------------------------------------
+
+net_stats network_client::get_stats() const
+{
+    net_stats s = m_channel.get_stats();
+    s.client_id = m_id;
+    s.rtt = m_clock.get_rtt();
+    s.tcp_bytes_sent = m_io.get_tcp_bytes_posted();
+    s.tcp_bytes_received = m_io.get_tcp_bytes_received();
+    return s;
+}
+
+//------------------------------------------------------------
+
 network_client::~network_client()
 {
     disconnect();
@@ -5,7 +5,13 @@
 #pragma once
 
 #include "network_data.h"
+#include "network_udp.h"
+#include "network_channel.h"
+#include "network_clock.h"
+#include "network_interpolation.h"
+#include "network_io.h"
 #include "miso/client/client_tcp.h"
+#include "miso/protocol/app_protocol_simple.h"
 
 namespace game
 {
@@ -19,20 +25,47 @@ public:
 
     void start();
 
-    bool is_up() const { return m_client.is_open(); }
+    bool is_up() const { return m_io.is_open(); }
 
     const server_info &get_server_info() const;
 
     std::string get_error() const { return m_error; }
 
+    net_stats get_stats() const;
+    const net_interp_stats &get_interp_stats() const { return m_interp_stats; }
+    unsigned int get_interp_delay() const; //average for remote planes, ms
+    const net_latency &get_latency() const { return m_latency; }
+    void reset_latency() { m_latency.clear(); }
+
     ~network_client();
 
 private:
     void update() override;
     void update_post(int dt) override;
+    void set_location_size(float half_size) override { m_quantizer.set_location_size(half_size); }
+    void poll_io(net_io &io);
+    void process_msg(const std::string &m);
+    void process_msg(const net_tcp_msg &m);
+    void receive_udp(const std::string &data, const udp_socket::address &from);
+    template<typename rs, typename snapshots> void interpolate(rs &objs, snapshots &s);
 
 private:
+    miso::app_protocol_simple m_protocol; //per instance, clients run on different threads
     miso::client_tcp m_client;
+    udp_socket m_udp;
+    net_io m_io;
+    unsigned long m_last_io_send_time = 0; //network thread, for keepalives
+    udp_socket::address m_udp_server;
+    uint32_t m_udp_token = 0;
+    bool m_udp_ready = false; //server answered, state goes via udp
+    net_channel m_channel;
+    net_quantizer m_quantizer;
+    net_clock m_clock;
+    bool m_start_requested = false, m_started = false;
+    std::unordered_map<unsigned int, net_snapshots<net_plane> > m_plane_snapshots;
+    std::unordered_map<unsigned int, net_snapshots<net_missile> > m_missile_snapshots;
+    net_interp_stats m_interp_stats;
+    net_latency m_latency;
     server_info m_server_info;
     unsigned int m_last_send_time = 0;
     std::string m_error;
@@ -0,0 +1,93 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include <stdlib.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+//ntp style estimate of the server clock
+//client sends its time in a ping, server answers with its own, the sample with the lowest rtt in the window wins
+
+class net_clock
+{
+public:
+    enum
+    {
+        window = 8,
+        ready_samples = 4,
+        burst_interval = 100, //until ready
+        interval = 2000,
+        max_slew = 2, //per adjust
+        max_error = 250 //jumps instead of slewing
+    };
+
+    bool need_ping(unsigned int now) const
+    {
+        if (!m_pinged)
+            return true;
+
+        return now - m_last_ping >= (is_ready() ? (unsigned int)interval : (unsigned int)burst_interval);
+    }
+
+    void on_ping(unsigned int now) { m_last_ping = now, m_pinged = true; }
+
+    //local times of ping and pong, server time from the pong
+    void add_sample(unsigned int send_time, unsigned int server_time, unsigned int receive_time)
+    {
+        const int rtt = int(receive_time - send_time);
+        if (rtt < 0)
+            return;
+
+        sample &s = m_samples[m_next];
+        s.rtt = rtt;
+        s.offset = int(server_time + rtt / 2 - receive_time);
+        m_next = (m_next + 1) % window;
+        if (m_count < window)
+            ++m_count;
+
+        const sample *best = &m_samples[0];
+        for (int i = 1; i < m_count; ++i)
+        {
+            if (m_samples[i].rtt < best->rtt)
+                best = &m_samples[i];
+        }
+
+        m_offset = best->offset;
+        m_rtt = best->rtt;
+    }
+
+    bool is_ready() const { return m_count >= ready_samples; }
+    unsigned int get_server_time(unsigned int now) const { return now + m_offset; }
+    int get_rtt() const { return m_rtt; }
+
+    //game time moved towards the server one a bit at a time
+    unsigned int adjust(unsigned int time, unsigned int now) const
+    {
+        if (!is_ready())
+            return time;
+
+        const int error = int(get_server_time(now) - time);
+        if (abs(error) > max_error)
+            return get_server_time(now);
+
+        return time + (error > max_slew ? max_slew : (error < -max_slew ? -max_slew : error));
+    }
+
+    void reset() { *this = net_clock(); }
+
+private:
+    struct sample { int offset = 0, rtt = 0; };
+    sample m_samples[window];
+    int m_count = 0, m_next = 0;
+    int m_offset = 0, m_rtt = 0;
+    unsigned int m_last_ping = 0;
+    bool m_pinged = false;
+};
+
+//------------------------------------------------------------
+}
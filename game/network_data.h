@@ -12,12 +12,18 @@
 #include <string>
 #include <memory>
 #include <sstream>
+#include <unordered_map>
+#include <algorithm>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
 
 namespace game
 {
 //------------------------------------------------------------
 
 const static unsigned int invalid_id = (unsigned int)(-1);
+const static float radar_range = 12000.0f; //m, targets list, also net relevance and ai rates
 
 //------------------------------------------------------------
 
@@ -35,42 +41,187 @@ struct server_info
 
 struct game_data
 {
-    template<typename t> t get(std::string name) const
+    //schema, add new fields here
+    enum key
+    {
+        key_team,
+        key_score,
+        key_respawn_time,
+        keys_count
+    };
+
+    enum type { type_int, type_string };
+
+    static type get_type(key k) { static const type types[] = { type_int, type_int, type_int }; return types[k]; }
+    static const char *get_name(key k) { static const char *names[] = { "team", "score", "respawn_time" }; return names[k]; }
+
+    static key get_key(const std::string &name)
     {
-        for (auto &p: params)
+        for (int i = 0; i < keys_count; ++i)
         {
-            if (p.first == name)
+            if (name == get_name(key(i)))
+                return key(i);
+        }
+
+        return keys_count;
+    }
+
+public:
+    int get_int(key k) const { return m_ints[k]; }
+    const std::string &get_string(key k) const { return m_strings[k]; }
+
+    void set(key k, int value)
+    {
+        if (m_ints[k] == value && (m_set & (1 << k)))
+            return;
+
+        m_ints[k] = value;
+        mark(k);
+    }
+
+    void set(key k, const std::string &value)
+    {
+        if (m_strings[k] == value && (m_set & (1 << k)))
+            return;
+
+        m_strings[k] = value;
+        mark(k);
+    }
+
+    bool is_changed() const { return m_dirty != 0; }
+    void reset_changed() { m_dirty = 0; }
+
+    //copies received fields, doesn't mark them as changed
+    void merge(const game_data &from)
+    {
+        for (int i = 0; i < keys_count; ++i)
+        {
+            if (!(from.m_set & (1 << i)))
+                continue;
+
+            m_ints[i] = from.m_ints[i];
+            m_strings[i] = from.m_strings[i];
+        }
+
+        m_set |= from.m_set;
+    }
+
+    //only the changed fields
+    game_data get_delta() const
+    {
+        game_data d;
+        d.merge(*this);
+        d.m_set = m_dirty;
+        return d;
+    }
+
+    //mask, then int32 or uint8 size + chars for each field in the mask
+    void write(std::string &out) const
+    {
+        out.append((const char *)&m_set, sizeof(m_set));
+        for (int i = 0; i < keys_count; ++i)
+        {
+            if (!(m_set & (1 << i)))
+                continue;
+
+            if (get_type(key(i)) == type_int)
+            {
+                const int32_t v = m_ints[i];
+                out.append((const char *)&v, sizeof(v));
+            }
+            else
             {
-                std::istringstream ss(p.second);
-                t value;
-                ss >> value;
-                return value;
+                const uint8_t size = (uint8_t)std::min(m_strings[i].size(), size_t(255));
+                out.push_back((char)size);
+                out.append(m_strings[i].data(), size);
             }
         }
-
-        return t();
     }
 
-    void set(std::string name, std::string value)
+    bool read(const std::string &in)
     {
-        for (auto &p: params)
+        size_t offset = 0;
+        auto read_data = [&in, &offset](void *data, size_t size)
         {
-            if (p.first == name)
+            if (offset + size > in.size())
+                return false;
+
+            memcpy(data, in.data() + offset, size);
+            offset += size;
+            return true;
+        };
+
+        uint32_t mask = 0;
+        if (!read_data(&mask, sizeof(mask)))
+            return false;
+
+        for (int i = 0; i < keys_count; ++i)
+        {
+            if (!(mask & (1 << i)))
+                continue;
+
+            if (get_type(key(i)) == type_int)
             {
-                p.second = value;
-                changed = true;
-                return;
+                int32_t v;
+                if (!read_data(&v, sizeof(v)))
+                    return false;
+
+                m_ints[i] = v;
+            }
+            else
+            {
+                uint8_t size;
+                if (!read_data(&size, 1) || offset + size > in.size())
+                    return false;
+
+                m_strings[i].assign(in.data() + offset, size);
+                offset += size;
             }
         }
 
-        params.push_back({name, value});
-        changed = true;
+        m_set |= mask & ((1 << keys_count) - 1);
+        return true;
+    }
+
+public:
+    //compatibility, by name
+    template<typename t> t get(std::string name) const
+    {
+        const key k = get_key(name);
+        if (k == keys_count)
+            return t();
+
+        std::istringstream ss(get_type(k) == type_int ? std::to_string(m_ints[k]) : m_strings[k]);
+        t value = t();
+        ss >> value;
+        return value;
+    }
+
+    void set(std::string name, std::string value)
+    {
+        const key k = get_key(name);
+        if (k == keys_count)
+        {
+            printf("game_data: unknown field %s\n", name.c_str());
+            return;
+        }
+
+        if (get_type(k) == type_int)
+            set(k, atoi(value.c_str()));
+        else
+            set(k, value);
     }
 
     template<typename t> void set(std::string name, t value) { set(name, std::to_string(value)); }
 
-    std::vector<std::pair<std::string, std::string> > params;
-    bool changed = false;
+private:
+    void mark(key k) { m_set |= 1 << k, m_dirty |= 1 << k; }
+
+private:
+    int m_ints[keys_count] = {0};
+    std::string m_strings[keys_count];
+    uint32_t m_set = 0;
+    uint32_t m_dirty = 0;
 };
 
 //------------------------------------------------------------
@@ -110,6 +261,72 @@ typedef std::shared_ptr<net_missile> net_missile_ptr;
 
 //------------------------------------------------------------
 
+//several tcp messages in one frame: "batch", then " <size> <message>" for each one
+//messages are binary safe, a single message goes unwrapped
+
+class msg_batch
+{
+public:
+    void add(const std::string &msg)
+    {
+        if (m_data.empty())
+            m_data = "batch";
+
+        m_data.append(" ").append(std::to_string(msg.size())).append(" ");
+        if (!m_count++)
+            m_first = m_data.size();
+        m_data.append(msg);
+    }
+
+    bool empty() const { return m_count == 0; }
+    int get_count() const { return m_count; }
+    void clear() { m_data.clear(), m_count = 0, m_first = 0; }
+
+    //moves the frame out, the batch is empty after that
+    std::string take()
+    {
+        std::string frame = m_count == 1 ? m_data.substr(m_first) : std::move(m_data);
+        clear();
+        return frame;
+    }
+
+    static bool is_batch(const std::string &frame) { return frame.compare(0, 6, "batch ") == 0; }
+
+    //false on malformed frame
+    static bool split(const std::string &frame, std::vector<std::string> &msgs)
+    {
+        msgs.clear();
+        if (!is_batch(frame))
+            return false;
+
+        size_t pos = 5;
+        while (pos < frame.size())
+        {
+            if (frame[pos++] != ' ')
+                return false;
+
+            size_t size = 0, digits = 0;
+            for (; pos < frame.size() && frame[pos] >= '0' && frame[pos] <= '9' && digits < 10; ++pos, ++digits)
+                size = size * 10 + (frame[pos] - '0');
+
+            if (!digits || pos >= frame.size() || frame[pos++] != ' ' || size > frame.size() - pos)
+                return false;
+
+            msgs.push_back(frame.substr(pos, size));
+            pos += size;
+        }
+
+        return !msgs.empty();
+    }
+
+private:
+    std::string m_data;
+    size_t m_first = 0;
+    int m_count = 0;
+};
+
+//------------------------------------------------------------
+
 class network_interface
 {
 public:
@@ -136,15 +353,16 @@ public:
 
     net_plane_ptr get_plane(unsigned int plane_id) { return m_planes.get_net(plane_id); }
 
-    unsigned int get_plane_id(net_plane_ptr plane)
+    unsigned int get_plane_id(net_plane_ptr plane) { return m_planes.get_id(plane); }
+
+    //time the plane's owner saw the others at when it sent the plane's last state
+    unsigned int get_view_time(const net_plane_ptr &plane)
     {
-        for (auto &p: m_planes.objects)
-        {
-            if (p.net == plane)
-                return p.r.id;
-        }
+        auto o = m_planes.get(m_planes.get_id(plane));
+        if (!o || !o->last_time)
+            return m_time;
 
-        return invalid_id;
+        return o->last_time - get_view_delay(o->r.client_id);
     }
 
     unsigned int get_id() const { return m_id; }
@@ -173,6 +391,10 @@ public:
     void general_msg(std::string msg) { m_general_msg_requests.push_back(msg); }
     bool get_general_msg(std::string &m) { return get_msg(m, m_general_msg); }
 
+    //binary, see event_bus
+    void send_events(const std::string &data) { m_events_requests.push_back(data); }
+    bool get_events(std::string &data) { return get_msg(data, m_events); }
+
 public:
     struct msg_game_data
     {
@@ -185,7 +407,7 @@ public:
         msg_game_data m;
         m.client_id = m_id;
         m.plane_id = get_plane_id(plane);
-        m.data = data;
+        m.data = data.get_delta();
 
         m_game_data_msg_requests.push_back(m);
     }
@@ -197,6 +419,8 @@ public:
 
     virtual void update() {};
     virtual void update_post(int dt) {};
+    virtual void set_location_size(float half_size) {} //bounds for quantized positions
+    virtual unsigned int get_view_delay(unsigned int client_id) const { return 0; } //client's interpolation delay
 
     unsigned int get_time() const { return m_time; }
 
@@ -225,38 +449,49 @@ protected:
             n = ptr(new type());
             n->source = source;
             objects.back().r = r;
+            m_idx[r.id] = objects.size() - 1;
+            m_ids[n.get()] = r.id;
             if (source)
                 add_requests.push_back(r);
             return n;
         }
 
+        struct obj;
+
+        obj *get(unsigned int id)
+        {
+            auto it = m_idx.find(id);
+            return it == m_idx.end() ? 0 : &objects[it->second];
+        }
+
         ptr get_net(unsigned int id)
         {
-            for (auto &o: objects)
-            {
-                if (o.r.id == id)
-                    return o.net;
-            }
+            auto o = get(id);
+            return o ? o->net : ptr();
+        }
 
-            return ptr();
+        unsigned int get_id(const ptr &n) const
+        {
+            auto it = m_ids.find(n.get());
+            return it == m_ids.end() ? invalid_id : it->second;
         }
 
         void remove(unsigned int id)
         {
-            objects.erase(std::remove_if(objects.begin(), objects.end(), [id](const obj &o){ return o.r.id == id; }), objects.end());
+            erase(std::remove_if(objects.begin(), objects.end(), [id](const obj &o){ return o.r.id == id; }));
         }
 
         void remove_by_client_id(unsigned int id)
         {
-            objects.erase(std::remove_if(objects.begin(), objects.end(), [id](const obj &o){ return o.r.client_id == id; }), objects.end());
+            erase(std::remove_if(objects.begin(), objects.end(), [id](const obj &o){ return o.r.client_id == id; }));
         }
 
         void remove_src_unique()
         {
-            objects.erase(std::remove_if(objects.begin(), objects.end(), [](const obj &o){ return o.net.unique() && o.net->source; }), objects.end());
+            erase(std::remove_if(objects.begin(), objects.end(), [](const obj &o){ return o.net.unique() && o.net->source; }));
         }
 
-        void clear() { objects.clear(), add_msgs.clear(), add_requests.clear(); }
+        void clear() { objects.clear(), add_msgs.clear(), add_requests.clear(), m_idx.clear(), m_ids.clear(); }
 
     public:
         struct obj
@@ -271,6 +506,26 @@ protected:
     public:
         std::deque<request> add_msgs;
         std::deque<request> add_requests;
+
+    private:
+        void erase(typename std::vector<obj>::iterator from)
+        {
+            if (from == objects.end())
+                return;
+
+            objects.erase(from, objects.end());
+
+            m_idx.clear();
+            m_ids.clear();
+            for (size_t i = 0; i < objects.size(); ++i)
+            {
+                m_idx[objects[i].r.id] = i;
+                m_ids[objects[i].net.get()] = objects[i].r.id;
+            }
+        }
+
+        std::unordered_map<unsigned int, size_t> m_idx;
+        std::unordered_map<const type *, unsigned int> m_ids;
     };
 
 protected:
@@ -283,6 +538,8 @@ protected:
 protected:
     std::deque<std::string> m_general_msg;
     std::deque<std::string> m_general_msg_requests;
+    std::deque<std::string> m_events;
+    std::deque<std::string> m_events_requests;
 
 protected:
     std::deque<msg_game_data> m_game_data_msg;
@@ -294,5 +551,24 @@ protected:
     unsigned int m_last_obj_id = 0;
 };
 
+//------------------------------------------------------------
+
+//tcp messages the sim gets most, parsed on the network thread
+
+struct net_tcp_msg
+{
+    enum type { type_plane, type_add_plane, type_game_data, type_ping };
+    type t = type_plane;
+
+    unsigned int time = 0, id = 0;
+    net_plane plane;
+    network_interface::msg_add_plane add_plane;
+    network_interface::msg_game_data game_data;
+
+    std::string ping_time; //echoed back as is
+    int rtt = 0;
+    unsigned int view_delay = 0;
+};
+
 //------------------------------------------------------------
 }
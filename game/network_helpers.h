@@ -5,16 +5,20 @@
 #pragma once
 
 #include "network_data.h"
+#include "network_packet.h"
+#include "network_io.h"
 #include <sstream>
+#include <iterator>
 
-//ToDo: send plane data binary via udp and only important commands via tcp
-//current inplementation is for testing purpose only
+//plane and missile state goes binary via udp once the channel is up, see net_packet
+//it's quantized and delta compressed against the last state the peer acknowledged, see net_channel
+//text versions below are the tcp fallback
 
 namespace game
 {
 //------------------------------------------------------------
 
-static const int version = 1;
+static const int version = 6;
 static const char *server_header = "Open-Horizon server";
 static const unsigned int net_fps = 25;
 
@@ -100,14 +104,19 @@ inline std::string to_string(const net_plane_ptr &n)
 
 //------------------------------------------------------------
 
-inline void read(std::istringstream &is, net_plane_ptr &n)
+inline void read(std::istringstream &is, net_plane &n)
 {
-    if (!n)
-        return;
+    read(is, n.pos), read(is, n.vel), read(is, n.rot);
+    read(is, n.ctrl_rot), is >> n.ctrl_throttle, is >> n.ctrl_brake;
+    is >> n.ctrl_mgun, is >> n.ctrl_mgp;
+}
+
+//------------------------------------------------------------
 
-    read(is, n->pos), read(is, n->vel), read(is, n->rot);
-    read(is, n->ctrl_rot), is >> n->ctrl_throttle, is >> n->ctrl_brake;
-    is >> n->ctrl_mgun, is >> n->ctrl_mgp;
+inline void read(std::istringstream &is, net_plane_ptr &n)
+{
+    if (n)
+        read(is, *n);
 }
 
 //------------------------------------------------------------
@@ -136,12 +145,17 @@ inline std::string to_string(const net_missile_ptr &n)
 
 //------------------------------------------------------------
 
-inline void read(std::istringstream &is, net_missile_ptr &n)
+inline void read(std::istringstream &is, net_missile &n)
 {
-    if (!n)
-        return;
+    read(is, n.pos), read(is, n.vel), read(is, n.rot), read(is, n.target_dir), is >> n.target, is >> n.engine_started;
+}
+
+//------------------------------------------------------------
 
-    read(is, n->pos), read(is, n->vel), read(is, n->rot), read(is, n->target_dir), is >> n->target, is >> n->engine_started;
+inline void read(std::istringstream &is, net_missile_ptr &n)
+{
+    if (n)
+        read(is, *n);
 }
 
 //------------------------------------------------------------
@@ -163,9 +177,7 @@ inline void read(std::istringstream &is, network_interface::msg_add_missile &m)
 inline std::string to_string(const network_interface::msg_game_data &m)
 {
     std::string str = std::to_string(m.client_id) + " " + std::to_string(m.plane_id) + " ";
-    for (auto &p: m.data.params)
-        str.append(p.first + '{' + p.second + '}');
-
+    m.data.write(str);
     return str;
 }
 
@@ -175,14 +187,65 @@ inline void read(std::istringstream &is, network_interface::msg_game_data &m)
 {
     is >> m.client_id, is >> m.plane_id;
     is.ignore(); //whitespace
-    std::string name, value;
-    while (std::getline(is, name, '{') && std::getline(is, value, '}'))
-        m.data.params.push_back(std::make_pair(name, value));
+    const std::string data((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    if (!m.data.read(data))
+        printf("invalid game data\n");
 }
 
 //------------------------------------------------------------
 
 inline std::string to_string(const std::string &s) { return s; }
 
+//------------------------------------------------------------
+
+//network thread, null if the message is left for the sim or malformed
+inline std::unique_ptr<net_tcp_msg> parse_tcp_msg(const std::string &msg)
+{
+    const char *cmds[] = { "plane ", "add_plane ", "game_data ", "ping " };
+    const net_tcp_msg::type types[] = { net_tcp_msg::type_plane, net_tcp_msg::type_add_plane, net_tcp_msg::type_game_data, net_tcp_msg::type_ping };
+
+    for (int i = 0; i < 4; ++i)
+    {
+        if (msg.compare(0, strlen(cmds[i]), cmds[i]) != 0)
+            continue;
+
+        std::unique_ptr<net_tcp_msg> m(new net_tcp_msg());
+        m->t = types[i];
+
+        std::istringstream is(msg.substr(strlen(cmds[i])));
+        switch (m->t)
+        {
+            case net_tcp_msg::type_plane: is >> m->time, is >> m->id, read(is, m->plane); break;
+            case net_tcp_msg::type_add_plane: read(is, m->add_plane); break;
+            case net_tcp_msg::type_game_data: read(is, m->game_data); return m; //reads to the end
+            case net_tcp_msg::type_ping: is >> m->ping_time, is >> m->rtt, is >> m->view_delay; break;
+        }
+
+        if (!is)
+            return std::unique_ptr<net_tcp_msg>();
+
+        return m;
+    }
+
+    return std::unique_ptr<net_tcp_msg>();
+}
+
+//------------------------------------------------------------
+
+//false if there was nothing to send
+inline bool send(net_io &io, const udp_socket::address &to, net_packet &p, net_channel &c, const net_quantizer &q)
+{
+    const bool has_records = p.t == net_packet::type_planes || p.t == net_packet::type_missiles;
+    if (has_records && p.planes.empty() && p.missiles.empty())
+        return false;
+
+    std::string data;
+    p.write(data, c, q);
+    c.bytes_sent += data.size();
+    io.post_udp(to, std::move(data));
+    p.clear_records();
+    return true;
+}
+
 //------------------------------------------------------------
 }
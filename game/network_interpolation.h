@@ -0,0 +1,174 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "network_data.h"
+#include <deque>
+#include <math.h>
+#include <stdint.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+struct net_interp_stats
+{
+    uint64_t samples = 0;
+    uint64_t underruns = 0; //no newer snapshot, extrapolated
+    float max_correction = 0.0f; //m, jump against the previous sample moved by its velocity
+    double correction_sum = 0.0;
+
+    float get_avg_correction() const { return samples ? float(correction_sum / samples) : 0.0f; }
+};
+
+//------------------------------------------------------------
+
+inline void lerp_state(const net_plane &from, const net_plane &to, float k, net_plane &result)
+{
+    result = k < 0.5f ? from : to;
+    result.vel = from.vel + (to.vel - from.vel) * k;
+    result.rot = nya_math::quat::slerp(from.rot, to.rot, k);
+    result.ctrl_rot = from.ctrl_rot + (to.ctrl_rot - from.ctrl_rot) * k;
+    result.ctrl_throttle = from.ctrl_throttle + (to.ctrl_throttle - from.ctrl_throttle) * k;
+    result.ctrl_brake = from.ctrl_brake + (to.ctrl_brake - from.ctrl_brake) * k;
+}
+
+inline void lerp_state(const net_missile &from, const net_missile &to, float k, net_missile &result)
+{
+    result = k < 0.5f ? from : to;
+    result.vel = from.vel + (to.vel - from.vel) * k;
+    result.rot = nya_math::quat::slerp(from.rot, to.rot, k);
+    result.target_dir = from.target_dir + (to.target_dir - from.target_dir) * k;
+}
+
+//------------------------------------------------------------
+
+//received states of a remote object keyed by server time, sampled a bit in the past
+//the delay follows the measured transit time, snapshot interval and jitter
+
+template<typename state> class net_snapshots
+{
+public:
+    enum
+    {
+        max_snapshots = 32,
+        max_extrapolation = 250, //ms
+        max_delay = 500,
+        max_teleport_dist = 200 //m, respawn
+    };
+
+    //time is the server one, local time is the synced client one at arrival
+    void add(unsigned int time, const state &s, unsigned int local_time)
+    {
+        auto it = m_snapshots.end();
+        while (it != m_snapshots.begin() && int((it - 1)->time - time) > 0)
+            --it;
+
+        if (it != m_snapshots.begin() && (it - 1)->time == time)
+            return;
+
+        const bool newest = it == m_snapshots.end();
+        snapshot sn;
+        sn.time = time, sn.s = s;
+        m_snapshots.insert(it, sn);
+        if (m_snapshots.size() > max_snapshots)
+            m_snapshots.pop_front();
+
+        const float transit = float(int(local_time - time));
+        if (!m_has_stats)
+        {
+            m_transit = transit;
+            m_has_stats = true;
+        }
+        else
+        {
+            const float k = 0.1f;
+            m_jitter += (fabsf(transit - m_transit) - m_jitter) * k;
+            m_transit += (transit - m_transit) * k;
+            if (newest && m_snapshots.size() > 1)
+                m_interval += (float(int(time - m_snapshots[m_snapshots.size() - 2].time)) - m_interval) * k;
+        }
+    }
+
+    //false if there's nothing to sample
+    bool sample(unsigned int local_time, state &result, net_interp_stats &stats)
+    {
+        if (m_snapshots.empty())
+            return false;
+
+        const float target_delay = m_transit + m_interval + m_jitter * 2.0f;
+        const float delay_k = 0.05f;
+        m_delay += (std::min(std::max(target_delay, 0.0f), float(max_delay)) - m_delay) * delay_k;
+
+        const unsigned int time = local_time - (unsigned int)m_delay;
+
+        //keep one snapshot older than the sample time
+        while (m_snapshots.size() > 2 && int(m_snapshots[1].time - time) <= 0)
+            m_snapshots.pop_front();
+
+        const snapshot &first = m_snapshots.front();
+        if (int(time - first.time) <= 0)
+            result = first.s;
+        else if (m_snapshots.size() < 2 || int(time - m_snapshots[1].time) > 0)
+        {
+            const snapshot &last = m_snapshots.back();
+            const int dt = std::min(int(time - last.time), int(max_extrapolation));
+            result = last.s;
+            result.pos += last.s.vel * (dt * 0.001f);
+            ++stats.underruns;
+        }
+        else
+        {
+            const snapshot &to = m_snapshots[1];
+            const float interval = float(int(to.time - first.time));
+            const float k = float(int(time - first.time)) / interval;
+            lerp_state(first.s, to.s, k, result);
+
+            const float max_dist = float(max_teleport_dist) + (first.s.vel.length() + to.s.vel.length()) * interval * 0.001f;
+            if ((to.s.pos - first.s.pos).length_sq() > max_dist * max_dist)
+                result.pos = k < 0.5f ? first.s.pos : to.s.pos;
+            else
+            {
+                //hermite with velocities as tangents
+                const float t = interval * 0.001f, k2 = k * k, k3 = k2 * k;
+                result.pos = first.s.pos * (2.0f * k3 - 3.0f * k2 + 1.0f) + first.s.vel * ((k3 - 2.0f * k2 + k) * t)
+                           + to.s.pos * (-2.0f * k3 + 3.0f * k2) + to.s.vel * ((k3 - k2) * t);
+            }
+        }
+
+        if (m_has_sample)
+        {
+            const float dt = float(int(local_time - m_last_sample_time)) * 0.001f;
+            const float correction = (result.pos - (m_last_pos + m_last_vel * dt)).length();
+            if (correction < max_teleport_dist)
+            {
+                stats.correction_sum += correction;
+                stats.max_correction = std::max(stats.max_correction, correction);
+            }
+        }
+
+        ++stats.samples;
+        m_last_pos = result.pos, m_last_vel = result.vel;
+        m_last_sample_time = local_time;
+        m_has_sample = true;
+        return true;
+    }
+
+    unsigned int get_delay() const { return (unsigned int)m_delay; }
+
+private:
+    struct snapshot { unsigned int time; state s; };
+    std::deque<snapshot> m_snapshots;
+
+    bool m_has_stats = false;
+    float m_transit = 0.0f, m_jitter = 0.0f, m_interval = 1000.0f / 25, m_delay = 100.0f;
+
+    bool m_has_sample = false;
+    nya_math::vec3 m_last_pos, m_last_vel;
+    unsigned int m_last_sample_time = 0;
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,166 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "network_io.h"
+#include <chrono>
+
+namespace game
+{
+//------------------------------------------------------------
+
+void net_io::start(const poll_function &poll, const udp_socket *wait_socket)
+{
+    stop();
+
+    m_poll = poll;
+    m_wait_socket = wait_socket;
+    m_wake_address = udp_socket::address();
+    if (m_wake.open(0, true))
+        m_wake_address = udp_socket::resolve("127.0.0.1", m_wake.get_port());
+    m_quit = false;
+    m_open = true;
+    m_thread = std::thread(&net_io::work, this);
+}
+
+//------------------------------------------------------------
+
+void net_io::stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    while (!flush(m_outgoing, m_post_backlog))
+    {
+        wake();
+        std::this_thread::sleep_for(std::chrono::milliseconds(flush_interval));
+    }
+
+    m_quit = true;
+    wake();
+    m_thread.join();
+    m_wake.close();
+
+    net_io_msg m;
+    while (m_incoming.pop(m)) {}
+    while (m_outgoing.pop(m)) {}
+    m_post_backlog.clear();
+    m_deliver_backlog.clear();
+    m_open = false;
+}
+
+//------------------------------------------------------------
+
+template<typename q> bool net_io::flush(q &queue, std::deque<net_io_msg> &backlog)
+{
+    while (!backlog.empty())
+    {
+        if (!queue.push(std::move(backlog.front())))
+            return false;
+
+        backlog.pop_front();
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------
+
+void net_io::post(net_io_msg &&m)
+{
+    if (m.t == net_io_msg::type_tcp)
+        m_tcp_bytes_posted += m.data.size();
+
+    if (!flush(m_outgoing, m_post_backlog) || !m_outgoing.push(std::move(m)))
+        m_post_backlog.push_back(std::move(m));
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); //pairs with the one in wait
+    if (m_waiting.exchange(false))
+        wake();
+}
+
+//------------------------------------------------------------
+
+void net_io::post_tcp(unsigned int client_id, std::string &&data)
+{
+    net_io_msg m;
+    m.t = net_io_msg::type_tcp;
+    m.client_id = client_id;
+    m.data = std::move(data);
+    post(std::move(m));
+}
+
+//------------------------------------------------------------
+
+void net_io::post_udp(const udp_socket::address &to, std::string &&data)
+{
+    net_io_msg m;
+    m.t = net_io_msg::type_udp;
+    m.address = to;
+    m.data = std::move(data);
+    post(std::move(m));
+}
+
+//------------------------------------------------------------
+
+bool net_io::receive(net_io_msg &m)
+{
+    flush(m_outgoing, m_post_backlog);
+    if (!m_incoming.pop(m))
+        return false;
+
+    if (m.t == net_io_msg::type_tcp)
+        m_tcp_bytes_received += m.data.size();
+    return true;
+}
+
+//------------------------------------------------------------
+
+void net_io::deliver(net_io_msg &&m)
+{
+    if (!flush(m_incoming, m_deliver_backlog) || !m_incoming.push(std::move(m)))
+        m_deliver_backlog.push_back(std::move(m));
+}
+
+//------------------------------------------------------------
+
+void net_io::work()
+{
+    while (!m_quit)
+    {
+        m_poll(*this);
+        flush(m_incoming, m_deliver_backlog);
+        wait();
+    }
+
+    m_poll(*this);
+}
+
+//------------------------------------------------------------
+
+void net_io::wait()
+{
+    m_waiting = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst); //a post either sees m_waiting or is seen here
+    if (m_outgoing.empty() && !m_quit)
+    {
+        const udp_socket *sockets[] = { m_wait_socket, &m_wake };
+        udp_socket::wait(sockets, 2, tcp_poll_interval);
+    }
+    m_waiting = false;
+
+    std::string data;
+    udp_socket::address from;
+    while (m_wake.receive(data, from)) {}
+}
+
+//------------------------------------------------------------
+
+void net_io::wake()
+{
+    if (m_wake_address.is_valid())
+        m_wake.send(m_wake_address, std::string(1, '\0'));
+}
+
+//------------------------------------------------------------
+}
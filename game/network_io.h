@@ -0,0 +1,91 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "network_udp.h"
+#include "network_data.h"
+#include "util/spsc_queue.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <thread>
+
+namespace game
+{
+//------------------------------------------------------------
+
+struct net_io_msg
+{
+    enum type
+    {
+        type_tcp, //single message, batches are split on the network thread
+        type_udp,
+        type_connected, //server, new tcp client
+        type_lost, //server, tcp client is gone
+        type_disconnect //to the network thread
+    };
+
+    type t = type_tcp;
+    unsigned int client_id = 0; //server side tcp peer
+    udp_socket::address address;
+    std::string data;
+    std::unique_ptr<net_tcp_msg> parsed; //type_tcp, null for the messages that are parsed by the sim
+};
+
+//------------------------------------------------------------
+
+//sockets are polled on a dedicated thread, the sim thread only exchanges messages with it
+//messages that don't fit in the queue wait in a backlog on the side that produced them
+//between polls the thread waits for udp data or posted messages, miso's tcp sockets are polled every tcp_poll_interval
+
+class net_io: public noncopyable
+{
+public:
+    typedef std::function<void(net_io &io)> poll_function; //called on the network thread
+
+    void start(const poll_function &poll, const udp_socket *wait_socket = 0); //wait_socket is read by the poll function
+    void stop(); //polls once more, so everything posted is sent
+    bool is_running() const { return m_thread.joinable(); }
+
+    //connection state, updated by the poll function
+    bool is_open() const { return m_open.load(); }
+    void set_open(bool open) { m_open.store(open); }
+
+public: //sim thread
+    void post(net_io_msg &&m);
+    void post_tcp(unsigned int client_id, std::string &&data);
+    void post_udp(const udp_socket::address &to, std::string &&data);
+    bool receive(net_io_msg &m);
+    uint64_t get_tcp_bytes_posted() const { return m_tcp_bytes_posted; }
+    uint64_t get_tcp_bytes_received() const { return m_tcp_bytes_received; }
+
+public: //network thread
+    bool get_posted(net_io_msg &m) { return m_outgoing.pop(m); }
+    void deliver(net_io_msg &&m);
+
+    ~net_io() { stop(); }
+
+private:
+    template<typename q> static bool flush(q &queue, std::deque<net_io_msg> &backlog);
+    void work();
+    void wait();
+    void wake();
+
+private:
+    enum { queue_size = 4096, tcp_poll_interval = 5, flush_interval = 1 }; //ms
+    spsc_queue<net_io_msg, queue_size> m_outgoing, m_incoming;
+    const udp_socket *m_wait_socket = 0;
+    udp_socket m_wake; //loopback, posts wake the network thread
+    udp_socket::address m_wake_address;
+    std::atomic<bool> m_waiting{false};
+    std::deque<net_io_msg> m_post_backlog, m_deliver_backlog;
+    uint64_t m_tcp_bytes_posted = 0, m_tcp_bytes_received = 0; //sim thread
+    poll_function m_poll;
+    std::thread m_thread;
+    std::atomic<bool> m_quit{false}, m_open{false};
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,306 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "network_data.h"
+#include "network_channel.h"
+#include <stdint.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+//binary plane and missile state for the udp channel, native byte order like game_data
+//header with sequence and acks, then records of one type
+//record: id, field mask, baseline sequence if the mask has it, quantized fields that differ from the baseline
+
+struct net_packet
+{
+    enum type
+    {
+        type_hello, //client sends until answered, server answers to every one
+        type_ack, //no records, keeps acks going when there's nothing else to send
+        type_planes,
+        type_missiles,
+        types_count
+    };
+
+    type t = type_hello;
+    uint32_t client_id = 0; //sender for client packets, receiver for server ones
+    uint32_t token = 0; //given to the client over tcp on connect
+    uint32_t time = 0;
+
+    struct plane { uint32_t id; net_plane state; };
+    struct missile { uint32_t id; net_missile state; };
+
+    std::vector<plane> planes;
+    std::vector<missile> missiles;
+
+public:
+    enum
+    {
+        header_size = 1 + 4 + 4 + 4 + 2 + 2 + 4 + 2,
+        record_header_size = 4 + 1 + 2,
+        record_min_size = 4 + 1,
+        plane_size = record_header_size + 24, //worst case, without baseline records are smaller than that
+        missile_size = record_header_size + 29,
+        max_size = 1200, //fits common mtu
+        has_ack_flag = 0x80,
+        has_baseline_flag = 0x80
+    };
+
+    bool is_full() const
+    {
+        const size_t size = header_size + planes.size() * plane_size + missiles.size() * missile_size;
+        return size + (t == type_missiles ? missile_size : plane_size) > max_size;
+    }
+
+    void clear_records() { planes.clear(), missiles.clear(); }
+
+    void add(uint32_t id, const net_plane &s) { plane p; p.id = id, p.state = s; planes.push_back(p); }
+    void add(uint32_t id, const net_missile &s) { missile m; m.id = id, m.state = s; missiles.push_back(m); }
+
+    //takes the next sequence of the channel and remembers sent states as future baselines
+    void write(std::string &out, net_channel &c, const net_quantizer &q) const
+    {
+        out.clear();
+        out.reserve(max_size);
+
+        const uint8_t tp = uint8_t(t) | (c.has_ack() ? has_ack_flag : 0);
+        write_data(out, tp), write_data(out, client_id), write_data(out, token), write_data(out, time);
+
+        const uint16_t seq = c.next_seq(), ack = c.get_ack();
+        const uint32_t ack_bits = c.get_ack_bits();
+        write_data(out, seq), write_data(out, ack), write_data(out, ack_bits);
+
+        const uint16_t count = uint16_t(t == type_planes ? planes.size() : (t == type_missiles ? missiles.size() : 0));
+        write_data(out, count);
+
+        if (t == type_planes)
+        {
+            for (auto &p: planes)
+                write_record(out, c, q, seq, p.id, p.state, net_quantized::get_plane_layout());
+        }
+        else if (t == type_missiles)
+        {
+            for (auto &m: missiles)
+                write_record(out, c, q, seq, m.id, m.state, net_quantized::get_missile_layout());
+        }
+    }
+
+    //header only, to find the sender's channel
+    bool read_header(const void *data, size_t size)
+    {
+        reader r(data, size);
+        return read_header(r);
+    }
+
+    bool read_header(const std::string &in) { return read_header(in.data(), in.size()); }
+
+    //false on any malformed input, never reads past the data
+    //records with a baseline the channel doesn't have are dropped
+    bool read(const void *data, size_t size, net_channel &c, const net_quantizer &q)
+    {
+        clear_records();
+
+        reader r(data, size);
+        if (!read_header(r) || m_count > r.get_remaining() / record_min_size)
+            return false;
+
+        if (t == type_planes)
+        {
+            planes.resize(m_count);
+            size_t count = 0;
+            for (auto &p: planes)
+            {
+                bool valid;
+                if (!read_record(r, c, q, p.id, p.state, net_quantized::get_plane_layout(), valid))
+                    return false;
+
+                if (valid)
+                    planes[count++] = p;
+            }
+
+            planes.resize(count);
+        }
+        else if (t == type_missiles)
+        {
+            missiles.resize(m_count);
+            size_t count = 0;
+            for (auto &m: missiles)
+            {
+                bool valid;
+                if (!read_record(r, c, q, m.id, m.state, net_quantized::get_missile_layout(), valid))
+                    return false;
+
+                if (valid)
+                    missiles[count++] = m;
+            }
+
+            missiles.resize(count);
+        }
+
+        if (!r.is_end())
+            return false;
+
+        c.on_receive(m_seq);
+        if (m_has_ack)
+            c.on_ack(m_ack, m_ack_bits);
+
+        for (auto &p: planes)
+            c.add_received(p.id, m_seq, m_received[&p - planes.data()]);
+        for (auto &m: missiles)
+            c.add_received(m.id, m_seq, m_received[&m - missiles.data()]);
+
+        c.bytes_received += size;
+        return true;
+    }
+
+    bool read(const std::string &in, net_channel &c, const net_quantizer &q) { return read(in.data(), in.size(), c, q); }
+
+public:
+    //keeps the source flag
+    static void apply(const net_plane &from, net_plane &to) { const bool source = to.source; to = from; to.source = source; }
+    static void apply(const net_missile &from, net_missile &to) { const bool source = to.source; to = from; to.source = source; }
+
+private:
+    template<typename t> static void write_data(std::string &out, const t &v) { out.append((const char *)&v, sizeof(v)); }
+
+    template<typename state> static void write_record(std::string &out, net_channel &c, const net_quantizer &q, uint16_t seq,
+                                                      uint32_t id, const state &s, const net_quantized::layout &l)
+    {
+        net_quantized qs;
+        q.quantize(s, qs);
+
+        uint16_t baseline_seq = 0;
+        const net_quantized *baseline = c.get_baseline(id, baseline_seq);
+
+        uint8_t mask = baseline ? has_baseline_flag : 0;
+        for (int i = 0; i < l.count; ++i)
+        {
+            if (!baseline || !qs.is_equal(l, i, *baseline))
+                mask |= 1 << i;
+        }
+
+        write_data(out, id), write_data(out, mask);
+        if (baseline)
+            write_data(out, baseline_seq);
+
+        for (int i = 0; i < l.count; ++i)
+        {
+            if (mask & (1 << i))
+                out.append((const char *)qs.data + l.offset[i], l.size[i]);
+        }
+
+        c.add_sent(id, seq, qs);
+    }
+
+    class reader;
+
+    bool read_header(reader &r)
+    {
+        uint8_t tp;
+        if (!r.get(tp) || !r.get(client_id) || !r.get(token) || !r.get(time))
+            return false;
+
+        if (!r.get(m_seq) || !r.get(m_ack) || !r.get(m_ack_bits) || !r.get(m_count))
+            return false;
+
+        m_has_ack = (tp & has_ack_flag) != 0;
+        tp &= ~has_ack_flag;
+        if (tp >= types_count)
+            return false;
+
+        t = type(tp);
+        if (t != type_planes && t != type_missiles && m_count != 0)
+            return false;
+
+        m_received.clear();
+        return true;
+    }
+
+    template<typename state> bool read_record(reader &r, const net_channel &c, const net_quantizer &q, uint32_t &id, state &s,
+                                              const net_quantized::layout &l, bool &valid)
+    {
+        uint8_t mask;
+        if (!r.get(id) || !r.get(mask))
+            return false;
+
+        if (mask & ~has_baseline_flag & ~((1 << l.count) - 1))
+            return false;
+
+        net_quantized qs;
+        valid = true;
+        if (mask & has_baseline_flag)
+        {
+            uint16_t baseline_seq;
+            if (!r.get(baseline_seq))
+                return false;
+
+            const net_quantized *baseline = c.get_received(id, baseline_seq);
+            if (baseline)
+                qs = *baseline;
+            else
+                valid = false;
+        }
+        else if ((mask & ((1 << l.count) - 1)) != (1 << l.count) - 1)
+            return false;
+
+        for (int i = 0; i < l.count; ++i)
+        {
+            if ((mask & (1 << i)) && !r.get(qs.data + l.offset[i], l.size[i]))
+                return false;
+        }
+
+        if (!valid)
+            return true;
+
+        q.dequantize(qs, s);
+        m_received.push_back(qs);
+        return true;
+    }
+
+    class reader
+    {
+    public:
+        template<typename t> bool get(t &v)
+        {
+            if (m_offset + sizeof(v) > m_size)
+                return false;
+
+            memcpy(&v, m_data + m_offset, sizeof(v));
+            m_offset += sizeof(v);
+            return true;
+        }
+
+        bool get(void *data, size_t size)
+        {
+            if (m_offset + size > m_size)
+                return false;
+
+            memcpy(data, m_data + m_offset, size);
+            m_offset += size;
+            return true;
+        }
+
+        size_t get_remaining() const { return m_size - m_offset; }
+        bool is_end() const { return m_offset == m_size; }
+
+        reader(const void *data, size_t size): m_data((const char *)data), m_size(size) {}
+
+    private:
+        const char *m_data;
+        size_t m_size;
+        size_t m_offset = 0;
+    };
+
+    uint16_t m_seq = 0, m_ack = 0, m_count = 0;
+    uint32_t m_ack_bits = 0;
+    bool m_has_ack = false;
+    std::vector<net_quantized> m_received;
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,105 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "network_data.h"
+#include "math/vector.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace game
+{
+//------------------------------------------------------------
+
+//how often a client gets an object, 1 is every net tick, 0 is never
+
+struct net_relevance
+{
+    struct params
+    {
+        float full_rate_dist = 3000.0f;
+        float cull_dist = radar_range + 3000.0f;
+        float min_score = 0.12f; //3 hz at 25 hz net rate
+        float behind_factor = 0.5f; //outside of the view cone
+        int max_records = 64; //per client and object type each net tick
+    };
+
+    struct viewer { nya_math::vec3 pos, dir; };
+
+    //important are client's targets and threats to the client
+    static float get_score(const params &p, const std::vector<viewer> &viewers, const nya_math::vec3 &pos, bool important)
+    {
+        if (important || viewers.empty())
+            return 1.0f;
+
+        float best = 0.0f;
+        for (auto &v: viewers)
+        {
+            const nya_math::vec3 diff = pos - v.pos;
+            const float dist = diff.length();
+            if (dist > p.cull_dist)
+                continue;
+
+            if (dist <= p.full_rate_dist)
+                return 1.0f;
+
+            float s = p.full_rate_dist / dist;
+            if (v.dir.dot(diff) < 0.0f)
+                s *= p.behind_factor;
+
+            best = std::max(best, std::max(s, p.min_score));
+        }
+
+        return best;
+    }
+};
+
+//------------------------------------------------------------
+
+//scores accumulate every net tick, objects with the highest priority are sent first
+//sent ones start over, so distant objects don't starve when the budget is tight
+
+class net_priority
+{
+public:
+    //objects without score are culled and start over later
+    void add(unsigned int id, float score)
+    {
+        auto it = m_last.find(id);
+        const float prev = it == m_last.end() ? 1.0f : it->second; //new ones go right away
+        m_candidates.push_back(std::make_pair(prev + score, id));
+    }
+
+    const std::vector<unsigned int> &select(int max_count)
+    {
+        std::sort(m_candidates.begin(), m_candidates.end(), [](const candidate &a, const candidate &b) { return a.first > b.first; });
+
+        m_selected.clear();
+        m_last.clear();
+        for (auto &c: m_candidates)
+        {
+            if (c.first >= 1.0f && (int)m_selected.size() < max_count)
+            {
+                m_selected.push_back(c.second);
+                m_last[c.second] = 0.0f;
+            }
+            else
+                m_last[c.second] = c.first;
+        }
+
+        m_candidates.clear();
+        return m_selected;
+    }
+
+private:
+    typedef std::pair<float, unsigned int> candidate;
+    std::vector<candidate> m_candidates;
+    std::vector<unsigned int> m_selected;
+    std::unordered_map<unsigned int, float> m_last;
+};
+
+//------------------------------------------------------------
+}
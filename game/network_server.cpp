@@ -4,8 +4,8 @@
 
 #include "network_server.h"
 #include "network_helpers.h"
-#include "miso/protocol/app_protocol_simple.h"
 #include "system/system.h"
+#include <random>
 
 namespace game
 {
@@ -13,7 +13,7 @@ namespace game
 
 bool network_server::open(unsigned short port, const char *name, const char *game_mode, const char *location, int max_players)
 {
-    if (m_server.is_open())
+    if (m_io.is_running())
         return false;
 
     if (!game_mode || !location)
@@ -35,11 +35,14 @@ bool network_server::open(unsigned short port, const char *name, const char *gam
 
     m_max_players = max_players;
 
-    static miso::app_protocol_simple protocol;
-    m_server.set_app_protocol(&protocol);
+    m_server.set_app_protocol(&m_protocol);
     if (!m_server.open_ipv4(port))
         return false;
 
+    if (!m_udp.open(port))
+        printf("udp channel is not available, sending state via tcp\n");
+
+    m_io.start([this](net_io &io) { this->poll_io(io); }, &m_udp);
     return true;
 }
 
@@ -47,10 +50,14 @@ bool network_server::open(unsigned short port, const char *name, const char *gam
 
 void network_server::close()
 {
+    flush();
+    m_io.stop();
+
     for (auto &c: m_clients)
         m_server.send_message(c.first, "disconnect");
 
     m_server.close(true);
+    m_udp.close();
     m_planes.clear();
 }
 
@@ -70,47 +77,169 @@ int network_server::get_players_count() const
 
 //------------------------------------------------------------
 
-void network_server::update()
+std::vector<net_stats> network_server::get_stats() const
+{
+    std::vector<net_stats> stats;
+    for (auto &c: m_clients)
+    {
+        stats.push_back(c.second.channel.get_stats());
+        auto &s = stats.back();
+        s.client_id = c.first;
+        s.tcp_messages_sent = c.second.tcp_messages_sent;
+        s.tcp_frames_sent = c.second.tcp_frames_sent;
+        s.tcp_bytes_sent = c.second.tcp_bytes_sent;
+        s.rtt = c.second.rtt;
+    }
+
+    return stats;
+}
+
+//------------------------------------------------------------
+
+unsigned int network_server::get_view_delay(unsigned int client_id) const
 {
+    auto it = m_clients.find(client_id);
+    return it == m_clients.end() ? 0 : it->second.view_delay;
+}
+
+//------------------------------------------------------------
+
+//network thread, the only one that touches the sockets while the server is open
+void network_server::poll_io(net_io &io)
+{
+    net_io_msg m;
+    while (io.get_posted(m))
+    {
+        if (m.t == net_io_msg::type_tcp)
+            m_server.send_message(m.client_id, m.data);
+        else if (m.t == net_io_msg::type_udp)
+            m_udp.send(m.address, m.data);
+        else if (m.t == net_io_msg::type_disconnect)
+            m_server.disconnect_user(m.client_id);
+    }
+
     m_server.update();
 
     for (int i = 0; i < m_server.get_new_client_count(); ++i)
     {
-        auto id = m_server.get_new_client(i);
+        net_io_msg c;
+        c.t = net_io_msg::type_connected;
+        c.client_id = m_server.get_new_client(i);
+        io.deliver(std::move(c));
+    }
 
-        if (!m_server.send_message(id, m_header))
-        {
-            m_server.disconnect_user(id);
+    for (int i = 0; i < m_server.get_lost_client_count(); ++i)
+    {
+        net_io_msg c;
+        c.t = net_io_msg::type_lost;
+        c.client_id = m_server.get_lost_client(i);
+        io.deliver(std::move(c));
+    }
+
+    std::vector<std::string> msgs;
+    for (size_t i = 0; i < m_server.get_message_count(); ++i)
+    {
+        auto &msg = m_server.get_message(i);
+        if (!msg_batch::is_batch(msg.second))
+            msgs.assign(1, msg.second);
+        else if (!msg_batch::split(msg.second, msgs))
             continue;
+
+        for (auto &s: msgs)
+        {
+            net_io_msg t;
+            t.client_id = msg.first;
+            t.parsed = parse_tcp_msg(s);
+            t.data = std::move(s);
+            io.deliver(std::move(t));
         }
+    }
 
-        if (m_max_players > 0 && get_players_count() >= m_max_players)
+    net_io_msg u;
+    u.t = net_io_msg::type_udp;
+    while (m_udp.receive(u.data, u.address))
+        io.deliver(std::move(u));
+
+    io.set_open(m_server.is_open());
+}
+
+//------------------------------------------------------------
+
+void network_server::update()
+{
+    net_io_msg m;
+    while (m_io.receive(m))
+    {
+        switch (m.t)
         {
-            m_server.send_message(id, "max_players_limit");
-            m_server.disconnect_user(id);
-            continue;
+            case net_io_msg::type_connected: add_request(m.client_id); break;
+            case net_io_msg::type_lost: remove_client(m.client_id); break;
+            case net_io_msg::type_tcp: process_msg(m.client_id, m); break;
+            case net_io_msg::type_udp: receive_udp(m.data, m.address); break;
+            default: break;
         }
+    }
+
+    flush();
+}
 
-        m_requests.insert(id);
+//------------------------------------------------------------
+
+void network_server::flush()
+{
+    for (auto &c: m_clients)
+    {
+        auto &b = c.second.batch;
+        if (b.empty())
+            continue;
+
+        c.second.tcp_messages_sent += b.get_count();
+        std::string frame = b.take();
+        ++c.second.tcp_frames_sent;
+        c.second.tcp_bytes_sent += frame.size();
+        m_io.post_tcp(c.first, std::move(frame));
     }
+}
 
-    for (int i = 0; i < m_server.get_lost_client_count(); ++i)
-        remove_client(m_server.get_lost_client(i));
+//------------------------------------------------------------
 
-    for (size_t i = 0; i < m_server.get_message_count(); ++i)
-        process_msg(m_server.get_message(i));
+void network_server::add_request(unsigned int id)
+{
+    m_io.post_tcp(id, std::string(m_header));
+
+    if (m_max_players > 0 && get_players_count() >= m_max_players)
+    {
+        m_io.post_tcp(id, "max_players_limit");
+        disconnect_user(id);
+        return;
+    }
+
+    m_requests.insert(id);
+}
+
+//------------------------------------------------------------
+
+void network_server::disconnect_user(unsigned int id)
+{
+    net_io_msg m;
+    m.t = net_io_msg::type_disconnect;
+    m.client_id = id;
+    m_io.post(std::move(m));
 }
 
 //------------------------------------------------------------
 
-void network_server::process_msg(const std::pair<miso::server_tcp::client_id, std::string> &msg)
+void network_server::process_msg(unsigned int id, const net_io_msg &m)
 {
-    const auto id = msg.first;
+    const std::string &msg = m.data;
 
     auto c = m_clients.find(id);
     if (c != m_clients.end())
     {
-        process_msg(c->second, msg.second);
+        if (m.parsed)
+            process_msg(c->second, msg, *m.parsed);
+        else
+            process_msg(c->second, msg);
         return;
     }
 
@@ -118,22 +247,26 @@ void network_server::process_msg(const std::pair<miso::server_tcp::client_id, st
     if (r == m_requests.end())
         return;
 
-    if (msg.second == "connect")
+    if (msg == "connect")
     {
         if (m_max_players > 0 && get_players_count() >= m_max_players)
         {
-            m_server.send_message(id, "max_players_limit");
-            m_server.disconnect_user(id);
+            m_io.post_tcp(id, "max_players_limit");
+            disconnect_user(id);
             m_requests.erase(id);
         }
         else
         {
+            static std::random_device random;
+            const uint32_t udp_token = m_udp.is_open() ? (uint32_t(random()) | 1) : 0;
+
             const unsigned int client_range = (unsigned int)(-1) / 1024;
             m_last_client_range += client_range;
-            m_server.send_message(id, "connected " + std::to_string(id) + " " + std::to_string(m_last_client_range));
+            m_io.post_tcp(id, "connected " + std::to_string(id) + " " + std::to_string(m_last_client_range) + " " + std::to_string(udp_token));
             m_requests.erase(id);
             client &c = m_clients[id];
             c.id = id;
+            c.udp_token = udp_token;
         }
     }
 }
@@ -146,7 +279,7 @@ void network_server::cache_net_game_data(const msg_game_data &data)
     {
         if (d.plane_id == data.plane_id)
         {
-            d = data;
+            d.data.merge(data.data);
             return;
         }
     }
@@ -162,62 +295,19 @@ void network_server::process_msg(client &c, const std::string &msg)
     std::string cmd;
     is>>cmd;
 
-    if (cmd == "plane")
-    {
-        unsigned int time, plane_id;
-        is >> time, is >> plane_id;
-
-        for (auto &p: m_planes.objects)
-        {
-            if (p.r.id == plane_id)
-            {
-                if (p.last_time > time)
-                    break;
-
-                read(is, p.net);
-                const int time_fix = int(m_time - time);
-
-                for (auto &oc: m_clients)
-                {
-                    if (oc.first == c.id)
-                        continue;
-
-                    m_server.send_message(oc.first, "plane " + std::to_string(time) + " " + std::to_string(p.r.id) + " "+ to_string(p.net));
-                }
-
-                p.net->pos += p.net->vel * (0.001f * time_fix);
-                p.last_time = time;
-                break;
-            }
-        }
-    }
-    else if (cmd == "missile")
+    if (cmd == "missile")
     {
         unsigned int time, missile_id;
         is >> time, is >> missile_id;
 
-        for (auto &m: m_missiles.objects)
+        auto o = m_missiles.get(missile_id);
+        if (o && o->last_time <= time)
         {
-            if (m.r.id == missile_id)
-            {
-                if (m.last_time > time)
-                    break;
-
-                read(is, m.net);
-                const int time_fix = int(m_time - time);
-
-                for (auto &oc: m_clients)
-                {
-                    if (oc.first == c.id)
-                        continue;
-
-                    m_server.send_message(oc.first, "missile " + std::to_string(time) + " " + std::to_string(m.r.id) + " "+ to_string(m.net));
-                }
-
-                m.net->pos += m.net->vel * (0.001f * time_fix);
-                m.last_time = time;
-                break;
-            }
+            auto &m = *o;
+            read(is, m.net);
+            const int time_fix = int(m_time - time);
+            m.net->pos += m.net->vel * (0.001f * time_fix);
+            m.last_time = time;
         }
     }
     else if (cmd == "message")
@@ -231,37 +321,19 @@ void network_server::process_msg(client &c, const std::string &msg)
             if (oc.first == c.id)
                 continue;
 
-            m_server.send_message(oc.first, msg);
+            oc.second.batch.add(msg);
         }
     }
-    else if (cmd == "game_data")
+    else if (cmd == "events")
     {
-        msg_game_data mg;
-        read(is, mg);
-        m_game_data_msg.push_back(mg);
-        cache_net_game_data(mg);
+        m_events.push_back(msg.substr(cmd.size() + 1));
 
         for (auto &oc: m_clients)
         {
             if (oc.first == c.id)
                 continue;
 
-            m_server.send_message(oc.first, msg);
-        }
-    }
-    else if (cmd == "add_plane")
-    {
-        msg_add_plane ap;
-        read(is, ap);
-        ap.client_id = c.id;
-        m_planes.add_msgs.push_back(ap);
-
-        for (auto &oc: m_clients)
-        {
-            if(oc.first == c.id)
-                continue;
-
-            m_server.send_message(oc.first, "add_plane " + to_string(ap));
+            oc.second.batch.add(msg);
         }
     }
     else if (cmd == "add_missile")
@@ -272,12 +344,13 @@ void network_server::process_msg(client &c, const std::string &msg)
         am.client_id = c.id;
         m_missiles.add_msgs.push_back(am);
 
+        const std::string relay = "add_missile " + to_string(am);
         for (auto &oc: m_clients)
         {
             if(oc.first == c.id)
                 continue;
 
-            m_server.send_message(oc.first, "add_missile " + to_string(am));
+            oc.second.batch.add(relay);
         }
     }
     else if (cmd == "remove_missile")
@@ -292,62 +365,102 @@ void network_server::process_msg(client &c, const std::string &msg)
             if(oc.first == c.id)
                 continue;
 
-            m_server.send_message(oc.first, msg);
+            oc.second.batch.add(msg);
         }
     }
-    else if (cmd == "sync_time")
+    else if (cmd == "start")
     {
-        m_server.send_message(c.id, "ready");
+        for (auto &p: m_planes.objects)
+        {
+            if (p.r.client_id != c.id)
+                c.batch.add("add_plane " + to_string(p.r));
+        }
+
+        for (auto &d: m_game_data_cache)
+            c.batch.add("game_data " + to_string(d));
+
+        c.started = true;
+    }
+    else if (cmd == "keepalive") {}
+    else
+        printf("server received: %s\n", msg.c_str());
+}
 
-        std::vector<std::pair<miso::server_interface::client_id, std::string> > other_messages;
+//------------------------------------------------------------
 
-        bool ready = false;
-        while (m_server.is_open() && !ready)
+void network_server::process_msg(client &c, const std::string &msg, const net_tcp_msg &m)
+{
+    switch (m.t)
+    {
+        case net_tcp_msg::type_plane:
         {
-            m_server.update();
-            for (int j = 0; j < m_server.get_message_count(); ++j)
+            auto o = m_planes.get(m.id);
+            if (o && o->last_time <= m.time)
             {
-                auto &m = m_server.get_message(j);
-                if(m.first == c.id && m.second=="sync")
-                    ready = true;
-                else
-                    other_messages.push_back(m);
+                auto &p = *o;
+                net_packet::apply(m.plane, *p.net);
+                const int time_fix = int(m_time - m.time);
+                p.net->pos += p.net->vel * (0.001f * time_fix);
+                p.last_time = m.time;
             }
+            break;
         }
 
-        m_server.send_message(c.id, "time " + std::to_string(m_time));
+        case net_tcp_msg::type_game_data:
+        {
+            m_game_data_msg.push_back(m.game_data);
+            cache_net_game_data(m.game_data);
 
-        for (auto &o: other_messages)
-            process_msg(o);
-    }
-    else if (cmd == "start")
-    {
-        for (auto &p: m_planes.objects)
-            m_server.send_message(c.id, "add_plane " + to_string(p.r));
+            for (auto &oc: m_clients)
+            {
+                if (oc.first == c.id)
+                    continue;
 
-        for (auto &d: m_game_data_cache)
-            m_server.send_message(c.id, "game_data " + to_string(d));
+                oc.second.batch.add(msg);
+            }
+            break;
+        }
 
-        c.started = true;
+        case net_tcp_msg::type_add_plane:
+        {
+            msg_add_plane ap = m.add_plane;
+            ap.client_id = c.id;
+            m_planes.add_msgs.push_back(ap);
+
+            const std::string relay = "add_plane " + to_string(ap);
+            for (auto &oc: m_clients)
+            {
+                if(oc.first == c.id)
+                    continue;
+
+                oc.second.batch.add(relay);
+            }
+            break;
+        }
+
+        case net_tcp_msg::type_ping:
+        {
+            //answered within this update, server time is interpolated between ticks
+            c.rtt = m.rtt, c.view_delay = m.view_delay;
+            const unsigned int time = m_time + (m_last_update_time ? (unsigned int)(nya_system::get_time() - m_last_update_time) : 0);
+            c.batch.add("pong " + m.ping_time + " " + std::to_string(time));
+            break;
+        }
     }
-    else
-        printf("server received: %s\n", msg.c_str());
 }
 
 //------------------------------------------------------------
 
-template<typename rs, typename cs> void send_requests(rs &requests, cs &clients, miso::server_tcp &server, const std::string &msg)
+template<typename rs, typename cs> void send_requests(rs &requests, cs &clients, const std::string &msg)
 {
-    if (requests.empty())
-        return;
-
-    for (auto &c: clients)
+    for (auto &r: requests)
     {
-        if (!c.second.started)
-            continue;
-
-        for (auto &r: requests)
-            server.send_message(c.first, msg + " " + to_string(r));
+        const std::string text = msg + " " + to_string(r);
+        for (auto &c: clients)
+        {
+            if (c.second.started)
+                c.second.batch.add(text);
+        }
     }
 
     requests.clear();
@@ -355,25 +468,76 @@ template<typename rs, typename cs> void send_requests(rs &requests, cs &clients,
 
 //------------------------------------------------------------
 
-template<typename rs, typename cs> void send_objects(rs &objs, cs &clients, miso::server_tcp &server, unsigned int time, const std::string &msg)
+//server's own objects and the ones received from clients, at the rate of their relevance for each client
+template<typename rs, typename cs, typename cl> void send_objects(rs &objs, cs &clients, net_priority cl::*priority, const net_relevance::params &rp,
+                                                                 net_io &io, const net_quantizer &q, unsigned int time,
+                                                                 const std::string &msg, net_packet::type type)
 {
-    send_requests(objs.add_requests, clients, server, "add_" + msg);
+    send_requests(objs.add_requests, clients, "add_" + msg);
+
+    //same text for every tcp client, made on first use
+    std::vector<std::string> texts(objs.objects.size());
+    auto get_text = [&](size_t idx) -> const std::string &
+    {
+        auto &t = texts[idx];
+        if (t.empty())
+        {
+            const auto &o = objs.objects[idx];
+            if (o.net->source && o.net.unique())
+                t = "remove_" + msg + " " + std::to_string(o.r.id);
+            else
+                t = msg + " " + std::to_string(time) + " " + std::to_string(o.r.id) + " "+ to_string(o.net);
+        }
+
+        return t;
+    };
+
+    net_packet p;
+    p.t = type;
+    p.time = time;
 
     for (auto &c: clients)
     {
         if (!c.second.started)
             continue;
 
-        for (auto &o: objs.objects)
+        const auto &to = c.second.udp_address;
+        auto &channel = c.second.channel;
+        p.client_id = c.first;
+        p.token = c.second.udp_token;
+
+        auto &pr = c.second.*priority;
+        for (size_t i = 0; i < objs.objects.size(); ++i)
         {
-            if (!o.net->source)
+            auto &o = objs.objects[i];
+            if (o.net->source && o.net.unique())
+            {
+                c.second.batch.add(get_text(i));
                 continue;
+            }
 
-            if (o.net.unique())
-                server.send_message(c.first, "remove_" + msg + " " + std::to_string(o.r.id));
+            if (o.r.client_id == c.first || (!o.net->source && !o.last_time))
+                continue;
+
+            const float score = net_relevance::get_score(rp, c.second.viewers, o.net->pos, c.second.important.count(o.r.id) > 0);
+            if (score > 0.0f)
+                pr.add(o.r.id, score);
+        }
+
+        for (auto id: pr.select(rp.max_records))
+        {
+            auto o = objs.get(id);
+            if (to.is_valid())
+            {
+                p.add(id, *o->net);
+                if (p.is_full())
+                    send(io, to, p, channel, q);
+            }
             else
-                server.send_message(c.first, msg + " " + std::to_string(time) + " " + std::to_string(o.r.id) + " "+ to_string(o.net));
+                c.second.batch.add(get_text(o - objs.objects.data()));
         }
+
+        send(io, to, p, channel, q);
     }
 
     objs.remove_src_unique();
@@ -381,9 +545,52 @@ template<typename rs, typename cs> void send_objects(rs &objs, cs &clients, miso
 
 //------------------------------------------------------------
 
+void network_server::update_relevance()
+{
+    for (auto &c: m_clients)
+    {
+        c.second.viewers.clear();
+        c.second.important.clear();
+    }
+
+    for (auto &p: m_planes.objects)
+    {
+        auto c = m_clients.find(p.r.client_id);
+        if (c == m_clients.end())
+            continue;
+
+        net_relevance::viewer v;
+        v.pos = p.net->pos;
+        v.dir = p.net->rot.rotate(nya_math::vec3::forward());
+        c->second.viewers.push_back(v);
+    }
+
+    //client's targets and missiles at client's planes with their launchers
+    for (auto &m: m_missiles.objects)
+    {
+        auto c = m_clients.find(m.r.client_id);
+        if (c != m_clients.end() && m.net->target != invalid_id)
+            c->second.important.insert(m.net->target);
+
+        auto t = m_planes.get(m.net->target);
+        if (!t)
+            continue;
+
+        c = m_clients.find(t->r.client_id);
+        if (c == m_clients.end())
+            continue;
+
+        c->second.important.insert(m.r.id);
+        c->second.important.insert(m.r.plane_id);
+    }
+}
+
+//------------------------------------------------------------
+
 void network_server::update_post(int dt)
 {
     m_time += dt;
+    m_last_update_time = nya_system::get_time();
     if (m_time - m_last_send_time < 1000 / net_fps)
         return;
     m_last_send_time = m_time;
@@ -391,23 +598,85 @@ void network_server::update_post(int dt)
     for (auto &d: m_game_data_msg_requests)
         cache_net_game_data(d);
 
-    send_objects(m_planes, m_clients, m_server, m_time, "plane");
-    send_objects(m_missiles, m_clients, m_server, m_time, "missile");
-    send_requests(m_general_msg_requests, m_clients, m_server, "message");
-    send_requests(m_game_data_msg_requests, m_clients, m_server, "game_data");
+    update_relevance();
+    send_objects(m_planes, m_clients, &client::plane_priority, m_relevance, m_io, m_quantizer, m_time, "plane", net_packet::type_planes);
+    send_objects(m_missiles, m_clients, &client::missile_priority, m_relevance, m_io, m_quantizer, m_time, "missile", net_packet::type_missiles);
+
+    for (auto &c: m_clients)
+        c.second.channel.update_stats(m_time);
+    send_requests(m_general_msg_requests, m_clients, "message");
+    send_requests(m_events_requests, m_clients, "events");
+    send_requests(m_game_data_msg_requests, m_clients, "game_data");
+    flush();
+}
+
+//------------------------------------------------------------
+
+//applies the states the sender owns, they go to other clients with send_objects
+template<typename rs, typename records> void receive_states(rs &objs, const records &states, unsigned int sender, unsigned int t, unsigned int time)
+{
+    for (auto &s: states)
+    {
+        auto o = objs.get(s.id);
+        if (!o || o->r.client_id != sender || o->last_time > t)
+            continue;
+
+        net_packet::apply(s.state, *o->net);
+        const int time_fix = int(time - t);
+        o->net->pos += o->net->vel * (0.001f * time_fix);
+        o->last_time = t;
+    }
+}
+
+//------------------------------------------------------------
+
+void network_server::receive_udp(const std::string &data, const udp_socket::address &from)
+{
+    net_packet p;
+    if (!p.read_header(data))
+        return;
+
+    auto c = m_clients.find(p.client_id);
+    if (c == m_clients.end() || !c->second.udp_token || c->second.udp_token != p.token)
+        return;
+
+    auto &channel = c->second.channel;
+    if (p.t == net_packet::type_hello)
+    {
+        if (c->second.udp_address != from)
+            channel.reset();
+
+        c->second.udp_address = from;
+        if (p.read(data, channel, m_quantizer))
+            send(m_io, from, p, channel, m_quantizer);
+        return;
+    }
+
+    if (from != c->second.udp_address || !p.read(data, channel, m_quantizer))
+        return;
+
+    const unsigned int sender = p.client_id;
+    if (p.t == net_packet::type_planes)
+        receive_states(m_planes, p.planes, sender, p.time, m_time);
+    else if (p.t == net_packet::type_missiles)
+        receive_states(m_missiles, p.missiles, sender, p.time, m_time);
 }
 
 //------------------------------------------------------------
 
 void network_server::remove_client(miso::server_tcp::client_id id)
 {
+    m_clients.erase(id);
+    m_requests.erase(id);
+
     for (auto &p: m_planes.objects)
     {
         if (p.r.client_id != id)
             continue;
 
+        const std::string msg = "remove_plane " + std::to_string(p.r.id);
         for (auto &c: m_clients)
-            m_server.send_message(c.first, "remove_plane " + std::to_string(p.r.id));
+            c.second.batch.add(msg);
     }
 
     m_planes.remove_by_client_id(id);
@@ -417,8 +686,9 @@ void network_server::remove_client(miso::server_tcp::client_id id)
         if (m.r.client_id != id)
             continue;
 
+        const std::string msg = "remove_missile " + std::to_string(m.r.id);
         for (auto &c: m_clients)
-            m_server.send_message(c.first, "remove_missile " + std::to_string(m.r.id));
+            c.second.batch.add(msg);
     }
 
     m_missiles.remove_by_client_id(id);
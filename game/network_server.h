@@ -5,7 +5,12 @@
 #pragma once
 
 #include "network_data.h"
+#include "network_udp.h"
+#include "network_channel.h"
+#include "network_relevance.h"
+#include "network_io.h"
 #include "miso/server/server_tcp.h"
+#include "miso/protocol/app_protocol_simple.h"
 
 #include <map>
 #include <set>
@@ -21,33 +26,64 @@ public:
     void close();
 
     bool is_server() const override { return true; }
-    bool is_up() const { return m_server.is_open(); }
+    bool is_up() const { return m_io.is_open(); }
 
     int get_players_count() const;
 
+    //udp traffic per client
+    std::vector<net_stats> get_stats() const;
+
+    void set_relevance_params(const net_relevance::params &p) { m_relevance = p; }
+
     ~network_server();
 
 private:
     void update() override;
     void update_post(int dt) override;
+    void set_location_size(float half_size) override { m_quantizer.set_location_size(half_size); }
+    unsigned int get_view_delay(unsigned int client_id) const override;
 
 private:
     struct client;
-    void process_msg(const std::pair<miso::server_tcp::client_id, std::string> &msg);
+    void poll_io(net_io &io);
+    void add_request(unsigned int id);
+    void disconnect_user(unsigned int id);
+    void process_msg(unsigned int id, const net_io_msg &m);
     void process_msg(client &c, const std::string &msg);
+    void process_msg(client &c, const std::string &msg, const net_tcp_msg &m);
     void remove_client(miso::server_tcp::client_id id);
+    void receive_udp(const std::string &data, const udp_socket::address &from);
+    void flush();
+    void update_relevance();
 
 private:
+    miso::app_protocol_simple m_protocol; //per instance, servers tick on different threads
     miso::server_tcp m_server;
+    udp_socket m_udp;
+    net_io m_io;
+    net_quantizer m_quantizer;
+    net_relevance::params m_relevance;
     std::string m_header;
     int m_max_players = 0;
     unsigned int m_last_send_time = 0;
+    unsigned long m_last_update_time = 0; //wall time of the last update_post
     unsigned int m_last_client_range = 0;
 
     struct client
     {
         miso::server_tcp::client_id id;
         bool started = false;
+        uint32_t udp_token = 0;
+        udp_socket::address udp_address; //valid after the client's hello
+        net_channel channel;
+        msg_batch batch; //tcp messages until the next flush
+        uint64_t tcp_messages_sent = 0, tcp_frames_sent = 0, tcp_bytes_sent = 0;
+        int rtt = 0; //reported by the client
+        unsigned int view_delay = 0; //interpolation delay, reported by the client
+
+        std::vector<net_relevance::viewer> viewers; //client's planes
+        std::set<unsigned int> important; //client's targets and threats to the client
+        net_priority plane_priority, missile_priority;
     };
 
     std::map<miso::server_tcp::client_id, client> m_clients;
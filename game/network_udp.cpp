@@ -0,0 +1,233 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "network_udp.h"
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+    typedef int socklen_t;
+    typedef SOCKET socket_t;
+    #include <chrono>
+    #include <thread>
+#else
+    #include <sys/socket.h>
+    #include <poll.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <netdb.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    typedef int socket_t;
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+namespace
+{
+
+bool init_sockets()
+{
+#ifdef _WIN32
+    static const bool initialised = []
+    {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+
+    return initialised;
+#else
+    return true;
+#endif
+}
+
+}
+
+//------------------------------------------------------------
+
+udp_socket::address udp_socket::resolve(const char *host, unsigned short port)
+{
+    address a;
+    if (!host || !init_sockets())
+        return a;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo *result = 0;
+    if (getaddrinfo(host, 0, &hints, &result) != 0 || !result)
+        return a;
+
+    a.ip = ((sockaddr_in *)result->ai_addr)->sin_addr.s_addr;
+    a.port = port;
+    freeaddrinfo(result);
+    return a;
+}
+
+//------------------------------------------------------------
+
+bool udp_socket::open(unsigned short port, bool loopback)
+{
+    close();
+
+    if (!init_sockets())
+        return false;
+
+    const auto s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef _WIN32
+    if (s == INVALID_SOCKET)
+        return false;
+
+    u_long non_blocking = 1;
+    ioctlsocket(s, FIONBIO, &non_blocking);
+#else
+    if (s < 0)
+        return false;
+
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    m_socket = (intptr_t)s;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(loopback ? INADDR_LOOPBACK : INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(s, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        printf("unable to bind udp port %d\n", port);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------
+
+void udp_socket::close()
+{
+    if (m_socket < 0)
+        return;
+
+#ifdef _WIN32
+    closesocket((socket_t)m_socket);
+#else
+    ::close((int)m_socket);
+#endif
+    m_socket = -1;
+}
+
+//------------------------------------------------------------
+
+bool udp_socket::is_open() const { return m_socket >= 0; }
+
+//------------------------------------------------------------
+
+unsigned short udp_socket::get_port() const
+{
+    if (m_socket < 0)
+        return 0;
+
+    sockaddr_in addr;
+    socklen_t addr_size = sizeof(addr);
+    if (getsockname((socket_t)m_socket, (sockaddr *)&addr, &addr_size) != 0)
+        return 0;
+
+    return ntohs(addr.sin_port);
+}
+
+//------------------------------------------------------------
+
+bool udp_socket::send(const address &to, const std::string &data)
+{
+    if (m_socket < 0 || !to.is_valid())
+        return false;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = to.ip;
+    addr.sin_port = htons(to.port);
+
+    return sendto((socket_t)m_socket, data.data(), (int)data.size(), 0, (sockaddr *)&addr, sizeof(addr)) == (int)data.size();
+}
+
+//------------------------------------------------------------
+
+bool udp_socket::receive(std::string &data, address &from)
+{
+    if (m_socket < 0)
+        return false;
+
+    char buf[2048];
+    sockaddr_in addr;
+    socklen_t addr_size = sizeof(addr);
+    const int size = (int)recvfrom((socket_t)m_socket, buf, sizeof(buf), 0, (sockaddr *)&addr, &addr_size);
+    if (size < 0) //would block or error, both mean no data
+        return false;
+
+    data.assign(buf, size);
+    from.ip = addr.sin_addr.s_addr;
+    from.port = ntohs(addr.sin_port);
+    return true;
+}
+
+//------------------------------------------------------------
+
+bool udp_socket::wait(const udp_socket *const *sockets, int count, int timeout_ms)
+{
+    if (count > max_wait_sockets)
+        count = max_wait_sockets;
+
+#ifdef _WIN32
+    //fd_set is a list of handles here, not a bit mask indexed by the descriptor
+    fd_set set;
+    FD_ZERO(&set);
+    for (int i = 0; i < count; ++i)
+    {
+        if (sockets[i] && sockets[i]->m_socket >= 0)
+            FD_SET((socket_t)sockets[i]->m_socket, &set);
+    }
+
+    if (!set.fd_count) //select fails without sockets
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return false;
+    }
+
+    timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    return select(0, &set, 0, 0, &tv) > 0;
+#else
+    //poll has no FD_SETSIZE limit on the descriptor values
+    pollfd fds[max_wait_sockets];
+    int fds_count = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (!sockets[i] || sockets[i]->m_socket < 0)
+            continue;
+
+        fds[fds_count].fd = (int)sockets[i]->m_socket;
+        fds[fds_count].events = POLLIN;
+        fds[fds_count].revents = 0;
+        ++fds_count;
+    }
+
+    return poll(fds, fds_count, timeout_ms) > 0;
+#endif
+}
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,52 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "util/util.h"
+#include <string>
+#include <stdint.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+//non-blocking ipv4 datagram socket for the state channel
+
+class udp_socket: public noncopyable
+{
+public:
+    struct address
+    {
+        uint32_t ip = 0; //network byte order
+        uint16_t port = 0;
+
+        bool is_valid() const { return port != 0; }
+        bool operator == (const address &a) const { return ip == a.ip && port == a.port; }
+        bool operator != (const address &a) const { return !(*this == a); }
+    };
+
+    static address resolve(const char *host, unsigned short port);
+
+public:
+    bool open(unsigned short port = 0, bool loopback = false); //0 for any free port, loopback binds to 127.0.0.1 only
+    void close();
+    bool is_open() const;
+    unsigned short get_port() const;
+
+    bool send(const address &to, const std::string &data);
+    bool receive(std::string &data, address &from); //false if there's nothing to receive
+
+    //blocks until one of the open sockets has data or the time is out, false on timeout
+    static bool wait(const udp_socket *const *sockets, int count, int timeout_ms); //up to max_wait_sockets
+    enum { max_wait_sockets = 8 };
+
+    ~udp_socket() { close(); }
+
+private:
+    intptr_t m_socket = -1;
+};
+
+//------------------------------------------------------------
+}
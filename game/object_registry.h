@@ -0,0 +1,106 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "plane.h"
+#include "units.h"
+#include <unordered_map>
+
+namespace game
+{
+//------------------------------------------------------------
+
+class object_registry
+{
+public:
+    void add(const plane_ptr &p)
+    {
+        add_object(p);
+        m_planes[p.get()] = p;
+        m_planes_phys[p->phys.get()] = p;
+        if (p->net)
+            m_planes_net[p->net.get()] = p;
+    }
+
+    void add(const unit_ptr &u) { add_object(u); }
+    void add(const missile_ptr &m) { m_missiles_phys[m->phys.get()] = m; }
+    void add(const bomb_ptr &b) { m_bombs_phys[b->phys.get()] = b; }
+
+    void remove(const plane_ptr &p)
+    {
+        remove_object(p.get());
+        m_planes.erase(p.get());
+        m_planes_phys.erase(p->phys.get());
+        if (p->net)
+            m_planes_net.erase(p->net.get());
+    }
+
+    void remove(const unit_ptr &u) { remove_object(u.get()); }
+    void remove(const missile_ptr &m) { m_missiles_phys.erase(m->phys.get()); }
+    void remove(const bomb_ptr &b) { m_bombs_phys.erase(b->phys.get()); }
+
+    //stable while the object is alive, never reused
+    unsigned int get_id(const object *o) const
+    {
+        auto it = m_ids.find(o);
+        return it == m_ids.end() ? invalid_id : it->second;
+    }
+
+    object_ptr get_object(unsigned int id) const { return find(m_objects, id); }
+
+    plane_ptr get_plane(const object *o) const { return find(m_planes, o); }
+    plane_ptr get_plane(const phys::object *o) const { return find(m_planes_phys, o); }
+    plane_ptr get_plane(const net_plane *n) const { return find(m_planes_net, n); }
+    missile_ptr get_missile(const phys::object *o) const { return find(m_missiles_phys, o); }
+    bomb_ptr get_bomb(const phys::object *o) const { return find(m_bombs_phys, o); }
+
+    void clear()
+    {
+        m_ids.clear();
+        m_objects.clear();
+        m_planes.clear();
+        m_planes_phys.clear();
+        m_planes_net.clear();
+        m_missiles_phys.clear();
+        m_bombs_phys.clear();
+    }
+
+private:
+    void add_object(const object_ptr &o)
+    {
+        const unsigned int id = m_last_id++;
+        m_ids[o.get()] = id;
+        m_objects[id] = o;
+    }
+
+    void remove_object(const object *o)
+    {
+        auto it = m_ids.find(o);
+        if (it == m_ids.end())
+            return;
+
+        m_objects.erase(it->second);
+        m_ids.erase(it);
+    }
+
+    template<typename k, typename t> static ptr<t> find(const std::unordered_map<k, w_ptr<t> > &map, const k &key)
+    {
+        auto it = map.find(key);
+        return it == map.end() ? ptr<t>() : it->second.lock();
+    }
+
+private:
+    std::unordered_map<const object *, unsigned int> m_ids;
+    std::unordered_map<unsigned int, object_wptr> m_objects;
+    std::unordered_map<const object *, w_ptr<plane> > m_planes;
+    std::unordered_map<const phys::object *, w_ptr<plane> > m_planes_phys;
+    std::unordered_map<const net_plane *, w_ptr<plane> > m_planes_net;
+    std::unordered_map<const phys::object *, w_ptr<missile> > m_missiles_phys;
+    std::unordered_map<const phys::object *, w_ptr<bomb> > m_bombs_phys;
+    unsigned int m_last_id = 0;
+};
+
+//------------------------------------------------------------
+}
@@ -63,6 +63,7 @@ void plane::update_targets(world &w)
 {
     const plane_ptr &me = shared_from_this();
     const vec3 dir = get_dir();
+    const vec3 pos = me->get_pos();
     jammed = false;
 
     bool lock_air = special_weapon_selected ? (bool)special.lockon_air : true;
@@ -70,55 +71,67 @@ void plane::update_targets(world &w)
 
     bool first_target = targets.empty();
 
-    for (int i = 0; i < w.get_objects_count(); ++i)
+    w.track_objects(pos, radar_range, radar_planes, radar_units);
+
+    for (auto &c: radar_planes.items)
     {
-        const auto o = w.get_object(i);
-        if (o->is_ally(me, w))
+        auto p = c.value.lock();
+        if (!p || p == me || !p->is_ecm_active() || !p->is_targetable(lock_air, lock_ground))
             continue;
 
-        auto t = std::find_if(targets.begin(), targets.end(), [o](target_lock &t) { return o == t.target.lock(); });
-        auto target_dir = o->get_pos() - me->get_pos();
-        const float dist = target_dir.length();
-
-        if (dist > 12000.0f || !o->is_targetable(lock_air, lock_ground))
+        if ((p->get_pos() - pos).length_sq() < p->special.action_range * p->special.action_range && !p->is_ally(me, w))
         {
-            if (t != targets.end())
-                targets.erase(t);
-            continue;
+            jammed = true;
+            targets.clear();
+            return;
         }
+    }
 
-        if (i < w.get_planes_count())
-        {
-            auto p = w.get_plane(i);
-            if (p->is_ecm_active() && dist < p->special.action_range)
-            {
-                jammed = true;
-                targets.clear();
-                break;
-            }
-        }
+    auto in_range = [&](const object_ptr &o, target_lock &l)
+    {
+        const auto target_dir = o->get_pos() - pos;
+        const float dist_sq = target_dir.length_sq();
+        if (dist_sq > radar_range * radar_range || o->hp <= 0 || !o->is_targetable(lock_air, lock_ground) || o->is_ally(me, w))
+            return false;
 
-        if (t == targets.end())
-        {
-            target_lock l;
-            l.target = o;
-            t = targets.insert(targets.end(), l);
-        }
+        l.dist = sqrtf(dist_sq);
+        l.cos = l.dist > 0.0f ? target_dir.dot(dir) / l.dist : 1.0f;
+        return true;
+    };
 
-        t->dist = dist;
-        t->cos = target_dir.dot(dir) / dist;
-    }
+    //targets that left the range leave the list
 
-    auto *wp = &w;
-    targets.erase(std::remove_if(targets.begin(), targets.end(),
-                                 [me, wp](const target_lock &t)
+    radar_listed.clear();
+    targets.erase(std::remove_if(targets.begin(), targets.end(), [&](target_lock &t)
                                  {
-                                     if (t.target.expired())
+                                     auto tt = t.target.lock();
+                                     if (!tt || !in_range(tt, t))
                                          return true;
 
-                                     auto tt = t.target.lock();
-                                     return tt->hp <= 0 || tt->is_ally(me, *wp);
+                                     radar_listed.push_back(tt.get());
+                                     return false;
                                  }), targets.end());
+
+    std::sort(radar_listed.begin(), radar_listed.end());
+
+    auto add = [&](const object_ptr &o)
+    {
+        if (!o || o.get() == me.get() || std::binary_search(radar_listed.begin(), radar_listed.end(), o.get()))
+            return;
+
+        target_lock l;
+        if (!in_range(o, l))
+            return;
+
+        l.target = o;
+        targets.push_back(l);
+    };
+
+    for (auto &c: radar_planes.items)
+        add(c.value.lock());
+    for (auto &c: radar_units.items)
+        add(c.value.lock());
+
     if (targets.size() > 1)
         std::sort(first_target ? targets.begin() : std::next(targets.begin()), targets.end(), [](const target_lock &a, const target_lock &b) { return a.dist < b.dist; });
 }
@@ -127,52 +140,54 @@ void plane::update_targets(world &w)
 
 void plane::update_render(world &w)
 {
-    render->set_hide(hp <= 0);
+    auto &r = render_state;
+    r.render = render;
+    r.hide = hp <= 0;
     if (hp <= 0)
     {
         sound_srcs.clear();
         return;
     }
 
-    render->set_pos(phys->pos);
-    render->set_rot(phys->rot);
+    r.prev = last_tick;
+    r.pos = phys->pos;
+    r.rot = phys->rot;
 
-    render->set_damage(max_hp ? float(max_hp-hp) / max_hp : 0.0);
+    r.damage = max_hp ? float(max_hp-hp) / max_hp : 0.0;
 
     const float speed = phys->get_speed_kmh();
     const float speed_k = nya_math::max((phys->params.move.speed.speedMax - speed) / phys->params.move.speed.speedMax, 0.1f);
 
-    render->set_speed(speed);
+    r.speed = speed;
 
-    const float el = nya_math::clamp(-controls.rot.z - controls.rot.x, -1.0f, 1.0f) * speed_k;
-    const float er = nya_math::clamp(controls.rot.z - controls.rot.x, -1.0f, 1.0f) * speed_k;
-    render->set_elev(el, er);
+    r.elev_l = nya_math::clamp(-controls.rot.z - controls.rot.x, -1.0f, 1.0f) * speed_k;
+    r.elev_r = nya_math::clamp(controls.rot.z - controls.rot.x, -1.0f, 1.0f) * speed_k;
 
-    const float rl = nya_math::clamp(-controls.rot.y + controls.brake, -1.0f, 1.0f) * speed_k;
-    const float rr = nya_math::clamp(-controls.rot.y - controls.brake, -1.0f, 1.0f) * speed_k;
-    render->set_rudder(rl, rr, -controls.rot.y);
+    r.rudder_l = nya_math::clamp(-controls.rot.y + controls.brake, -1.0f, 1.0f) * speed_k;
+    r.rudder_r = nya_math::clamp(-controls.rot.y - controls.brake, -1.0f, 1.0f) * speed_k;
+    r.rudder = -controls.rot.y;
 
-    render->set_aileron(-controls.rot.z * speed_k, controls.rot.z * speed_k);
-    render->set_canard(controls.rot.x * speed_k);
-    render->set_brake(controls.brake);
-    render->set_flaperon(speed < phys->params.move.speed.speedCruising - 100 ? -1.0 : 1.0);
-    render->set_wing_sweep(speed >  phys->params.move.speed.speedCruising + 250 ? 1.0 : -1.0);
+    r.aileron_l = -controls.rot.z * speed_k;
+    r.aileron_r = controls.rot.z * speed_k;
+    r.canard = controls.rot.x * speed_k;
+    r.brake = controls.brake;
+    r.flaperon = speed < phys->params.move.speed.speedCruising - 100 ? -1.0 : 1.0;
+    r.wing_sweep = speed >  phys->params.move.speed.speedCruising + 250 ? 1.0 : -1.0;
 
-    render->set_intake_ramp(phys->thrust_time >= phys->params.move.accel.thrustMinWait ? 1.0 : -1.0);
-    render->set_thrust(phys->get_thrust());
+    r.intake_ramp = phys->thrust_time >= phys->params.move.accel.thrustMinWait ? 1.0 : -1.0;
+    r.thrust = phys->get_thrust();
 
-    const float aoa = acosf(nya_math::vec3::dot(nya_math::vec3::normalize(phys->vel), get_dir()));
-    render->set_aoa(aoa);
+    r.aoa = acosf(nya_math::vec3::dot(nya_math::vec3::normalize(phys->vel), get_dir()));
 
-    render->set_missile_bay(missile_bay_time > 0);
-    render->set_special_bay(special_weapon_selected && special_internal);
-    render->set_mgun_bay(controls.mgun);
+    r.missile_bay = missile_bay_time > 0;
+    r.special_bay = special_weapon_selected && special_internal;
+    r.mgun_bay = controls.mgun;
 
     const bool mg_fire = is_mg_bay_ready() && controls.mgun;
     const bool mgp_fire = special_weapon_selected && controls.missile && special.id == "MGP" && special_count > 0;
 
-    render->set_mgun_fire(mg_fire);
-    render->set_mgp_fire(mgp_fire);
+    r.mgun_fire = mg_fire;
+    r.mgp_fire = mgp_fire;
 
     update_sound(w, "VULCAN_REAR", mg_fire);
     update_sound(w, "MGP", mgp_fire);
@@ -918,12 +933,20 @@ void plane::take_damage(int damage, world &w, bool net_src)
 
     if (!w.is_host() && net_src)
     {
-        w.get_network()->general_msg("plane_take_damage " + std::to_string(w.get_network()->get_plane_id(net)) + " " + std::to_string(damage));
+        event_plane_damage e;
+        e.plane_id = w.get_network()->get_plane_id(net);
+        e.damage = damage;
+        w.send_event(e);
         return;
     }
 
     if (w.is_host() && w.get_network())
-        w.get_network()->general_msg("plane_set_hp " + std::to_string(w.get_network()->get_plane_id(net)) + " " + std::to_string(hp));
+    {
+        event_plane_hp e;
+        e.plane_id = w.get_network()->get_plane_id(net);
+        e.hp = hp;
+        w.send_event(e);
+    }
 
     if (hp <= 0)
     {
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "game.h"
+#include "util/spatial_hash.h"
 
 namespace game
 {
@@ -31,6 +32,8 @@ struct plane: public object, public std::enable_shared_from_this<plane>
 
     phys::plane_ptr phys;
     renderer::aircraft_ptr render;
+    render_snapshot::plane render_state;
+    tick_transform last_tick;
     bvalue special_weapon_selected;
     bvalue need_fire_missile;
     ivalue missile_bay_time;
@@ -75,6 +78,11 @@ struct plane: public object, public std::enable_shared_from_this<plane>
     std::vector<target_lock> targets;
     ivalue lock_timer;
 
+    //radar candidates, updated from the objects hash changes
+    spatial_hash_area<w_ptr<plane> > radar_planes;
+    spatial_hash_area<object_wptr> radar_units;
+    std::vector<const object *> radar_listed; //scratch
+
     w_ptr<game::missile> saam_missile;
 
     struct bomb_mark
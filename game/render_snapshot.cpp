@@ -0,0 +1,89 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "render_snapshot.h"
+#include "renderer/aircraft.h"
+
+namespace game
+{
+//------------------------------------------------------------
+
+void render_snapshot::apply(renderer::world &w, float k, unsigned int &last_tick) const
+{
+    nya_math::vec3 pos;
+    nya_math::quat rot;
+
+    for (auto &p: planes)
+    {
+        auto &r = p.render;
+        if (!r.is_valid())
+            continue;
+
+        r->set_hide(p.hide);
+        if (p.hide)
+            continue;
+
+        p.prev.lerp(p.pos, p.rot, k, pos, rot);
+        r->set_pos(pos);
+        r->set_rot(rot);
+
+        r->set_damage(p.damage);
+        r->set_speed(p.speed);
+        r->set_elev(p.elev_l, p.elev_r);
+        r->set_rudder(p.rudder_l, p.rudder_r, p.rudder);
+        r->set_aileron(p.aileron_l, p.aileron_r);
+        r->set_canard(p.canard);
+        r->set_brake(p.brake);
+        r->set_flaperon(p.flaperon);
+        r->set_wing_sweep(p.wing_sweep);
+        r->set_intake_ramp(p.intake_ramp);
+        r->set_thrust(p.thrust);
+        r->set_aoa(p.aoa);
+        r->set_missile_bay(p.missile_bay);
+        r->set_special_bay(p.special_bay);
+        r->set_mgun_bay(p.mgun_bay);
+        r->set_mgun_fire(p.mgun_fire);
+        r->set_mgp_fire(p.mgp_fire);
+    }
+
+    for (auto &m: missiles)
+    {
+        m.prev.lerp(m.pos, m.rot, k, pos, rot);
+        m.render->mdl.set_pos(pos);
+        m.render->mdl.set_rot(rot);
+        m.render->engine_started = m.engine_started;
+    }
+
+    for (auto &b: bombs)
+    {
+        b.render->mdl.set_pos(b.pos);
+        b.render->mdl.set_rot(b.rot);
+    }
+
+    for (auto &u: units)
+    {
+        if (!u.render.is_valid())
+            continue;
+
+        u.render->visible = u.visible;
+        u.render->mdl.set_pos(u.pos);
+        u.render->mdl.set_rot(u.rot);
+    }
+
+    auto &bullets_to = w.get_bullets();
+    bullets_to.clear();
+    for (auto &b: bullets)
+        bullets_to.add_bullet(b.pos, b.vel);
+
+    for (auto &e: explosions)
+    {
+        if (int(e.tick - last_tick) > 0)
+            w.spawn_explosion(e.pos, e.radius);
+    }
+
+    last_tick = tick;
+}
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,95 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "phys/physics.h"
+#include "renderer/world.h"
+#include <vector>
+
+namespace game
+{
+//------------------------------------------------------------
+
+struct tick_transform //phys state at the previous sim tick, for render interpolation
+{
+    nya_math::vec3 pos;
+    nya_math::quat rot;
+    bool valid = false;
+
+    void store(const phys::object &o) { pos = o.pos; rot = o.rot; valid = true; }
+
+    bool lerp(const nya_math::vec3 &to_pos, const nya_math::quat &to_rot, float k, nya_math::vec3 &result_pos, nya_math::quat &result_rot) const
+    {
+        const float max_dist = 200.0f; //teleported, e.g. respawn
+        if (!valid || (to_pos - pos).length_sq() > max_dist * max_dist)
+        {
+            result_pos = to_pos, result_rot = to_rot;
+            return false;
+        }
+
+        result_pos = pos + (to_pos - pos) * k;
+        result_rot = nya_math::quat::slerp(rot, to_rot, k);
+        return true;
+    }
+};
+
+//------------------------------------------------------------
+
+struct render_snapshot //everything the sim tick passes to the renderer
+{
+    struct plane
+    {
+        renderer::aircraft_ptr render;
+        tick_transform prev;
+        nya_math::vec3 pos;
+        nya_math::quat rot;
+        bool hide = true;
+
+        float damage = 0.0f, speed = 0.0f, aoa = 0.0f;
+        float elev_l = 0.0f, elev_r = 0.0f;
+        float rudder_l = 0.0f, rudder_r = 0.0f, rudder = 0.0f;
+        float aileron_l = 0.0f, aileron_r = 0.0f;
+        float canard = 0.0f, brake = 0.0f, flaperon = 0.0f, wing_sweep = 0.0f;
+        float intake_ramp = 0.0f, thrust = 0.0f;
+        bool missile_bay = false, special_bay = false, mgun_bay = false;
+        bool mgun_fire = false, mgp_fire = false;
+    };
+
+    struct missile
+    {
+        renderer::missile_ptr render;
+        tick_transform prev;
+        nya_math::vec3 pos;
+        nya_math::quat rot;
+        bool engine_started = false;
+    };
+
+    struct object
+    {
+        renderer::object_ptr render;
+        nya_math::vec3 pos;
+        nya_math::quat rot;
+        bool visible = true;
+    };
+
+    struct bullet { nya_math::vec3 pos, vel; };
+    struct explosion { nya_math::vec3 pos; float radius; unsigned int tick; };
+
+    unsigned int tick = 0;
+    std::vector<plane> planes;
+    std::vector<missile> missiles;
+    std::vector<object> bombs;
+    std::vector<object> units;
+    std::vector<bullet> bullets;
+    std::vector<explosion> explosions; //from the last few ticks, already spawned ones are skipped
+
+    enum { explosions_keep_ticks = 32 };
+
+    //k is the part of the next tick already passed, last_tick is the tick of the previously applied snapshot
+    void apply(renderer::world &w, float k, unsigned int &last_tick) const;
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,189 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "replay.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+namespace
+{
+    struct replay_header
+    {
+        char sign[4];
+        uint32_t version;
+        uint32_t ticks_count;
+        uint32_t hash;
+        uint32_t seed;
+        int32_t color;
+        int32_t bots_count;
+        uint32_t frames_count;
+    };
+
+    const uint32_t replay_version = 2;
+
+    enum
+    {
+        flag_missile = 1 << 0,
+        flag_mgun = 1 << 1,
+        flag_flares = 1 << 2,
+        flag_change_weapon = 1 << 3,
+        flag_change_target = 1 << 4,
+        flag_change_camera = 1 << 5,
+        flag_change_radar = 1 << 6,
+    };
+
+    void write_string(FILE *f, const std::string &s)
+    {
+        const uint32_t size = (uint32_t)s.size();
+        fwrite(&size, sizeof(size), 1, f);
+        fwrite(s.data(), 1, size, f);
+    }
+
+    bool read_string(FILE *f, std::string &s)
+    {
+        uint32_t size = 0;
+        if (fread(&size, sizeof(size), 1, f) != 1 || size > 4096)
+            return false;
+
+        s.resize(size);
+        return size == 0 || fread(&s[0], 1, size, f) == size;
+    }
+}
+
+//------------------------------------------------------------
+
+void replay::add_tick(int dt, const plane_controls &c)
+{
+    tick t;
+    t.dt = dt;
+    t.rot[0] = c.rot.x, t.rot[1] = c.rot.y, t.rot[2] = c.rot.z;
+    t.throttle = c.throttle;
+    t.brake = c.brake;
+    t.cam_rot[0] = c.cam_rot.x, t.cam_rot[1] = c.cam_rot.y;
+    t.flags = 0;
+    if (c.missile) t.flags |= flag_missile;
+    if (c.mgun) t.flags |= flag_mgun;
+    if (c.flares) t.flags |= flag_flares;
+    if (c.change_weapon) t.flags |= flag_change_weapon;
+    if (c.change_target) t.flags |= flag_change_target;
+    if (c.change_camera) t.flags |= flag_change_camera;
+    if (c.change_radar) t.flags |= flag_change_radar;
+    m_ticks.push_back(t);
+}
+
+//------------------------------------------------------------
+
+int replay::get_tick(size_t idx, plane_controls &c) const
+{
+    c = plane_controls();
+    if (idx >= m_ticks.size())
+        return 0;
+
+    const auto &t = m_ticks[idx];
+    c.rot.set(t.rot[0], t.rot[1], t.rot[2]);
+    c.throttle = t.throttle;
+    c.brake = t.brake;
+    c.cam_rot = nya_math::vec2(t.cam_rot[0], t.cam_rot[1]);
+    c.missile = (t.flags & flag_missile) != 0;
+    c.mgun = (t.flags & flag_mgun) != 0;
+    c.flares = (t.flags & flag_flares) != 0;
+    c.change_weapon = (t.flags & flag_change_weapon) != 0;
+    c.change_target = (t.flags & flag_change_target) != 0;
+    c.change_camera = (t.flags & flag_change_camera) != 0;
+    c.change_radar = (t.flags & flag_change_radar) != 0;
+    return t.dt;
+}
+
+//------------------------------------------------------------
+
+bool replay::save(const char *file_name) const
+{
+    if (!file_name)
+        return false;
+
+    FILE *f = fopen(file_name, "wb");
+    if (!f)
+    {
+        printf("unable to save replay %s\n", file_name);
+        return false;
+    }
+
+    replay_header h;
+    memcpy(h.sign, "OHRP", 4);
+    h.version = replay_version;
+    h.ticks_count = (uint32_t)m_ticks.size();
+    h.hash = m_hash;
+    h.seed = m_session.seed;
+    h.color = m_session.color;
+    h.bots_count = m_session.bots_count;
+    h.frames_count = (uint32_t)m_frames.size();
+    fwrite(&h, sizeof(h), 1, f);
+
+    write_string(f, m_session.mode);
+    write_string(f, m_session.plane);
+    write_string(f, m_session.location);
+    write_string(f, m_session.mission);
+
+    if (!m_ticks.empty())
+        fwrite(m_ticks.data(), sizeof(tick), m_ticks.size(), f);
+    if (!m_frames.empty())
+        fwrite(m_frames.data(), sizeof(frame), m_frames.size(), f);
+
+    fclose(f);
+    return true;
+}
+
+//------------------------------------------------------------
+
+bool replay::load(const char *file_name)
+{
+    if (!file_name)
+        return false;
+
+    FILE *f = fopen(file_name, "rb");
+    if (!f)
+    {
+        printf("unable to open replay %s\n", file_name);
+        return false;
+    }
+
+    replay_header h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.sign, "OHRP", 4) != 0 || h.version != replay_version)
+    {
+        printf("invalid replay %s\n", file_name);
+        fclose(f);
+        return false;
+    }
+
+    m_session = replay_session();
+    m_session.seed = h.seed;
+    m_session.color = h.color;
+    m_session.bots_count = h.bots_count;
+    m_hash = h.hash;
+
+    m_ticks.resize(h.ticks_count);
+    m_frames.resize(h.frames_count);
+    const bool result = read_string(f, m_session.mode) && read_string(f, m_session.plane) &&
+                        read_string(f, m_session.location) && read_string(f, m_session.mission) &&
+                        (m_ticks.empty() || fread(m_ticks.data(), sizeof(tick), m_ticks.size(), f) == m_ticks.size()) &&
+                        (m_frames.empty() || fread(m_frames.data(), sizeof(frame), m_frames.size(), f) == m_frames.size());
+    fclose(f);
+
+    if (!result)
+    {
+        printf("invalid replay %s\n", file_name);
+        m_ticks.clear();
+        m_frames.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,72 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "game.h"
+#include <stdint.h>
+
+namespace game
+{
+//------------------------------------------------------------
+
+struct replay_session
+{
+    std::string mode; //ms, ff, dm, tdm
+    std::string plane;
+    std::string location;
+    std::string mission;
+    int color = 0;
+    int bots_count = 0;
+    unsigned int seed = 0;
+};
+
+//------------------------------------------------------------
+
+//offline sessions only, the state hash is checked at the end of the playback
+//render updates are recorded too, the sim reads the renderer skeletons (mounts, bays)
+
+class replay
+{
+public:
+    void start(const replay_session &s) { m_session = s; m_ticks.clear(); m_frames.clear(); m_hash = 0; }
+    void add_tick(int dt, const plane_controls &c);
+    void add_frame(int dt, float k) { m_frames.push_back({uint32_t(m_ticks.size()), dt, k}); } //update_render after the last tick
+    void set_hash(uint32_t hash) { m_hash = hash; }
+
+    const replay_session &get_session() const { return m_session; }
+    size_t get_ticks_count() const { return m_ticks.size(); }
+    int get_tick(size_t idx, plane_controls &c) const; //returns dt
+
+    struct frame
+    {
+        uint32_t ticks; //ticks done before it
+        int32_t dt;
+        float k;
+    };
+
+    const std::vector<frame> &get_frames() const { return m_frames; }
+    uint32_t get_hash() const { return m_hash; }
+
+    bool save(const char *file_name) const;
+    bool load(const char *file_name);
+
+private:
+    struct tick
+    {
+        int dt;
+        float rot[3];
+        float throttle, brake;
+        float cam_rot[2];
+        uint32_t flags;
+    };
+
+    replay_session m_session;
+    std::vector<tick> m_ticks;
+    std::vector<frame> m_frames;
+    uint32_t m_hash = 0;
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,98 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "math/vector.h"
+#include <vector>
+#include <algorithm>
+
+namespace game
+{
+//------------------------------------------------------------
+
+enum sim_lod_tier
+{
+    sim_lod_full,
+    sim_lod_coarse, //reduced tick rate, no terrain sampling, no target search
+    sim_lod_dormant,
+    sim_lod_tiers_count
+};
+
+//------------------------------------------------------------
+
+class sim_lod
+{
+public:
+    struct params
+    {
+        float coarse_dist = 8000.0f; //from the nearest observer
+        float dormant_dist = 20000.0f;
+        float hysteresis = 1000.0f; //promote this much closer than demote
+        int coarse_interval = 100; //ms between updates
+        int dormant_interval = 500;
+    };
+
+    void set_params(const params &p) { m_params = p; }
+    const params &get_params() const { return m_params; }
+
+    //human players, everything is full lod without observers
+    void clear_observers() { m_observers.clear(); }
+    void add_observer(const nya_math::vec3 &pos) { m_observers.push_back(pos); }
+
+    sim_lod_tier get_tier(const nya_math::vec3 &pos, sim_lod_tier prev = sim_lod_full) const
+    {
+        if (m_observers.empty())
+            return sim_lod_full;
+
+        float dist_sq = -1.0f;
+        for (auto &o: m_observers)
+        {
+            const float d = (o - pos).length_sq();
+            if (dist_sq < 0.0f || d < dist_sq)
+                dist_sq = d;
+        }
+
+        auto get = [this, dist_sq](float margin)
+        {
+            const float coarse = std::max(m_params.coarse_dist - margin, 0.0f);
+            const float dormant = std::max(m_params.dormant_dist - margin, 0.0f);
+            if (dist_sq < coarse * coarse)
+                return sim_lod_full;
+
+            return dist_sq < dormant * dormant ? sim_lod_coarse : sim_lod_dormant;
+        };
+
+        const sim_lod_tier tier = get(0.0f);
+        if (tier >= prev)
+            return tier;
+
+        return std::min(prev, get(m_params.hysteresis));
+    }
+
+    int get_interval(sim_lod_tier tier) const
+    {
+        switch (tier)
+        {
+            case sim_lod_coarse: return m_params.coarse_interval;
+            case sim_lod_dormant: return m_params.dormant_interval;
+            default: return 0;
+        }
+    }
+
+public:
+    struct stats { int count[sim_lod_tiers_count] = {}; };
+
+    void reset_stats() { m_stats = stats(); }
+    void count(sim_lod_tier tier) { ++m_stats.count[tier]; }
+    const stats &get_stats() const { return m_stats; }
+
+private:
+    params m_params;
+    std::vector<nya_math::vec3> m_observers;
+    stats m_stats;
+};
+
+//------------------------------------------------------------
+}
@@ -5,13 +5,13 @@
 #include "team_deathmatch.h"
 #include "world.h"
 #include "util/xml.h"
+#include "util/config.h"
 
 namespace game
 {
 //------------------------------------------------------------
 
-inline int get_team(std::string t) { return t == "red" ? 1 : 0; }
-inline std::string get_team(int t) { return t == 1 ? "red" : "blue"; }
+inline int get_team(const plane_ptr &p) { return p && p->net_game_data.get_int(game_data::key_team) == 1 ? 1 : 0; }
 
 //------------------------------------------------------------
 
@@ -41,16 +41,20 @@ void team_deathmatch::start(const char *plane, int color, int special, const cha
     const auto planes = get_aircraft_ids({"fighter", "multirole"});
     assert(!planes.empty());
 
-    m_planes.push_back(m_world.add_plane(plane, m_world.get_player_name(), color, true));
+    if (plane) //no player on dedicated servers
+        m_planes.push_back(m_world.add_plane(plane, m_world.get_player_name(), color, true));
 
     m_bots.clear();
+    m_ai_scheduler.reset();
+    m_ai_scheduler.set_budget(m_world.is_deterministic() ? 0 : config::get_var_int("ai_budget"));
+    m_ai_scheduler.set_workers(config::get_var_int("ai_workers"));
 
     for (int i = 0; i < bots_count; ++i)
     {
         plane_ptr p;
         ai b;
 
-        const char *plane_name = planes[rand() % planes.size()].c_str(); //ToDo
+        const char *plane_name = planes[m_world.get_random().get(uint32_t(planes.size()))].c_str(); //ToDo
         p = m_world.add_plane(plane_name, "BOT", 0, false);
 
         b.set_plane(p);
@@ -62,9 +66,9 @@ void team_deathmatch::start(const char *plane, int color, int special, const cha
     int last_team = 0;
     for (auto &p: m_planes)
     {
-        p->net_game_data.set("team", get_team(last_team));
+        p->net_game_data.set(game_data::key_team, last_team);
         last_team = !last_team;
-        auto rp = get_respawn_point(p->net_game_data.get<std::string>("team"));
+        auto rp = get_respawn_point(get_team(p));
         p->set_pos(rp.first);
         p->set_rot(rp.second);
     }
@@ -93,7 +97,7 @@ void team_deathmatch::update(int dt, const plane_controls &player_controls)
 
 void team_deathmatch::respawn(plane_ptr p)
 {
-    auto rp = get_respawn_point(p->net_game_data.get<std::string>("team"));
+    auto rp = get_respawn_point(get_team(p));
     m_world.respawn(p, rp.first, rp.second);
 }
 
@@ -114,7 +118,7 @@ void team_deathmatch::rebalance()
     for (int i = 0; i < m_world.get_planes_count(); ++i)
     {
         auto p = m_world.get_plane(i);
-        ++count[get_team(p->net_game_data.get<std::string>("team"))];
+        ++count[get_team(p)];
     }
 
     while (abs(count[1] - count[0]) > 1)
@@ -124,11 +128,11 @@ void team_deathmatch::rebalance()
         for (int i = m_world.get_planes_count() - 1; i >= 0; --i)
         {
             auto p = m_world.get_plane(i);
-            if (get_team(p->net_game_data.get<std::string>("team")) == dec_team)
+            if (get_team(p) == dec_team)
             {
                 --count[dec_team];
                 ++count[inc_team];
-                p->net_game_data.set("team", get_team(inc_team));
+                p->net_game_data.set(game_data::key_team, inc_team);
                 respawn(p);
                 break;
             }
@@ -138,10 +142,8 @@ void team_deathmatch::rebalance()
 
 //------------------------------------------------------------
 
-team_deathmatch::respawn_point team_deathmatch::get_respawn_point(std::string team)
+team_deathmatch::respawn_point team_deathmatch::get_respawn_point(int t)
 {
-    const int t = get_team(team);
-
     if (m_respawn_points[t].empty())
         return respawn_point();
 
@@ -152,7 +154,7 @@ team_deathmatch::respawn_point team_deathmatch::get_respawn_point(std::string te
 
 bool team_deathmatch::is_ally(const plane_ptr &a, const plane_ptr &b)
 {
-    return a->net_game_data.get<std::string>("team") == b->net_game_data.get<std::string>("team");
+    return get_team(a) == get_team(b);
 }
 
 //------------------------------------------------------------
@@ -166,10 +168,10 @@ void team_deathmatch::update_scores()
     for (int i = 0; i < m_world.get_planes_count(); ++i)
     {
         auto p = m_world.get_plane(i);
-        m_score[get_team(p->net_game_data.get<std::string>("team"))] += p->net_game_data.get<int>("score");
+        m_score[get_team(p)] += p->net_game_data.get_int(game_data::key_score);
     }
 
-    if (get_team(m_world.get_player()->net_game_data.get<std::string>("team")) == 1)
+    if (get_team(m_world.get_player()) == 1)
         std::swap(m_score[0], m_score[1]);
 
     m_world.get_hud().set_team_score(m_score[0], m_score[1]);
@@ -187,10 +189,10 @@ void team_deathmatch::on_kill(const object_ptr &k, const object_ptr &v)
     if (kp)
     {
         if (!is_ally(kp, vp))
-            kp->net_game_data.set("score", kp->net_game_data.get<int>("score") + 1);
+            kp->net_game_data.set(game_data::key_score, kp->net_game_data.get_int(game_data::key_score) + 1);
     }
     else
-        vp->net_game_data.set("score", vp->net_game_data.get<int>("score") - 1);
+        vp->net_game_data.set(game_data::key_score, vp->net_game_data.get_int(game_data::key_score) - 1);
 }
 
 //------------------------------------------------------------
@@ -26,7 +26,7 @@ protected:
     virtual void update_scores() override;
     void rebalance();
 
-    respawn_point get_respawn_point(std::string team);
+    respawn_point get_respawn_point(int team);
 
     std::vector<respawn_point> m_respawn_points[2];
     ivalue m_last_respawn[2];
@@ -35,10 +35,10 @@ bool unit::is_ally(const unit_ptr &u) const
 void unit::take_damage(int damage, world &w, bool net_src)
 {
     object::take_damage(damage, w, net_src);
-    if (hp <= 0 && m_render.is_valid() && m_render->visible)
+    if (hp <= 0 && m_active && !m_destroyed)
     {
         w.spawn_explosion(get_pos(), 30.0f);
-        m_render->visible = false;
+        m_destroyed = true;
     }
 }
 
@@ -110,44 +110,46 @@ void unit_vehicle::update(int dt, world &w)
 
     if (m_target.expired())
     {
-        if (m_ai > ai_default && m_target_search != search_none)
+        m_target_search_time -= dt;
+        if (m_ai > ai_default && m_target_search != search_none && m_target_search_time <= 0)
         {
+            m_target_search_time = target_search_interval;
+
             const bool air = m_ai == ai_air_to_air || m_ai == ai_air_multirole,
             ground = m_ai == ai_air_to_ground || m_ai == ai_air_multirole;
 
             float min_dist = 10000.0f;
-            for (int i = 0; i < w.get_planes_count() + w.get_units_count(); ++i)
-            {
-                object_ptr t;
-                if (i < w.get_planes_count())
-                {
-                    auto p = w.get_plane(i);
-                    if (is_ally(p, w))
-                        continue;
-
-                    t = p;
-                }
-                else
-                {
-                    if (m_target_search == search_player)
-                        continue;
-
-                    auto u = w.get_unit(i - w.get_planes_count());
-                    if (is_ally(u))
-                        continue;
-
-                    t = u;
-                }
 
+            auto check_target = [&](const object_ptr &t)
+            {
                 if (!t->is_targetable(air, ground))
-                    continue;
+                    return;
 
                 const float dist = (t->get_pos() - get_pos()).length();
                 if(dist >= min_dist)
-                    continue;
+                    return;
 
                 m_target = t;
                 min_dist = dist;
+            };
+
+            std::vector<plane_ptr> planes;
+            w.find_planes(get_pos(), min_dist, planes);
+            for (auto &p: planes)
+            {
+                if (!is_ally(p, w))
+                    check_target(p);
+            }
+
+            if (m_target_search != search_player)
+            {
+                std::vector<unit_ptr> units;
+                w.find_units(get_pos(), min_dist, units);
+                for (auto &u: units)
+                {
+                    if (!is_ally(u))
+                        check_target(u);
+                }
             }
         }
     }
@@ -247,7 +249,7 @@ void unit_vehicle::update(int dt, world &w)
         if (fabsf(angle_diff) > 0.001f)
         {
             const float turn_k = nya_math::clamp((180.0f / angle_diff) * m_params.turn_speed * kdt, 0.0, 1.0);
-            m_render->mdl.set_rot(quat::slerp(rot, ideal_rot, turn_k));
+            m_rot = quat::slerp(rot, ideal_rot, turn_k);
         }
 
         float speed = m_vel.length();
@@ -284,8 +286,81 @@ void unit_vehicle::update(int dt, world &w)
 
 //------------------------------------------------------------
 
-unit_vehicle::unit_vehicle(const object_params &p, const location_params &lp): m_params(p)
+void unit_vehicle::update_coarse(int dt, world &w)
 {
+    if (hp <= 0)
+        return;
+
+    if (m_first_update)
+    {
+        update(dt, w);
+        return;
+    }
+
+    //analytic advance along the path or formation, keeps height, no targets
+
+    const float kdt = dt * 0.001f;
+    vec3 pos = get_pos();
+
+    if (!m_path.empty())
+    {
+        float speed = m_vel.length();
+        if (speed < m_params.speed_min || speed < 0.01f)
+            speed = std::min(m_params.speed_cruise, m_speed_limit);
+
+        float dist = speed * kdt;
+        const vec3 from = pos;
+        for (size_t i = 0, max_steps = m_path.size() + 1; dist > 0.0f && i < max_steps; ++i)
+        {
+            const vec3 to = m_path.front() - pos;
+            const float len = to.length();
+            if (len > dist)
+            {
+                pos += to * (dist / len);
+                break;
+            }
+
+            pos = m_path.front();
+            dist -= len;
+            if (m_path_loop)
+                m_path.push_back(m_path.front());
+            m_path.pop_front();
+            if (m_path.empty())
+                break;
+        }
+
+        if (m_ground)
+            pos.y = from.y;
+
+        vec3 dir = pos - from;
+        dir.y = 0.0f;
+        if (dir.length_sq() > 0.01f)
+        {
+            dir.normalize();
+            m_rot = quat(0.0f, atan2(dir.x, dir.z), 0.0f);
+        }
+
+        m_vel = get_rot().rotate(vec3(0.0, 0.0, speed));
+    }
+    else if (!m_follow.expired())
+    {
+        auto f = m_follow.lock();
+        pos = f->get_pos() + f->get_rot().rotate(m_formation_offset);
+        m_rot = f->get_rot();
+        m_vel = f->get_vel();
+    }
+    else
+        pos += m_vel * kdt;
+
+    set_pos(pos);
+}
+
+//------------------------------------------------------------
+
+unit_vehicle::unit_vehicle(const object_params &p, const location_params &lp, uint32_t seed): m_params(p)
+{
+    m_target_search_time = int(seed % target_search_interval);
+
     if (p.ai == "air_to_air")
         m_ai = ai_air_to_air;
     else if (p.ai == "air_to_ground")
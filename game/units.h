@@ -6,6 +6,8 @@
 
 #include "game.h"
 #include "objects.h"
+#include "sim_lod.h"
+#include "render_snapshot.h"
 
 namespace game
 {
@@ -17,7 +19,7 @@ typedef ptr<unit> unit_ptr;
 
 struct unit: public object
 {
-    virtual void set_active(bool a) { m_active = a; if (m_render.is_valid()) m_render->visible = a; }
+    virtual void set_active(bool a) { m_active = a; }
 
     typedef std::list<vec3> path;
     virtual void set_path(const path &p, bool loop) {}
@@ -31,8 +33,8 @@ struct unit: public object
     virtual void set_align(align a) { m_align = a; }
     virtual void set_type_name(std::wstring name) { m_type_name = name; }
 
-    virtual void set_pos(const vec3 &p) { if (m_render.is_valid()) m_render->mdl.set_pos(p + m_dpos); }
-    virtual void set_yaw(angle_deg yaw) { if (m_render.is_valid()) m_render->mdl.set_rot(quat(0.0f, yaw, 0.0f)); }
+    virtual void set_pos(const vec3 &p) { m_pos = p; }
+    virtual void set_yaw(angle_deg yaw) { m_rot = quat(0.0f, yaw, 0.0f); }
 
     virtual void set_speed(float speed) {}
     virtual void set_speed_limit(float speed) {}
@@ -44,8 +46,8 @@ struct unit: public object
 
     //object
 public:
-    virtual vec3 get_pos() override { return m_render.is_valid() ? m_render->mdl.get_pos() - m_dpos : vec3(); }
-    virtual quat get_rot() override { return m_render.is_valid() ? m_render->mdl.get_rot() : quat(); }
+    virtual vec3 get_pos() override { return m_pos; }
+    virtual quat get_rot() override { return m_rot; }
     virtual std::wstring get_type_name() { return m_type_name; }
     virtual bool get_tgt() { return m_align == align_target; }
     virtual bool is_ally(const plane_ptr &p, world &w) override { return m_align > align_enemy; }
@@ -56,15 +58,47 @@ public:
     {
         m_render = w.add_object(model.c_str());
         m_dpos.y = dy;
+    }
 
-        if (m_render.is_valid())
-            m_render->visible = m_active;
+    void write_render_state(render_snapshot::object &s) const
+    {
+        s.render = m_render;
+        s.pos = m_pos + m_dpos;
+        s.rot = m_rot;
+        s.visible = m_active && !m_destroyed;
     }
 
     virtual void update(int dt, world &w) {}
+    virtual void update_coarse(int dt, world &w) { update(dt, w); } //far from players, see sim_lod
+
+    void update_lod(int dt, sim_lod_tier tier, int interval, world &w)
+    {
+        m_sim_lod = tier;
+        if (tier == sim_lod_full)
+        {
+            if (m_sim_lod_time > 0)
+                update_coarse(m_sim_lod_time, w), m_sim_lod_time = 0;
+            update(dt, w);
+            return;
+        }
+
+        m_sim_lod_time += dt;
+        if (m_sim_lod_time < interval)
+            return;
+
+        update_coarse(m_sim_lod_time, w);
+        m_sim_lod_time = 0;
+    }
+
+    sim_lod_tier get_sim_lod() const { return m_sim_lod; }
 
 protected:
     bool m_active = true;
+    bool m_destroyed = false;
+    vec3 m_pos;
+    quat m_rot;
+    sim_lod_tier m_sim_lod = sim_lod_full;
+    int m_sim_lod_time = 0;
     renderer::object_ptr m_render;
     vec3 m_dpos;
     align m_align;
@@ -83,7 +117,8 @@ public:
     virtual void set_speed(float speed) override;
     virtual void set_speed_limit(float speed) override;
     virtual void update(int dt, world &w) override;
-    unit_vehicle(const object_params &p, const location_params &lp);
+    virtual void update_coarse(int dt, world &w) override;
+    unit_vehicle(const object_params &p, const location_params &lp, uint32_t seed);
 
     //object
 public:
@@ -97,6 +132,8 @@ protected:
     bool m_ground = true;
     object_wptr m_target;
     target_search_mode m_target_search = search_all;
+    int m_target_search_time = 0; //spread searches across ticks
+    static const int target_search_interval = 250;
     object_wptr m_follow;
     bool m_first_update = true;
     vec3 m_vel;
@@ -6,6 +6,8 @@
 #include "network_helpers.h"
 #include "weapon_information.h"
 #include "util/config.h"
+#include "util/arms_params.h"
+#include "util/profiler.h"
 #include <algorithm>
 #include <time.h>
 
@@ -22,11 +24,9 @@ missile_ptr world::add_missile(const char *id, const renderer::model &mdl, bool
     m->phys = m_phys_world.add_missile(id, add_to_phys_world);
     m->render = m_render_world.add_missile(mdl);
 
-    auto &param = get_arms_param();
-
-    const std::string pref = "." + std::string(id) + ".action.";
-    m->time = param.get_float(pref + "endTime") * 1000;
-    m->homing_angle_cos = cosf(param.get_float(pref + "hormingAng"));
+    auto &param = params::arms_params::get(id);
+    m->time = param.end_time;
+    m->homing_angle_cos = cosf(param.homing_angle);
     m->dmg_radius = missile_dmg_radius;
     m->dmg = missile_damage;
 
@@ -38,6 +38,7 @@ missile_ptr world::add_missile(const char *id, const renderer::model &mdl, bool
         m->mode = missile::mode_lagm, m->dmg_radius *= 1.5, m->dmg *= 1.5;
 
     m_missiles.push_back(m);
+    m_registry.add(m);
     return m;
 }
 
@@ -101,6 +102,7 @@ bomb_ptr world::add_bomb(const char *id, const renderer::model &m)
     b->dmg = missile_damage * 2.0f;
 
     m_bombs.push_back(b);
+    m_registry.add(b);
 
     return b;
 }
@@ -169,7 +171,8 @@ plane_ptr world::add_plane(const char *preset, const char *player_name, int colo
     }
 
     m_planes.push_back(p);
-    get_arms_param(); //cache
+    m_registry.add(p);
+    params::arms_params::get(preset); //cache
     return p;
 }
 
@@ -180,62 +183,84 @@ unit_ptr world::add_unit(const char *id)
     if (!id)
         return unit_ptr();
 
-    auto &objs = get_objects_list();
-    for (auto &o: objs)
-    {
-        if (o.id != id)
-            continue;
-
-        m_units.resize(m_units.size() + 1);
-        auto &u = m_units.back();
-
-        if (o.params.speed_max > 0.01f)
-            u = std::make_shared<unit_vehicle>(unit_vehicle(o.params, m_render_world.get_location_params()));
-        else if (o.params.hp > 0)
-            u = std::make_shared<unit_object>(unit_object());
-        else
-            u = std::make_shared<unit>(unit());
+    auto o = get_object_desc(id);
+    if (!o)
+        return unit_ptr();
 
-        u->load_model(o.model, o.dy, m_render_world);
-        u->set_type_name(o.name);
-        u->hp = o.params.hp;
+    unit_ptr u;
+    if (o->params.speed_max > 0.01f)
+        u = std::make_shared<unit_vehicle>(unit_vehicle(o->params, m_render_world.get_location_params(), m_random.next()));
+    else if (o->params.hp > 0)
+        u = std::make_shared<unit_object>(unit_object());
+    else
+        u = std::make_shared<unit>(unit());
 
-        return u;
-    }
+    u->load_model(o->model, o->dy, m_render_world);
+    u->set_type_name(o->name);
+    u->hp = o->params.hp;
 
-    return unit_ptr();
+    m_units.push_back(u);
+    m_registry.add(u);
+    return u;
 }
 
 //------------------------------------------------------------
 
 void world::spawn_explosion(const nya_math::vec3 &pos, float radius, bool net_src)
 {
-    m_render_world.spawn_explosion(pos, radius);
+    render_snapshot::explosion e;
+    e.pos = pos;
+    e.radius = radius;
+    e.tick = m_tick;
+    m_explosions.push_back(e);
 
     play_sound("MISL_HIT", random(2, 4), pos);
 
-    if (m_network && net_src)
-        m_network->general_msg("explosion " + to_string(pos) + " " + std::to_string(radius));
+    if (net_src)
+    {
+        event_explosion ev;
+        ev.pos = pos;
+        ev.radius = radius;
+        send_event(ev);
+    }
 }
 
 //------------------------------------------------------------
 
+static const float lag_compensation_margin = 200.0f; //movement during the max rewind
+
+//------------------------------------------------------------
+
 void world::spawn_bullet(const char *type, const vec3 &pos, const vec3 &dir, const plane_ptr &owner)
 {
     vec3 r;
     const bool hit_world = m_phys_world.spawn_bullet(type, pos, dir, r);
 
-    if (!owner->net || owner->net->source)
+    const bool remote_owner = owner->net && !owner->net->source;
+    if (!remote_owner || is_host())
     {
-        for (int i = 0; i < get_objects_count(); ++i)
+        std::vector<object_ptr> targets;
+        find_objects(pos, r, remote_owner ? lag_compensation_margin : 0.0f, targets);
+        for (auto &t: targets)
         {
-            auto t = get_object(i);
             if (t->hp <= 0 || t->is_ally(owner, *this))
                 continue;
 
+            vec3 tpos;
+            const hit_check check = get_hit_check(owner, t, tpos);
+            if (check == hit_skip)
+                continue;
+
             const float spread_coeff = 2.0f;
-            if (line_sphere_intersect(pos, r, t->get_pos(), t->get_hit_radius() * spread_coeff))
+            if (line_sphere_intersect(pos, r, tpos, t->get_hit_radius() * spread_coeff))
             {
+                if (check == hit_predict)
+                {
+                    if (owner == get_player())
+                        popup_hit(false);
+                    continue;
+                }
+
                 t->take_damage(60, *this);
                 const bool destroyed = t->hp <= 0;
 
@@ -256,18 +281,28 @@ void world::spawn_bullet(const char *type, const vec3 &pos, const vec3 &dir, con
 
 //------------------------------------------------------------
 
-bool world::area_damage(const vec3 &pos, float radius, int damage, const plane_ptr &owner)
+bool world::area_damage(const vec3 &pos, float radius, int damage, const plane_ptr &owner, bool synced)
 {
     bool hit = false;
 
-    for (int i = 0; i < get_objects_count(); ++i)
+    const bool remote_owner = synced && owner && owner->net && !owner->net->source;
+    std::vector<object_ptr> objects;
+    find_objects(pos, radius + (remote_owner ? lag_compensation_margin : 0.0f), objects);
+    for (auto &o: objects)
     {
-        auto o = get_object(i);
-        if (!o || o->hp <= 0 || o->is_ally(owner, *this) || (o->get_pos() - pos).length() > radius)
+        if (o->hp <= 0 || o->is_ally(owner, *this))
+            continue;
+
+        vec3 opos = o->get_pos();
+        const hit_check check = synced ? get_hit_check(owner, o, opos) : hit_apply;
+        if (check == hit_skip || (opos - pos).length() > radius)
             continue;
 
-        o->take_damage(damage, *this);
         hit = true;
+        if (check == hit_predict)
+            continue;
+
+        o->take_damage(damage, *this);
 
         if (o->hp <= 0)
             on_kill(owner, o);
@@ -278,6 +313,27 @@ bool world::area_damage(const vec3 &pos, float radius, int damage, const plane_p
 
 //------------------------------------------------------------
 
+world::hit_check world::get_hit_check(const plane_ptr &owner, const object_ptr &target, vec3 &target_pos)
+{
+    target_pos = target->get_pos();
+    if (!m_network)
+        return hit_apply;
+
+    const bool remote_owner = owner && owner->net && !owner->net->source;
+    if (!get_plane(target))
+        return remote_owner ? hit_skip : hit_apply;
+
+    if (!is_host())
+        return remote_owner ? hit_skip : hit_predict;
+
+    if (remote_owner)
+        m_lag_compensation.get_pos(target.get(), m_network->get_view_time(owner->net), target_pos);
+
+    return hit_apply;
+}
+
+//------------------------------------------------------------
+
 void world::respawn(const plane_ptr &p, const vec3 &pos, const quat &rot)
 {
     if (!p)
@@ -286,18 +342,24 @@ void world::respawn(const plane_ptr &p, const vec3 &pos, const quat &rot)
     p->set_pos(pos);
     p->set_rot(rot);
     p->reset_state();
+    m_planes_hash.update(p.get(), p, pos);
 
     if (is_host() && m_network)
-        m_network->general_msg("respawn " + std::to_string(m_network->get_plane_id(p->net)) + " " + to_string(pos) + " " + to_string(rot));
+    {
+        event_plane_respawn e;
+        e.plane_id = m_network->get_plane_id(p->net);
+        e.pos = pos;
+        e.rot = rot;
+        send_event(e);
+    }
 }
 
 //------------------------------------------------------------
 
 const char *world::get_player_name() const
 {
-    static std::string tmp;
-    tmp = config::get_var("name");
-    return tmp.c_str();
+    m_player_name = config::get_var("name");
+    return m_player_name.c_str();
 }
 
 //------------------------------------------------------------
@@ -317,14 +379,7 @@ plane_ptr world::get_plane(object_wptr o)
     if (o.expired())
         return plane_ptr();
 
-    auto ol = o.lock();
-    for (auto &p: m_planes)
-    {
-        if (p == ol)
-            return p;
-    }
-
-    return plane_ptr();
+    return m_registry.get_plane(o.lock().get());
 }
 
 //------------------------------------------------------------
@@ -374,6 +429,139 @@ object_ptr world::get_object(int idx)
 
 //------------------------------------------------------------
 
+static const float objects_hash_margin = 100.0f; //hit radius and movement during the tick
+
+//------------------------------------------------------------
+
+void world::update_objects_hash()
+{
+    m_planes_hash.begin_update();
+    for (auto &p: m_planes)
+        m_planes_hash.update(p.get(), p, p->get_pos());
+    m_planes_hash.end_update();
+
+    m_units_hash.begin_update();
+    for (auto &u: m_units)
+        m_units_hash.update(u.get(), u, u->get_pos());
+    m_units_hash.end_update();
+}
+
+//------------------------------------------------------------
+
+void world::update_lag_compensation()
+{
+    if (!m_network || !is_host())
+        return;
+
+    m_lag_compensation.begin_update(m_network->get_time());
+    for (auto &p: m_planes)
+    {
+        const object *key = p.get();
+        m_lag_compensation.update(key, p->get_pos());
+    }
+    m_lag_compensation.end_update();
+}
+
+//------------------------------------------------------------
+
+void world::update_units(int dt)
+{
+    profile_scope("units");
+
+    m_sim_lod.clear_observers();
+    for (auto &p: m_planes)
+    {
+        //local player and remote controlled planes
+        if (p->hp > 0 && (p == m_player.lock() || (p->net && !p->net->source)))
+            m_sim_lod.add_observer(p->get_pos());
+    }
+
+    m_sim_lod.reset_stats();
+    for (auto &u: m_units)
+    {
+        if (!u->is_active())
+            continue;
+
+        const auto tier = m_sim_lod.get_tier(u->get_pos(), u->get_sim_lod());
+        m_sim_lod.count(tier);
+        u->update_lod(dt, tier, m_sim_lod.get_interval(tier), *this);
+    }
+}
+
+//------------------------------------------------------------
+
+void world::find_planes(const vec3 &pos, float radius, std::vector<plane_ptr> &result) const
+{
+    std::vector<w_ptr<plane> > found;
+    m_planes_hash.get_objects(pos, radius + objects_hash_margin, found);
+
+    result.clear();
+    for (auto &f: found)
+    {
+        auto p = f.lock();
+        if (p)
+            result.push_back(p);
+    }
+}
+
+//------------------------------------------------------------
+
+void world::find_units(const vec3 &pos, float radius, std::vector<unit_ptr> &result) const
+{
+    std::vector<unit_wptr> found;
+    m_units_hash.get_objects(pos, radius + objects_hash_margin, found);
+
+    result.clear();
+    for (auto &f: found)
+    {
+        auto u = f.lock();
+        if (u)
+            result.push_back(u);
+    }
+}
+
+//------------------------------------------------------------
+
+void world::find_objects(const vec3 &pos, float radius, std::vector<object_ptr> &result) const
+{
+    find_objects(pos, pos, radius, result);
+}
+
+//------------------------------------------------------------
+
+void world::find_objects(const vec3 &from, const vec3 &to, float radius, std::vector<object_ptr> &result) const
+{
+    std::vector<w_ptr<plane> > planes;
+    std::vector<unit_wptr> units;
+    m_planes_hash.get_objects(from, to, radius + objects_hash_margin, planes);
+    m_units_hash.get_objects(from, to, radius + objects_hash_margin, units);
+
+    result.clear();
+    for (auto &f: planes)
+    {
+        auto p = f.lock();
+        if (p)
+            result.push_back(p);
+    }
+
+    for (auto &f: units)
+    {
+        auto u = f.lock();
+        if (u)
+            result.push_back(u);
+    }
+}
+
+//------------------------------------------------------------
+
+void world::track_objects(const vec3 &pos, float radius, spatial_hash_area<w_ptr<plane> > &planes, spatial_hash_area<object_wptr> &units) const
+{
+    m_planes_hash.track(pos, radius + objects_hash_margin, planes);
+    m_units_hash.track(pos, radius + objects_hash_margin, units);
+}
+
+//------------------------------------------------------------
+
 void world::update_difficulty()
 {
     auto selected = config::get_var("difficulty");
@@ -397,10 +585,28 @@ void world::set_location(const char *name)
 {
     update_difficulty();
 
+    m_events.clear();
+    m_text_events = config::get_var_bool("net_text_events");
+
+    sim_lod::params lod;
+    lod.coarse_dist = (float)config::get_var_int("sim_lod_coarse_dist");
+    lod.dormant_dist = (float)config::get_var_int("sim_lod_dormant_dist");
+    lod.coarse_interval = config::get_var_int("sim_lod_coarse_interval");
+    lod.dormant_interval = config::get_var_int("sim_lod_dormant_interval");
+    m_sim_lod.set_params(lod);
+
+    m_render_snapshot = render_snapshot();
+    m_explosions.clear();
+    m_planes_hash.clear();
+    m_units_hash.clear();
+
     m_render_world.set_location(name);
     m_phys_world.set_location(name);
     m_hud.set_location(name);
 
+    if (m_network)
+        m_network->set_location_size(m_phys_world.get_location_half_size());
+
     if (m_sounds.cues.empty())
         m_sounds.load("sound/game.acb");
 
@@ -413,12 +619,50 @@ void world::set_location(const char *name)
 
 //------------------------------------------------------------
 
+namespace
+{
+template<typename t, typename f> bool remove_objects(std::vector<t> &objects, object_registry &registry, f should_remove)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        if (should_remove(objects[i]))
+        {
+            registry.remove(objects[i]);
+            continue;
+        }
+
+        if (count != i)
+            objects[count] = std::move(objects[i]);
+        ++count;
+    }
+
+    if (count == objects.size())
+        return false;
+
+    objects.resize(count);
+    return true;
+}
+}
+
+//------------------------------------------------------------
+
 void world::update(int dt)
 {
+    profile_scope("world update");
+
     m_net_data_updated = false;
+    ++m_tick;
+
+    for (auto &p: m_planes)
+        p->last_tick.store(*p->phys);
+    for (auto &m: m_missiles)
+        m->last_tick.store(*m->phys);
 
     if (m_network)
     {
+        profile_scope("net receive");
+
         m_network->update();
 
         network_interface::msg_add_plane mp;
@@ -428,115 +672,33 @@ void world::update(int dt)
         network_interface::msg_add_missile mm;
         while (m_network->get_add_missile_msg(mm))
         {
-            auto net = m_network->get_plane(mm.plane_id);
-            if (!net)
+            auto p = get_net_plane(mm.plane_id);
+            if (!p)
                 continue;
 
-            for (auto &p: m_planes)
-            {
-                if(p->net != net)
-                    continue;
-
-                p->special_weapon_selected = mm.special;
-                add_missile(p, m_network->add_missile(mm));
-                break;
-            }
+            p->special_weapon_selected = mm.special;
+            add_missile(p, m_network->add_missile(mm));
         }
 
         network_interface::msg_game_data md;
         while (m_network->get_game_data_msg(md))
         {
-            auto net = m_network->get_plane(md.plane_id);
-            if (!net)
+            auto p = get_net_plane(md.plane_id);
+            if (!p)
                 continue;
 
-            for (auto &p: m_planes)
-            {
-                if(p->net != net)
-                    continue;
-
-                p->net_game_data = md.data;
-                break;
-            }
-
+            p->net_game_data.merge(md.data);
             m_net_data_updated = true;
         }
 
-        std::string str;
-        while(m_network->get_general_msg(str))
-        {
-            std::istringstream is(str);
-            std::string cmd;
-            is >> cmd;
-
-            if (cmd == "explosion")
-            {
-                vec3 pos; float r;
-                read(is, pos), is >> r;
-                spawn_explosion(pos, r, false);
-            }
-
-            if (is_host())
-            {
-                if (cmd == "plane_take_damage")
-                {
-                    unsigned int plane_id; int damage;
-                    is >> plane_id, is >> damage;
-
-                    auto net = m_network->get_plane(plane_id);
-                    if (!net)
-                        continue;
-
-                    for (auto &p: m_planes)
-                    {
-                        if(p->net != net)
-                            continue;
-
-                        p->take_damage(damage, *this, false);
-                        break;
-                    }
-                }
-            }
-            else
-            {
-                if (cmd == "respawn")
-                {
-                    unsigned int plane_id; vec3 pos; quat rot;
-                    is >> plane_id, read(is, pos), read(is, rot);
-
-                    auto net = m_network->get_plane(plane_id);
-                    if (!net)
-                        continue;
-
-                    for (auto &p: m_planes)
-                    {
-                        if(p->net != net)
-                            continue;
+        std::string data;
+        while (m_network->get_events(data))
+            m_events.read(data);
 
-                        respawn(p, pos, rot);
-                        break;
-                    }
-                }
-                else if (cmd == "plane_set_hp")
-                {
-                    unsigned int plane_id; int hp;
-                    is >> plane_id, is >> hp;
-
-                    auto net = m_network->get_plane(plane_id);
-                    if (!net)
-                        continue;
+        while (m_network->get_general_msg(data))
+            read_text_event(data);
 
-                    for (auto &p: m_planes)
-                    {
-                        if(p->net != net)
-                            continue;
-
-                        p->hp = hp;
-                        break;
-                    }
-                }
-            }
-        }
+        m_events.dispatch();
 
         for (auto &p: m_planes)
         {
@@ -575,95 +737,91 @@ void world::update(int dt)
             m->phys->update(dt);
             m->phys->accel_started = m->net->engine_started;
 
-            m->target.reset();
-
-            auto target_net = m_network->get_plane(m->net->target);
-            if (!target_net)
-                continue;
-
-            for (auto &p: m_planes)
-            {
-                if(p->net == target_net)
-                {
-                    m->target = p;
-                    break;
-                }
-            }
+            m->target = get_net_plane(m->net->target);
         }
     }
 
-    auto removed_planes = std::remove_if(m_planes.begin(), m_planes.end(), [](const plane_ptr &p) { return p.unique() && (!p->net || p->net->source || p->net.unique()); });
-    if (removed_planes != m_planes.end())
+    if (remove_objects(m_planes, m_registry, [](const plane_ptr &p) { return p.unique() && (!p->net || p->net->source || p->net.unique()); }))
     {
-        m_planes.erase(removed_planes, m_planes.end());
         for (auto &p: m_planes)
             p->targets.erase(remove_if(p->targets.begin(), p->targets.end(), [](const plane::target_lock &t){ return t.target.expired(); }), p->targets.end());
     }
 
-    m_missiles.erase(std::remove_if(m_missiles.begin(), m_missiles.end(), [](const missile_ptr &m) { return (m->net && !m->net->source) ? m->net.unique() : m->time <= 0; }), m_missiles.end());
-
-    m_bombs.erase(std::remove_if(m_bombs.begin(), m_bombs.end(), [](const bomb_ptr &b) { return b->dead; }), m_bombs.end());
+    remove_objects(m_missiles, m_registry, [](const missile_ptr &m) { return (m->net && !m->net->source) ? m->net.unique() : m->time <= 0; });
+    remove_objects(m_bombs, m_registry, [](const bomb_ptr &b) { return b->dead; });
+    remove_objects(m_units, m_registry, [](const unit_ptr &u) { return u.unique(); });
 
-    m_units.erase(std::remove_if(m_units.begin(), m_units.end(), [](const unit_ptr &u) { return u.unique(); }), m_units.end());
+    update_objects_hash();
+    update_lag_compensation();
 
     for (auto &p: m_planes)
         p->phys->controls = p->controls;
 
-    m_phys_world.update_planes(dt, [this](const phys::object_ptr &a, const phys::object_ptr &b)
     {
-        auto p = this->get_plane(a);
-
-        if (!b) //hit ground
+        profile_scope("phys planes");
+        m_phys_world.update_planes(dt, [this](const phys::object_ptr &a, const phys::object_ptr &b)
         {
-            if (p->hp > 0)
+            auto p = this->get_plane(a);
+
+            if (!b) //hit ground
             {
-                p->take_damage(9000, *this);
-                on_kill(object_ptr(), p);
-                p->render->set_hide(true);
-                play_sound("PLAYER_CRASH_AIRPLANE", 0, p->get_pos());
+                if (p->hp > 0)
+                {
+                    p->take_damage(9000, *this);
+                    on_kill(object_ptr(), p);
+                    p->render_state.hide = true;
+                    play_sound("PLAYER_CRASH_AIRPLANE", 0, p->get_pos());
+                }
             }
-        }
-    });
+        });
+    }
 
-    for (auto &u: m_units) if (u->is_active()) u->update(dt, *this);
+    update_units(dt);
 
     for (auto &p: m_planes)
         p->alert_dirs.clear();
 
-    for (auto &m: m_missiles)
-        m->update_homing(dt, *this);
-
-    m_phys_world.update_missiles(dt, [this](const phys::object_ptr &a, const phys::object_ptr &b)
     {
-        auto m = this->get_missile(a);
-        if (m && m->time > 0)
+        profile_scope("missiles");
+
+        for (auto &m: m_missiles)
+            m->update_homing(dt, *this);
+
+        m_phys_world.update_missiles(dt, [this](const phys::object_ptr &a, const phys::object_ptr &b)
         {
-            this->spawn_explosion(m->phys->pos, m->dmg / 2.0f);
-            m->time = 0;
-            const bool target_alive = !m->target.expired() && m->target.lock()->hp > 0;
-            const bool hit = area_damage(m->phys->pos, m->dmg_radius, m->dmg, m->owner.lock());
-            if (m->owner.lock() == get_player() && target_alive)
+            auto m = this->get_missile(a);
+            if (m && m->time > 0)
             {
-                if (hit)
-                    this->popup_hit(m->target.lock()->hp <= 0);
-                else
-                    this->popup_miss();
+                this->spawn_explosion(m->phys->pos, m->dmg / 2.0f);
+                m->time = 0;
+                const bool target_alive = !m->target.expired() && m->target.lock()->hp > 0;
+                const bool hit = area_damage(m->phys->pos, m->dmg_radius, m->dmg, m->owner.lock());
+                if (m->owner.lock() == get_player() && target_alive)
+                {
+                    if (hit)
+                        this->popup_hit(m->target.lock()->hp <= 0);
+                    else
+                        this->popup_miss();
+                }
             }
-        }
-    });
+        });
 
-    m_phys_world.update_bombs(dt, [this](const phys::object_ptr &a, const phys::object_ptr &b)
-    {
-        auto m = this->get_bomb(a);
-        if (m && !m->dead)
+        m_phys_world.update_bombs(dt, [this](const phys::object_ptr &a, const phys::object_ptr &b)
         {
-            this->spawn_explosion(m->phys->pos, m->dmg / 2.0f);
-            m->dead = true;
-            area_damage(m->phys->pos, m->dmg_radius, m->dmg, m->owner.lock());
-        }
-    });
+            auto m = this->get_bomb(a);
+            if (m && !m->dead)
+            {
+                this->spawn_explosion(m->phys->pos, m->dmg / 2.0f);
+                m->dead = true;
+                area_damage(m->phys->pos, m->dmg_radius, m->dmg, m->owner.lock(), false);
+            }
+        });
+    }
 
-    m_phys_world.update_bullets(dt);
+    {
+        profile_scope("bullets");
+        m_phys_world.update_bullets(dt);
+    }
 
     if (!m_player.expired())
     {
@@ -686,32 +844,35 @@ void world::update(int dt)
     if (!m_player.expired())
         m_player.lock()->update_hud(*this, m_hud);
 
-    for (auto &p: m_planes)
-        p->update(dt, *this);
+    {
+        profile_scope("planes");
+        for (auto &p: m_planes)
+            p->update(dt, *this);
+
+        m_planes_hash.clear_changes(); //tracked by radars
+        m_units_hash.clear_changes();
+    }
 
     for (auto &m: m_missiles)
         m->update(dt, *this);
 
-    for (auto &b: m_bombs)
-        b->update(dt, *this);
+    write_render_snapshot();
 
-    const auto &bullets_from = m_phys_world.get_bullets();
-    auto &bullets_to = m_render_world.get_bullets();
-    bullets_to.clear();
-    for (auto &b: bullets_from)
-        bullets_to.add_bullet(b.pos, b.vel);
-
-    m_render_world.update(dt);
-    m_sound_world.update(dt);
+    {
+        profile_scope("sound");
+        m_sound_world.update(dt);
+    }
 
     if (m_network)
     {
+        profile_scope("net send");
+
         for (auto &p: m_planes)
         {
             if (!p->net)
                 continue;
 
-            if (p->net_game_data.changed)
+            if (p->net_game_data.is_changed())
                 m_network->send_game_data(p->net, p->net_game_data);
 
             p->net->pos = p->phys->pos;
@@ -749,21 +910,87 @@ void world::update(int dt)
             m->net->engine_started = m->phys->accel_started;
         }
 
+        if (m_events.has_outgoing())
+        {
+            m_network->send_events(m_events.get_outgoing());
+            m_events.clear_outgoing();
+        }
+
         m_network->update_post(dt);
     }
 
     for (auto &p: m_planes)
     {
-        if (!p->net_game_data.changed)
+        if (!p->net_game_data.is_changed())
             continue;
 
         m_net_data_updated = true;
-        p->net_game_data.changed = false;
+        p->net_game_data.reset_changed();
     }
 }
 
 //------------------------------------------------------------
 
+void world::write_render_snapshot()
+{
+    auto &s = m_render_snapshot;
+    s.tick = m_tick;
+
+    s.planes.resize(m_planes.size());
+    for (size_t i = 0; i < m_planes.size(); ++i)
+        s.planes[i] = m_planes[i]->render_state;
+
+    s.missiles.resize(m_missiles.size());
+    for (size_t i = 0; i < m_missiles.size(); ++i)
+    {
+        auto &from = m_missiles[i];
+        auto &to = s.missiles[i];
+        to.render = from->render;
+        to.prev = from->last_tick;
+        to.pos = from->phys->pos;
+        to.rot = from->phys->rot;
+        to.engine_started = from->phys->accel_started;
+    }
+
+    s.bombs.resize(m_bombs.size());
+    for (size_t i = 0; i < m_bombs.size(); ++i)
+    {
+        auto &from = m_bombs[i];
+        auto &to = s.bombs[i];
+        to.render = from->render;
+        to.pos = from->phys->pos;
+        to.rot = from->phys->rot;
+    }
+
+    s.units.resize(m_units.size());
+    for (size_t i = 0; i < m_units.size(); ++i)
+        m_units[i]->write_render_state(s.units[i]);
+
+    const auto &bullets = m_phys_world.get_bullets();
+    s.bullets.resize(bullets.size());
+    for (size_t i = 0; i < bullets.size(); ++i)
+    {
+        s.bullets[i].pos = bullets[i].pos;
+        s.bullets[i].vel = bullets[i].vel;
+    }
+
+    while (!m_explosions.empty() && m_tick - m_explosions.front().tick > render_snapshot::explosions_keep_ticks)
+        m_explosions.pop_front();
+    s.explosions.assign(m_explosions.begin(), m_explosions.end());
+}
+
+//------------------------------------------------------------
+
+void world::update_render(int dt, float k)
+{
+    profile_scope("update render");
+
+    m_render_snapshot.apply(m_render_world, k, m_render_tick);
+    m_render_world.update(dt);
+}
+
+//------------------------------------------------------------
+
 bool world::is_ally(const plane_ptr &a, const plane_ptr &b)
 {
     if (a == b)
@@ -777,52 +1004,152 @@ bool world::is_ally(const plane_ptr &a, const plane_ptr &b)
 
 //------------------------------------------------------------
 
-void world::on_kill(const object_ptr &k, const object_ptr &v)
+uint32_t world::get_state_hash() const
 {
-    if (m_on_kill_handler)
-        m_on_kill_handler(k, v);
+    uint32_t hash = 2166136261u; //fnv-1a
+    auto add = [&hash](const void *data, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ ((const uint8_t *)data)[i]) * 16777619u;
+    };
+
+    auto add_vec3 = [&add](const vec3 &v) { add(&v.x, sizeof(float)), add(&v.y, sizeof(float)), add(&v.z, sizeof(float)); };
+
+    const uint32_t counts[] = { (uint32_t)m_planes.size(), (uint32_t)m_missiles.size(), (uint32_t)m_units.size() };
+    add(counts, sizeof(counts));
+
+    for (auto &p: m_planes)
+    {
+        add_vec3(p->phys->pos);
+        add_vec3(p->phys->vel);
+        add_vec3(p->phys->rot.v), add(&p->phys->rot.w, sizeof(float));
+        const int hp = p->hp;
+        add(&hp, sizeof(hp));
+    }
+
+    for (auto &m: m_missiles)
+    {
+        add_vec3(m->phys->pos);
+        const int time = m->time;
+        add(&time, sizeof(time));
+    }
+
+    for (auto &u: m_units)
+    {
+        add_vec3(u->get_pos());
+        const int hp = u->hp;
+        add(&hp, sizeof(hp));
+    }
+
+    return hash;
 }
 
 //------------------------------------------------------------
 
-plane_ptr world::get_plane(const phys::object_ptr &o)
+plane_ptr world::get_net_plane(unsigned int id) const
 {
-    if (!o)
+    if (!m_network)
         return plane_ptr();
 
-    for (auto &p: m_planes)
+    return m_registry.get_plane(m_network->get_plane(id).get());
+}
+
+//------------------------------------------------------------
+
+void world::init_events()
+{
+    m_events.set_handler<event_explosion>([this](const event_explosion &e) { this->spawn_explosion(e.pos, e.radius, false); });
+
+    m_events.set_handler<event_plane_damage>([this](const event_plane_damage &e)
     {
-        if (p->phys == o)
-            return p;
-    }
+        auto p = this->get_net_plane(e.plane_id);
+        if (p && this->is_host())
+            p->take_damage(e.damage, *this, false);
+    });
 
-    return plane_ptr();
+    m_events.set_handler<event_plane_respawn>([this](const event_plane_respawn &e)
+    {
+        auto p = this->get_net_plane(e.plane_id);
+        if (p && !this->is_host())
+            this->respawn(p, e.pos, e.rot);
+    });
+
+    m_events.set_handler<event_plane_hp>([this](const event_plane_hp &e)
+    {
+        auto p = this->get_net_plane(e.plane_id);
+        if (p && !this->is_host())
+            p->hp = e.hp;
+    });
 }
 
 //------------------------------------------------------------
 
-missile_ptr world::get_missile(const phys::object_ptr &o)
+void world::read_text_event(const std::string &str)
 {
-    for (auto &m: m_missiles)
+    std::istringstream is(str);
+    std::string cmd;
+    is >> cmd;
+
+    if (cmd == "explosion")
     {
-        if (m->phys == o)
-            return m;
+        event_explosion e;
+        read(is, e.pos), is >> e.radius;
+        m_events.post(e);
     }
+    else if (cmd == "plane_take_damage")
+    {
+        event_plane_damage e;
+        is >> e.plane_id, is >> e.damage;
+        m_events.post(e);
+    }
+    else if (cmd == "respawn")
+    {
+        event_plane_respawn e;
+        is >> e.plane_id, read(is, e.pos), read(is, e.rot);
+        m_events.post(e);
+    }
+    else if (cmd == "plane_set_hp")
+    {
+        event_plane_hp e;
+        is >> e.plane_id, is >> e.hp;
+        m_events.post(e);
+    }
+}
+
+//------------------------------------------------------------
+
+std::string to_string(const event_explosion &e) { return "explosion " + to_string(e.pos) + " " + std::to_string(e.radius); }
+std::string to_string(const event_plane_damage &e) { return "plane_take_damage " + std::to_string(e.plane_id) + " " + std::to_string(e.damage); }
+std::string to_string(const event_plane_respawn &e) { return "respawn " + std::to_string(e.plane_id) + " " + to_string(e.pos) + " " + to_string(e.rot); }
+std::string to_string(const event_plane_hp &e) { return "plane_set_hp " + std::to_string(e.plane_id) + " " + std::to_string(e.hp); }
+
+//------------------------------------------------------------
 
-    return missile_ptr();
+void world::on_kill(const object_ptr &k, const object_ptr &v)
+{
+    if (m_on_kill_handler)
+        m_on_kill_handler(k, v);
 }
 
 //------------------------------------------------------------
 
-bomb_ptr world::get_bomb(const phys::object_ptr &o)
+plane_ptr world::get_plane(const phys::object_ptr &o)
 {
-    for (auto &b: m_bombs)
-    {
-        if (b->phys == o)
-            return b;
-    }
+    return m_registry.get_plane(o.get());
+}
 
-    return bomb_ptr();
+//------------------------------------------------------------
+
+missile_ptr world::get_missile(const phys::object_ptr &o)
+{
+    return m_registry.get_missile(o.get());
+}
+
+//------------------------------------------------------------
+
+bomb_ptr world::get_bomb(const phys::object_ptr &o)
+{
+    return m_registry.get_bomb(o.get());
 }
 
 //------------------------------------------------------------
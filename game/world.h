@@ -8,6 +8,11 @@
 #include "difficulty.h"
 #include "plane.h"
 #include "units.h"
+#include "object_registry.h"
+#include "events.h"
+#include "lag_compensation.h"
+#include "util/spatial_hash.h"
+#include <deque>
 
 namespace game
 {
@@ -30,7 +35,12 @@ public:
     void spawn_explosion(const vec3 &pos, float radius, bool net_src = true);
     void spawn_bullet(const char *type, const vec3 &pos, const vec3 &dir, const plane_ptr &owner);
 
-    bool area_damage(const vec3 &pos, float radius, int damage, const plane_ptr &owner);
+    bool area_damage(const vec3 &pos, float radius, int damage, const plane_ptr &owner, bool synced = true); //bombs aren't synced
+
+    //planes are hit on the host, where a remote owner saw them, clients only predict these hits
+    //other objects are hit on the owner's side
+    enum hit_check { hit_skip, hit_apply, hit_predict };
+    hit_check get_hit_check(const plane_ptr &owner, const object_ptr &target, vec3 &target_pos);
 
     void respawn(const plane_ptr &p, const vec3 &pos, const quat &rot);
 
@@ -50,8 +60,19 @@ public:
     int get_objects_count() const;
     object_ptr get_object(int idx);
 
+    //coarse search by xz cells, check the actual distance
+    void find_planes(const vec3 &pos, float radius, std::vector<plane_ptr> &result) const;
+    void find_units(const vec3 &pos, float radius, std::vector<unit_ptr> &result) const;
+    void find_objects(const vec3 &pos, float radius, std::vector<object_ptr> &result) const;
+    void find_objects(const vec3 &from, const vec3 &to, float radius, std::vector<object_ptr> &result) const;
+    //same area every tick, only changes of the objects hash are applied
+    void track_objects(const vec3 &pos, float radius, spatial_hash_area<w_ptr<plane> > &planes, spatial_hash_area<object_wptr> &units) const;
+
     float get_height(float x, float z) const { return m_phys_world.get_height(x, z, true); }
 
+    //units and bots far from human players are simulated coarsely
+    const sim_lod &get_sim_lod() const { return m_sim_lod; }
+
     bool is_ally(const plane_ptr &a, const plane_ptr &b);
     typedef std::function<bool(const plane_ptr &a, const plane_ptr &b)> is_ally_handler;
     void set_ally_handler(const is_ally_handler &handler) { m_ally_handler = handler; }
@@ -68,6 +89,14 @@ public:
     void popup_mission_fail();
 
     void update(int dt);
+    void update_render(int dt, float k); //k is time since the last update in ticks, 0..1
+
+    //no wall clock dependent decisions, for replays
+    void set_deterministic(bool enable) { m_deterministic = enable; }
+    void set_seed(uint32_t seed) { m_random.seed(seed); }
+    random_sequence &get_random() { return m_random; } //for everything that affects the sim state
+    bool is_deterministic() const { return m_deterministic; }
+    uint32_t get_state_hash() const;
 
     void set_network(network_interface *n) { m_network = n; }
     network_interface *get_network() { return m_network; }
@@ -76,16 +105,34 @@ public:
 
     unsigned int get_net_time() const { return m_network ? m_network->get_time() : 0; }
 
+    template<typename t> void send_event(const t &e)
+    {
+        if (!m_network)
+            return;
+
+        if (m_text_events)
+            m_network->general_msg(to_string(e)); //debug
+        else
+            m_events.send(e);
+    }
+
     sound::source_ptr add_sound(sound::file &f, bool loop = false) { return m_sound_world.add(f, loop); }
     sound::source_ptr add_sound(std::string name, int idx = 0, bool loop = false);
     unsigned int play_sound_ui(std::string name, bool loop = false);
     void stop_sound_ui(unsigned int id);
     void play_sound(std::string name, int idx, vec3 pos);
 
-    world(renderer::world &w, sound::world &s, gui::hud &h): m_render_world(w), m_sound_world(s), m_hud(h), m_network(0) {}
+    world(renderer::world &w, sound::world &s, gui::hud &h): m_render_world(w), m_sound_world(s), m_hud(h), m_network(0) { init_events(); }
 
 private:
     void update_difficulty();
+    void write_render_snapshot();
+    void update_objects_hash();
+    void update_units(int dt);
+    void update_lag_compensation();
+    void init_events();
+    void read_text_event(const std::string &str);
+    plane_ptr get_net_plane(unsigned int id) const;
 
 private:
     missile_ptr add_missile(const char *id, const renderer::model &m, bool add_to_phys_world);
@@ -99,9 +146,15 @@ private:
     difficulty_settings m_difficulty;
     std::vector<plane_ptr> m_planes;
     w_ptr<plane> m_player;
+    mutable std::string m_player_name;
     std::vector<missile_ptr> m_missiles;
     std::vector<bomb_ptr> m_bombs;
     std::vector<unit_ptr> m_units;
+    spatial_hash<w_ptr<plane> > m_planes_hash;
+    spatial_hash<unit_wptr> m_units_hash;
+    object_registry m_registry;
+    sim_lod m_sim_lod;
+    lag_compensation m_lag_compensation;
     renderer::world &m_render_world;
     gui::hud &m_hud;
     phys::world m_phys_world;
@@ -113,9 +166,17 @@ private:
     is_ally_handler m_ally_handler;
     on_kill_handler m_on_kill_handler;
 
+    unsigned int m_tick = 0, m_render_tick = 0;
+    std::deque<render_snapshot::explosion> m_explosions;
+    render_snapshot m_render_snapshot; //written by the tick, applied by update_render
+
 private:
     network_interface *m_network;
     bool m_net_data_updated = false;
+    event_bus m_events;
+    bool m_text_events = false;
+    bool m_deterministic = false;
+    random_sequence m_random;
 };
 
 //------------------------------------------------------------
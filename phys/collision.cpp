@@ -0,0 +1,380 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "collision.h"
+#include "containers/fhm.h"
+#include "memory/memory_reader.h"
+#include "memory/tmp_buffer.h"
+#include "math/quaternion.h"
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+namespace phys
+{
+//------------------------------------------------------------
+
+namespace
+{
+    const char collision_sign[4] = {'O','H','C','L'};
+    const uint32_t collision_version = 2;
+
+    struct collision_header
+    {
+        char sign[4];
+        uint32_t version;
+        uint32_t meshes_count;
+        uint32_t instances_count;
+        float index_origin_x;
+        float index_origin_z;
+        float index_cell_size;
+        int32_t index_width;
+        int32_t index_height;
+        uint32_t index_items_count;
+    };
+
+    const float min_cell_size = 512.0f;
+    const int max_cells = 256; //per side
+
+    struct collision_instance
+    {
+        int32_t mesh_idx;
+        nya_math::vec3 pos;
+        float yaw;
+        nya_math::vec3 bbox_origin;
+        nya_math::vec3 bbox_delta;
+    };
+
+    template<typename t> void write_value(std::string &data, const t &value) { data.append((const char *)&value, sizeof(t)); }
+}
+
+//------------------------------------------------------------
+
+void collision::add_instance(int mesh_idx, const nya_math::vec3 &pos, float yaw)
+{
+    if (mesh_idx < 0 || mesh_idx >= (int)meshes.size())
+        return;
+
+    instances.resize(instances.size() + 1);
+    auto &inst = instances.back();
+    inst.mesh_idx = mesh_idx;
+    inst.pos = pos;
+    inst.yaw = yaw;
+    inst.bbox = nya_math::aabb(meshes[mesh_idx].bbox, pos, nya_math::quat(0.0f, yaw, 0.0f), nya_math::vec3(1.0f, 1.0f, 1.0f));
+}
+
+//------------------------------------------------------------
+
+bool collision::load_ah(const char *location_name)
+{
+    meshes.clear();
+    instances.clear();
+
+    fhm_file fhm;
+    if (!fhm.open((std::string("Map/") + location_name + ".fhm").c_str()))
+        return false;
+
+    for (int i = 0; i < fhm.get_chunks_count(); ++i)
+    {
+        if (fhm.get_chunk_type(i) == 'HLOC')
+        {
+            nya_memory::tmp_buffer_scoped buf(fhm.get_chunk_size(i));
+            fhm.read_chunk_data(i, buf.get_data());
+            meshes.resize(meshes.size() + 1);
+            meshes.back().load(buf.get_data(), buf.get_size());
+        }
+    }
+
+    fhm.close();
+
+    if (!fhm.open((std::string("Map/") + location_name + "_mpt.fhm").c_str()))
+        return false;
+
+    assert(fhm.get_chunks_count() == meshes.size());
+
+    for (int i = 0; i < fhm.get_chunks_count(); ++i)
+    {
+        assert(fhm.get_chunk_type(i) == 'xtpm');
+
+        nya_memory::tmp_buffer_scoped buf(fhm.get_chunk_size(i));
+        fhm.read_chunk_data(i, buf.get_data());
+        nya_memory::memory_reader reader(buf.get_data(), buf.get_size());
+        reader.seek(128);
+        const auto count = reader.read<uint32_t>();
+        reader.skip(16);
+        instances.reserve(instances.size() + count);
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            const auto pos = reader.read<nya_math::vec3>();
+            const float yaw = reader.read<float>();
+            add_instance(i, pos, yaw);
+        }
+    }
+
+    fhm.close();
+    build_index(); //AH archives are read only, no place for a prebuilt one
+    return true;
+}
+
+//------------------------------------------------------------
+
+bool collision::load(const void *data, size_t size)
+{
+    meshes.clear();
+    instances.clear();
+
+    if (!data || size < sizeof(collision_header))
+        return false;
+
+    nya_memory::memory_reader reader(data, size);
+    const auto header = reader.read<collision_header>();
+    if (memcmp(header.sign, collision_sign, sizeof(collision_sign)) != 0)
+        return false;
+
+    if (header.version != collision_version)
+    {
+        printf("unsupported collision version %d\n", header.version);
+        return false;
+    }
+
+    meshes.resize(header.meshes_count);
+    for (auto &m: meshes)
+    {
+        if (!m.read(reader))
+        {
+            printf("invalid collision mesh data\n");
+            meshes.clear();
+            return false;
+        }
+    }
+
+    if (reader.get_remained() < header.instances_count * sizeof(collision_instance))
+    {
+        printf("invalid collision instances data\n");
+        meshes.clear();
+        return false;
+    }
+
+    instances.resize(header.instances_count);
+    for (auto &inst: instances)
+    {
+        const auto ci = reader.read<collision_instance>();
+        inst.mesh_idx = ci.mesh_idx;
+        inst.pos = ci.pos;
+        inst.yaw = ci.yaw;
+        inst.bbox.origin = ci.bbox_origin;
+        inst.bbox.delta = ci.bbox_delta;
+    }
+
+    for (auto &inst: instances)
+    {
+        if (inst.mesh_idx < 0 || inst.mesh_idx >= (int)meshes.size())
+        {
+            printf("invalid collision instance mesh\n");
+            instances.clear(), meshes.clear();
+            return false;
+        }
+    }
+
+    const int width = header.index_width, height = header.index_height;
+    const uint64_t cells = width > 0 && height > 0 ? uint64_t(width) * height : 0;
+    if (width < 0 || height < 0 || width > max_cells || height > max_cells || !(header.index_cell_size > 0.0f)
+        || reader.get_remained() < (cells + 1 + header.index_items_count) * sizeof(uint32_t))
+    {
+        printf("invalid collision index data\n");
+        instances.clear(), meshes.clear();
+        return false;
+    }
+
+    index.origin_x = header.index_origin_x;
+    index.origin_z = header.index_origin_z;
+    index.cell_size = header.index_cell_size;
+    index.width = width, index.height = height;
+    index.offsets.resize(size_t(cells + 1));
+    for (auto &o: index.offsets)
+        o = reader.read<uint32_t>();
+    index.items.resize(header.index_items_count);
+    for (auto &i: index.items)
+        i = reader.read<uint32_t>();
+
+    bool valid = index.offsets.front() == 0 && index.offsets.back() == index.items.size();
+    for (size_t i = 1; valid && i < index.offsets.size(); ++i)
+        valid = index.offsets[i - 1] <= index.offsets[i];
+    for (size_t i = 0; valid && i < index.items.size(); ++i)
+        valid = index.items[i] < instances.size();
+
+    if (!valid)
+    {
+        printf("invalid collision index data\n");
+        index = grid();
+        instances.clear(), meshes.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------
+
+std::string collision::write() const
+{
+    std::string data;
+
+    collision_header header;
+    memcpy(header.sign, collision_sign, sizeof(header.sign));
+    header.version = collision_version;
+    header.meshes_count = uint32_t(meshes.size());
+    header.instances_count = uint32_t(instances.size());
+    header.index_origin_x = index.origin_x;
+    header.index_origin_z = index.origin_z;
+    header.index_cell_size = index.cell_size;
+    header.index_width = index.width;
+    header.index_height = index.height;
+    header.index_items_count = uint32_t(index.items.size());
+    write_value(data, header);
+
+    for (const auto &m: meshes)
+        m.write(data);
+
+    for (const auto &i: instances)
+    {
+        collision_instance ci;
+        ci.mesh_idx = i.mesh_idx;
+        ci.pos = i.pos;
+        ci.yaw = i.yaw;
+        ci.bbox_origin = i.bbox.origin;
+        ci.bbox_delta = i.bbox.delta;
+        write_value(data, ci);
+    }
+
+    if (index.offsets.empty())
+        write_value(data, uint32_t(0));
+    for (auto o: index.offsets)
+        write_value(data, o);
+    for (auto i: index.items)
+        write_value(data, i);
+
+    return data;
+}
+
+//------------------------------------------------------------
+
+void collision::build_index()
+{
+    index = grid();
+    if (instances.empty())
+        return;
+
+    float min_x = instances[0].bbox.origin.x, max_x = min_x;
+    float min_z = instances[0].bbox.origin.z, max_z = min_z;
+    for (const auto &i: instances)
+    {
+        const auto &b = i.bbox;
+        min_x = std::min(min_x, b.origin.x - b.delta.x), max_x = std::max(max_x, b.origin.x + b.delta.x);
+        min_z = std::min(min_z, b.origin.z - b.delta.z), max_z = std::max(max_z, b.origin.z + b.delta.z);
+    }
+
+    index.origin_x = min_x, index.origin_z = min_z;
+    index.cell_size = std::max(min_cell_size, std::max(max_x - min_x, max_z - min_z) / max_cells);
+    index.width = std::min(int((max_x - min_x) / index.cell_size) + 1, max_cells);
+    index.height = std::min(int((max_z - min_z) / index.cell_size) + 1, max_cells);
+
+    //counting pass, then fill
+    std::vector<uint32_t> counts(index.width * index.height, 0);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        if (pass == 1)
+        {
+            index.offsets.resize(counts.size() + 1, 0);
+            for (size_t c = 0; c < counts.size(); ++c)
+                index.offsets[c + 1] = index.offsets[c] + counts[c];
+            index.items.resize(index.offsets.back());
+            std::fill(counts.begin(), counts.end(), 0);
+        }
+
+        for (size_t i = 0; i < instances.size(); ++i)
+        {
+            const auto &b = instances[i].bbox;
+            const int x0 = index.cell_x(b.origin.x - b.delta.x), x1 = index.cell_x(b.origin.x + b.delta.x);
+            const int z0 = index.cell_z(b.origin.z - b.delta.z), z1 = index.cell_z(b.origin.z + b.delta.z);
+            for (int z = z0; z <= z1; ++z)
+            {
+                for (int x = x0; x <= x1; ++x)
+                {
+                    const int c = z * index.width + x;
+                    if (pass == 1)
+                        index.items[index.offsets[c] + counts[c]] = uint32_t(i);
+                    ++counts[c];
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------
+
+int collision::grid::cell_x(float x) const
+{
+    const float c = (x - origin_x) / cell_size;
+    return c > 0.0f ? int(std::min(c, float(width - 1))) : 0; //also for nan
+}
+
+//------------------------------------------------------------
+
+int collision::grid::cell_z(float z) const
+{
+    const float c = (z - origin_z) / cell_size;
+    return c > 0.0f ? int(std::min(c, float(height - 1))) : 0;
+}
+
+//------------------------------------------------------------
+
+bool collision::grid::get_objects(float x, float z, std::vector<int> &result) const
+{
+    result.clear();
+    if (!width || !height)
+        return false;
+
+    if (!(x >= origin_x && z >= origin_z && x < origin_x + cell_size * width && z < origin_z + cell_size * height))
+        return false;
+
+    const int c = cell_z(z) * width + cell_x(x);
+    result.assign(items.begin() + offsets[c], items.begin() + offsets[c + 1]);
+    return !result.empty();
+}
+
+//------------------------------------------------------------
+
+bool collision::grid::get_objects(const nya_math::aabb &box, std::vector<int> &result) const
+{
+    result.clear();
+    if (!width || !height)
+        return false;
+
+    const float x0 = box.origin.x - box.delta.x, x1 = box.origin.x + box.delta.x;
+    const float z0 = box.origin.z - box.delta.z, z1 = box.origin.z + box.delta.z;
+    if (!(x1 >= origin_x && z1 >= origin_z && x0 < origin_x + cell_size * width && z0 < origin_z + cell_size * height))
+        return false;
+
+    const int cx0 = cell_x(x0), cx1 = cell_x(x1), cz0 = cell_z(z0), cz1 = cell_z(z1);
+    for (int z = cz0; z <= cz1; ++z)
+    {
+        for (int x = cx0; x <= cx1; ++x)
+        {
+            const int c = z * width + x;
+            result.insert(result.end(), items.begin() + offsets[c], items.begin() + offsets[c + 1]);
+        }
+    }
+
+    if (cx0 != cx1 || cz0 != cz1)
+    {
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+
+    return !result.empty();
+}
+
+//------------------------------------------------------------
+}
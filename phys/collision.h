@@ -0,0 +1,60 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "mesh.h"
+#include <string>
+#include <vector>
+
+namespace phys
+{
+//------------------------------------------------------------
+
+struct collision
+{
+    std::vector<mesh> meshes;
+
+    struct instance
+    {
+        int mesh_idx = -1;
+        nya_math::vec3 pos;
+        float yaw = 0.0f;
+        nya_math::aabb bbox;
+    };
+
+    std::vector<instance> instances;
+
+    //instance indices by xz cells, prebuilt and stored in the blob
+    struct grid
+    {
+        float origin_x = 0.0f, origin_z = 0.0f;
+        float cell_size = 1.0f;
+        int width = 0, height = 0;
+        std::vector<uint32_t> offsets; //first item of each cell, width * height + 1
+        std::vector<uint32_t> items;
+
+    public:
+        //candidates with overlapping cells, false if none
+        bool get_objects(const nya_math::aabb &box, std::vector<int> &result) const;
+        bool get_objects(const nya_math::vec3 &pos, std::vector<int> &result) const { return get_objects(pos.x, pos.z, result); }
+        bool get_objects(float x, float z, std::vector<int> &result) const;
+
+        int cell_x(float x) const; //clamped to the grid
+        int cell_z(float z) const;
+    };
+
+    grid index;
+
+public:
+    void add_instance(int mesh_idx, const nya_math::vec3 &pos, float yaw);
+    void build_index();
+
+    bool load_ah(const char *location_name); //from Map/*.fhm
+    bool load(const void *data, size_t size); //prebuilt blob
+    std::string write() const;
+};
+
+//------------------------------------------------------------
+}
@@ -5,6 +5,7 @@
 #include "mesh.h"
 #include "util/util.h"
 #include "memory/memory_reader.h"
+#include <algorithm>
 
 namespace phys
 {
@@ -158,6 +159,130 @@ bool mesh::load(const void *data, size_t size)
 
 //------------------------------------------------------------
 
+void mesh::add_shape(const std::vector<nya_math::vec3> &tris)
+{
+    typedef nya_math::vec3 vec3;
+
+    std::vector<vec3> valid;
+    valid.reserve(tris.size());
+    for (size_t i = 0; i + 2 < tris.size(); i += 3)
+    {
+        //degenerate triangles give false hits
+        if (vec3::cross(tris[i+1] - tris[i], tris[i+2] - tris[i]).length_sq() < 1.0e-8f)
+            continue;
+
+        valid.push_back(tris[i]);
+        valid.push_back(tris[i+1]);
+        valid.push_back(tris[i+2]);
+    }
+
+    const int count = int(valid.size() / 3);
+    if (!count)
+        return;
+
+    vec3 bmin = valid[0], bmax = valid[0];
+    if (!m_shapes.empty())
+    {
+        bmin = bbox.origin - bbox.delta;
+        bmax = bbox.origin + bbox.delta;
+    }
+
+    for (const auto &v: valid)
+    {
+        bmin = vec3::min(bmin, v);
+        bmax = vec3::max(bmax, v);
+    }
+
+    bbox.origin = (bmin + bmax) * 0.5f;
+    bbox.delta = (bmax - bmin) * 0.5f;
+
+    m_shapes.resize(m_shapes.size() + 1);
+    auto &s = m_shapes.back();
+    s.pls.resize((count + 3) / 4);
+
+    for (int i = 0; i < (int)s.pls.size(); ++i)
+    {
+        align16 float p[3][4], lv[3][4], rv[3][4], n[3][4];
+        for (int j = 0; j < 4; ++j)
+        {
+            //pad with last triangle, empty lanes give false hits
+            const int idx = std::min(i * 4 + j, count - 1) * 3;
+            const vec3 &v0 = valid[idx], e1 = valid[idx + 1] - v0, e2 = valid[idx + 2] - v0;
+            const vec3 nv = vec3::cross(e1, e2);
+            for (int k = 0; k < 3; ++k)
+            {
+                p[k][j] = v0[k];
+                lv[k][j] = e1[k];
+                rv[k][j] = e2[k];
+                n[k][j] = nv[k];
+            }
+        }
+
+        auto load4 = [](const float (&f)[3][4]) { return vec3_float4(_mm_load_ps(f[0]), _mm_load_ps(f[1]), _mm_load_ps(f[2])); };
+
+        auto &pl = s.pls[i];
+        pl.p = load4(p);
+        pl.lv = load4(lv);
+        pl.rv = load4(rv);
+        pl.v = load4(n);
+    }
+}
+
+//------------------------------------------------------------
+
+template<typename t> void write_value(std::string &data, const t &value) { data.append((const char *)&value, sizeof(t)); }
+
+//------------------------------------------------------------
+
+void mesh::write(std::string &data) const
+{
+    write_value(data, bbox.origin);
+    write_value(data, bbox.delta);
+    write_value(data, uint32_t(m_shapes.size()));
+    for (const auto &s: m_shapes)
+    {
+        write_value(data, uint32_t(s.pls.size()));
+        for (const auto &p: s.pls)
+            write_value(data, p);
+    }
+}
+
+//------------------------------------------------------------
+
+bool mesh::read(nya_memory::memory_reader &reader)
+{
+    m_shapes.clear();
+
+    if (reader.get_remained() < sizeof(nya_math::vec3) * 2 + sizeof(uint32_t))
+        return false;
+
+    bbox.origin = reader.read<nya_math::vec3>();
+    bbox.delta = reader.read<nya_math::vec3>();
+
+    const auto shapes_count = reader.read<uint32_t>();
+    if (reader.get_remained() < shapes_count * sizeof(uint32_t))
+        return false;
+
+    m_shapes.resize(shapes_count);
+    for (auto &s: m_shapes)
+    {
+        if (reader.get_remained() < sizeof(uint32_t))
+            return false;
+
+        const auto count = reader.read<uint32_t>();
+        if (reader.get_remained() < count * sizeof(pl))
+            return false;
+
+        s.pls.resize(count);
+        for (auto &p: s.pls)
+            p = reader.read<pl>();
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------
+
 bool mesh::trace(const nya_math::vec3 &from, const nya_math::vec3 &to) const
 {
     const vec3_float4 from4 = vec3_float4(from);
@@ -8,6 +8,9 @@
 #include "util/simd.h"
 #include "memory/align_alloc.h"
 #include <vector>
+#include <string>
+
+namespace nya_memory { class memory_reader; }
 
 namespace phys
 {
@@ -19,6 +22,10 @@ struct mesh
 
 public:
     bool load(const void *data, size_t size);
+    void add_shape(const std::vector<nya_math::vec3> &tris); //triangle list, one-sided
+
+    void write(std::string &data) const;
+    bool read(nya_memory::memory_reader &reader);
 
     bool trace(const nya_math::vec3 &from, const nya_math::vec3 &to) const;
     bool trace(const nya_math::vec3 &from, const nya_math::vec3 &to, float &result) const;
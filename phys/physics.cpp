@@ -9,19 +9,17 @@
 #include "containers/fhm.h"
 #include "util/location.h"
 #include "util/xml.h"
+#include "util/arms_params.h"
 #include <algorithm>
+#include <map>
+#include <mutex>
 
 namespace phys
 {
 //------------------------------------------------------------
 
-namespace { const static params::text_params &get_arms_param() { static params::text_params ap("Arms/ArmsParam.txt"); return ap; } }
-
-//------------------------------------------------------------
-
 static const float meps_to_kmph = 3.6f;
 static const float kmph_to_meps = 1.0 / meps_to_kmph;
-static const float ang_to_rad = nya_math::constants::pi / 180.0;
 
 //------------------------------------------------------------
 
@@ -39,17 +37,35 @@ inline float tend(float value, float target, float speed)
 
 //------------------------------------------------------------
 
+std::shared_ptr<const world::location> world::get_location(const char *name)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const location> > cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const std::string key(name ? name : "");
+    auto l = cache[key].lock();
+    if (l)
+        return l;
+
+    auto loaded = std::make_shared<location>();
+    loaded->load(key.c_str());
+    cache[key] = loaded;
+    return loaded;
+}
+
+//------------------------------------------------------------
+
 void world::set_location(const char *name)
 {
-    m_heights.clear();
-    m_meshes.clear();
-    m_qtree = nya_math::quadtree();
-    m_instances.clear();
+    m_location = get_location(name);
+}
 
-    m_height_quad_size = 1024;
-    m_height_quad_frags = 8;
-    m_height_subquads_per_quad = 8;
+//------------------------------------------------------------
 
+void world::location::load(const char *name)
+{
     if (is_native_location(name))
     {
         auto &zip = get_native_location_provider(name);
@@ -59,33 +75,37 @@ void world::set_location(const char *name)
             return;
 
         auto tiles = doc.first_child().child("tiles");
-        m_height_quad_size = tiles.attribute("quad_size").as_int();
-        m_height_quad_frags = tiles.attribute("quad_frags").as_int();
-        m_height_subquads_per_quad = tiles.attribute("subfrags").as_int();
+        height_quad_size = tiles.attribute("quad_size").as_int();
+        height_quad_frags = tiles.attribute("quad_frags").as_int();
+        height_subquads_per_quad = tiles.attribute("subfrags").as_int();
 
         auto height_off = load_resource(zip.access("height_offsets.bin"));
-        assert(height_off.get_size() >= sizeof(m_height_patches));
-        height_off.copy_to(m_height_patches, sizeof(m_height_patches));
+        assert(height_off.get_size() >= sizeof(height_patches));
+        height_off.copy_to(height_patches, sizeof(height_patches));
         height_off.free();
 
-        auto heights = load_resource(zip.access("heights.bin"));
+        auto heights_data = load_resource(zip.access("heights.bin"));
         std::string format = doc.first_child().child("heightmap").attribute("format").as_string();
         if (format == "byte")
         {
-            m_heights.resize(heights.get_size());
-            auto hdata = (unsigned char *)heights.get_data();
+            heights.resize(heights_data.get_size());
+            auto hdata = (unsigned char *)heights_data.get_data();
             const float hscale = doc.first_child().child("heightmap").attribute("scale").as_float(1.0f);
-            for (size_t i = 0; i < m_heights.size(); ++i)
-                m_heights[i] = hdata[i] * hscale;
+            for (size_t i = 0; i < heights.size(); ++i)
+                heights[i] = hdata[i] * hscale;
         }
         else if (format == "float")
         {
-            m_heights.resize(heights.get_size()/4);
-            heights.copy_to(m_heights.data(), heights.get_size());
+            heights.resize(heights_data.get_size()/4);
+            heights_data.copy_to(heights.data(), heights_data.get_size());
         }
-        heights.free();
+        heights_data.free();
 
-        //ToDo: objects
+        collision c;
+        auto col_data = load_resource(zip.access("collision.bin"));
+        if (c.load(col_data.get_data(), col_data.get_size()))
+            set_collision(c);
+        col_data.free();
 
         return;
     }
@@ -94,63 +114,59 @@ void world::set_location(const char *name)
     if (!fhm.open((std::string("Map/") + name + ".fhm").c_str()))
         return;
 
-    assert(fhm.get_chunk_size(4) == location_size*location_size);
-    fhm.read_chunk_data(4, m_height_patches);
+    assert(fhm.get_chunk_size(4) == size*size);
+    fhm.read_chunk_data(4, height_patches);
 
-    m_heights.resize(fhm.get_chunk_size(5)/4);
-    assert(!m_heights.empty());
-    fhm.read_chunk_data(5, &m_heights[0]);
-
-    for (int i = 0; i < fhm.get_chunks_count(); ++i)
-    {
-        if (fhm.get_chunk_type(i) == 'HLOC')
-        {
-            nya_memory::tmp_buffer_scoped buf(fhm.get_chunk_size(i));
-            fhm.read_chunk_data(i, buf.get_data());
-            m_meshes.resize(m_meshes.size() + 1);
-            m_meshes.back().load(buf.get_data(), buf.get_size());
-        }
-    }
+    heights.resize(fhm.get_chunk_size(5)/4);
+    assert(!heights.empty());
+    fhm.read_chunk_data(5, &heights[0]);
 
     fhm.close();
 
-    if (!fhm.open((std::string("Map/") + name + "_mpt.fhm").c_str()))
-        return;
+    collision c;
+    if (c.load_ah(name))
+        set_collision(c);
+}
 
-    assert(fhm.get_chunks_count() == m_meshes.size());
+//------------------------------------------------------------
 
-    for (int i = 0; i < fhm.get_chunks_count(); ++i)
+void world::location::set_collision(const collision &c)
+{
+    meshes = c.meshes;
+    instances.resize(c.instances.size());
+    for (size_t i = 0; i < c.instances.size(); ++i)
     {
-        assert(fhm.get_chunk_type(i) == 'xtpm');
-
-        nya_memory::tmp_buffer_scoped buf(fhm.get_chunk_size(i));
-        fhm.read_chunk_data(i, buf.get_data());
-        nya_memory::memory_reader reader(buf.get_data(), buf.get_size());
-        reader.seek(128);
-        const auto off = m_instances.size();
-        const auto count = reader.read<uint32_t>();
-        reader.skip(16);
-        m_instances.resize(off + count);
-        for (uint32_t j = 0; j < count; ++j)
-        {
-            auto &inst = m_instances[off + j];
-            inst.mesh_idx = i;
-            inst.pos = reader.read<nya_math::vec3>();
-            const float yaw = reader.read<float>();
-            inst.yaw_s = sinf(yaw);
-            inst.yaw_c = cosf(yaw);
-            inst.bbox = nya_math::aabb(m_meshes[i].bbox, inst.pos,
-                                       nya_math::quat(0.0f, yaw, 0.0f), nya_math::vec3(1.0f, 1.0f, 1.0f));
-        }
+        const auto &from = c.instances[i];
+        auto &inst = instances[i];
+        inst.mesh_idx = from.mesh_idx;
+        inst.pos = from.pos;
+        inst.yaw_s = sinf(from.yaw);
+        inst.yaw_c = cosf(from.yaw);
+        inst.bbox = from.bbox;
     }
 
-    fhm.close();
+    index = c.index;
+}
+
+//------------------------------------------------------------
+
+namespace
+{
+const plane_params &get_plane_params(const std::string &name)
+{
+    static std::mutex mutex;
+    static std::map<std::string, plane_params> cache;
 
-    const int size = 64000;
-    m_qtree = nya_math::quadtree(-size, -size, size * 2, size * 2, 10);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto p = cache.find(name);
+    if (p == cache.end())
+    {
+        p = cache.insert(std::make_pair(name, plane_params())).first;
+        p->second.load(("Player/Behavior/param_p_" + name + ".bin").c_str());
+    }
 
-    for(int i=0;i<(int)m_instances.size();++i)
-        m_qtree.add_object(m_instances[i].bbox, i);
+    return p->second; //never removed
+}
 }
 
 //------------------------------------------------------------
@@ -158,11 +174,11 @@ void world::set_location(const char *name)
 plane_ptr world::add_plane(const char *name, bool add_to_world)
 {
     auto p = std::make_shared<plane>();
-    p->params.load(("Player/Behavior/param_p_" + std::string(name) + ".bin").c_str());
+    p->params = get_plane_params(name);
     p->reset_state();
     if (add_to_world)
         m_planes.push_back(p);
-    get_arms_param();  //cache
+    params::arms_params::get(name);  //cache
     return p;
 }
 
@@ -172,19 +188,17 @@ missile_ptr world::add_missile(const char *name, bool add_to_world)
 {
     auto m = std::make_shared<missile>();
 
-    const std::string pref = "." + std::string(name) + ".action.";
-
-    auto &param = get_arms_param();
+    auto &param = params::arms_params::get(name);
 
-    m->no_accel_time = param.get_float(pref + "noAcceleTime") * 1000;
-    m->accel = param.get_float(pref + "accele") * kmph_to_meps;
-    m->speed_init = param.get_float(pref + "speedInit") * kmph_to_meps;
-    m->max_speed = param.get_float(pref + "speedMax") * kmph_to_meps;
-    m->gravity = param.get_float(pref + "gravity");
+    m->no_accel_time = param.no_accel_time;
+    m->accel = param.accel;
+    m->speed_init = param.speed_init;
+    m->max_speed = param.speed_max;
+    m->gravity = param.gravity;
 
-    m->rot_max = param.get_float(pref + "rotAngMax") * ang_to_rad;
-    m->rot_max_hi = param.get_float(pref + "rotAngMaxHi") * ang_to_rad;
-    m->rot_max_low = param.get_float(pref + "rotAngMaxLow") * ang_to_rad;
+    m->rot_max = param.rot_max;
+    m->rot_max_hi = param.rot_max_hi;
+    m->rot_max_low = param.rot_max_low;
 
     if (add_to_world)
         m_missiles.push_back(m);
@@ -196,9 +210,7 @@ missile_ptr world::add_missile(const char *name, bool add_to_world)
 bomb_ptr world::add_bomb(const char *name, bool add_to_world)
 {
     auto b = std::make_shared<bomb>();
-    const std::string pref = "." + std::string(name) + ".action.";
-    auto &param = get_arms_param();
-    b->gravity = param.get_float(pref + "gravity");
+    b->gravity = params::arms_params::get(name).gravity;
 
     if (add_to_world)
         m_bombs.push_back(b);
@@ -220,18 +232,19 @@ bool world::spawn_bullet(const char *type, const vec3 &pos, const vec3 &dir, vec
 
     const auto to = pos + to_dir;
 
-    static std::vector<int> insts;
+    const auto &l = *m_location;
+    static thread_local std::vector<int> insts;
     float result = 1.0f, min_result = 1.0f;
     bool hit = false;
     nya_math::aabb box(nya_math::vec3::min(pos,to), nya_math::vec3::max(pos,to));
-    if (m_qtree.get_objects(box, insts))
+    if (l.index.get_objects(box, insts))
     {
         for (auto &i:insts)
         {
-            const auto &mi = m_instances[i];
+            const auto &mi = l.instances[i];
 
             const auto lpt = mi.transform_inv(to), lpf = mi.transform_inv(pos);
-            auto &m = m_meshes[mi.mesh_idx];
+            auto &m = l.meshes[mi.mesh_idx];
             //if (!m.bbox.test_intersect(lpt)) //ToDo: trace bbox
             //    continue;
 
@@ -260,10 +273,25 @@ bool world::spawn_bullet(const char *type, const vec3 &pos, const vec3 &dir, vec
 
 void world::update_planes(int dt, const hit_hunction &on_hit)
 {
+    const auto &l = *m_location;
     m_planes.erase(std::remove_if(m_planes.begin(), m_planes.end(), [](const plane_ptr &p){ return p.unique(); }), m_planes.end());
     for (auto &p: m_planes)
     {
-        p->update(dt);
+        if (p->update_interval > 0 && p->skipped_time + dt < p->update_interval)
+        {
+            p->pos += p->vel * (dt * 0.001f); //no flight model and no collisions
+            p->skipped_time += dt;
+            continue;
+        }
+
+        if (p->skipped_time > 0)
+        {
+            p->pos -= p->vel * (p->skipped_time * 0.001f);
+            p->update(p->skipped_time + dt);
+            p->skipped_time = 0;
+        }
+        else
+            p->update(dt);
 
         const auto pt = p->pos + p->vel * (dt * 0.001f);
         const auto pt_nose = pt + p->rot.rotate(p->nose_offset);
@@ -282,13 +310,13 @@ void world::update_planes(int dt, const hit_hunction &on_hit)
         bool hit = pt.y < get_height(pt.x, pt.z, false) + 5.0f;
         if (!hit)
         {
-            static std::vector<int> insts;
-            if (m_qtree.get_objects(box, insts))
+            static thread_local std::vector<int> insts;
+            if (l.index.get_objects(box, insts))
             {
                 for (auto &i:insts)
                 {
-                    const auto &mi = m_instances[i];
-                    const auto &m = m_meshes[mi.mesh_idx];
+                    const auto &mi = l.instances[i];
+                    const auto &m = l.meshes[mi.mesh_idx];
 
                     /*
                     box.origin = mi.transform_inv(pt);
@@ -330,10 +358,10 @@ void world::update_planes(int dt, const hit_hunction &on_hit)
         test.origin = p->pos;
         test.delta.set(10, 10, 10);
 
-        //m_qtree.get_objects(p->pos, insts);
-        m_qtree.get_objects(test, insts);
+        //l.index.get_objects(p->pos, insts);
+        l.index.get_objects(test, insts);
         for (auto &i: insts)
-            get_debug_draw().add_aabb(m_instances[i].bbox);
+            get_debug_draw().add_aabb(l.instances[i].bbox);
 */
     }
 }
@@ -342,6 +370,7 @@ void world::update_planes(int dt, const hit_hunction &on_hit)
 
 template<typename t> void world::update_projectiles(int dt, std::vector<t> &objects, const hit_hunction &on_hit)
 {
+    const auto &l = *m_location;
     objects.erase(std::remove_if(objects.begin(), objects.end(), [](const t &o){ return o.unique(); }), objects.end());
     for (auto &o: objects)
     {
@@ -352,15 +381,15 @@ template<typename t> void world::update_projectiles(int dt, std::vector<t> &obje
         bool hit = pt.y < get_height(pt.x, pt.z, false) + 1.0f;
         if (!hit)
         {
-            static std::vector<int> insts;
-            if (m_qtree.get_objects(pt, insts))
+            static thread_local std::vector<int> insts;
+            if (l.index.get_objects(pt, insts))
             {
                 for (auto &i:insts)
                 {
-                    const auto &mi = m_instances[i];
+                    const auto &mi = l.instances[i];
 
                     auto lpt = mi.transform_inv(pt), lpf = mi.transform_inv(o->pos);
-                    auto &m = m_meshes[mi.mesh_idx];
+                    auto &m = l.meshes[mi.mesh_idx];
                     if (!m.bbox.test_intersect(lpt))
                         continue;
 
@@ -417,39 +446,40 @@ void world::update_bullets(int dt)
 
 float world::get_height(float x, float z, bool include_objects) const
 {
-    if (m_heights.empty())
+    const auto &l = *m_location;
+    if (l.heights.empty())
         return 0.0f;
 
-    const int hpatch_size = m_height_quad_size / m_height_subquads_per_quad;
+    const int hpatch_size = l.height_quad_size / l.height_subquads_per_quad;
 
-    const int base = location_size/2 * m_height_quad_size * m_height_quad_frags;
+    const int base = location::size/2 * l.height_quad_size * l.height_quad_frags;
 
     const int idx_x = int(x + base) / hpatch_size;
     const int idx_z = int(z + base) / hpatch_size;
 
-    if (idx_x < 0 || idx_x + 1 >= location_size * m_height_quad_frags * m_height_subquads_per_quad)
+    if (idx_x < 0 || idx_x + 1 >= location::size * l.height_quad_frags * l.height_subquads_per_quad)
         return 0.0f;
 
-    if (idx_z < 0 || idx_z + 1 >= location_size * m_height_quad_frags * m_height_subquads_per_quad)
+    if (idx_z < 0 || idx_z + 1 >= location::size * l.height_quad_frags * l.height_subquads_per_quad)
         return 0.0f;
 
-    const int pidx_x = idx_x / (m_height_quad_frags * m_height_subquads_per_quad);
-    const int pidx_z = idx_z / (m_height_quad_frags * m_height_subquads_per_quad);
-    const int hpw = m_height_quad_frags * m_height_subquads_per_quad + 1;
-    const int h_idx = m_height_patches[pidx_z * location_size + pidx_x] * hpw * hpw;
+    const int pidx_x = idx_x / (l.height_quad_frags * l.height_subquads_per_quad);
+    const int pidx_z = idx_z / (l.height_quad_frags * l.height_subquads_per_quad);
+    const int hpw = l.height_quad_frags * l.height_subquads_per_quad + 1;
+    const int h_idx = l.height_patches[pidx_z * location::size + pidx_x] * hpw * hpw;
 
-    const int qidx_x = idx_x / m_height_subquads_per_quad - pidx_x * m_height_quad_frags;
-    const int qidx_z = idx_z / m_height_subquads_per_quad - pidx_z * m_height_quad_frags;
+    const int qidx_x = idx_x / l.height_subquads_per_quad - pidx_x * l.height_quad_frags;
+    const int qidx_z = idx_z / l.height_subquads_per_quad - pidx_z * l.height_quad_frags;
 
-    const float *h = &m_heights[h_idx + (qidx_x + qidx_z * hpw) * m_height_subquads_per_quad];
+    const float *h = &l.heights[h_idx + (qidx_x + qidx_z * hpw) * l.height_subquads_per_quad];
 
-    const int hidx_x = idx_x % m_height_subquads_per_quad;
-    const int hidx_z = idx_z % m_height_subquads_per_quad;
+    const int hidx_x = idx_x % l.height_subquads_per_quad;
+    const int hidx_z = idx_z % l.height_subquads_per_quad;
 
     const float kx = (x + base) / hpatch_size - idx_x;
     const float kz = (z + base) / hpatch_size - idx_z;
 
-    const unsigned int hhpw = m_height_quad_frags * m_height_subquads_per_quad + 1;
+    const unsigned int hhpw = l.height_quad_frags * l.height_subquads_per_quad + 1;
 
     const float h00 = h[hidx_x + hidx_z * hhpw];
     const float h10 = h[hidx_x + 1 + hidx_z * hhpw];
@@ -466,14 +496,14 @@ float world::get_height(float x, float z, bool include_objects) const
 
     const float max_height = 16000.0f;
     vec3 pos(x, max_height, z), to(x, 0.0f, z);
-    static std::vector<int> insts;
-    if (m_qtree.get_objects((int)x, (int)z, insts))
+    static thread_local std::vector<int> insts;
+    if (l.index.get_objects(x, z, insts))
     {
         for (auto &i:insts)
         {
-            const auto &mi = m_instances[i];
+            const auto &mi = l.instances[i];
             const auto lpt = mi.transform_inv(to), lpf = mi.transform_inv(pos);
-            auto &m = m_meshes[mi.mesh_idx];
+            auto &m = l.meshes[mi.mesh_idx];
 
             float h;
             if(!m.trace(lpf, lpt, h))
@@ -494,6 +524,7 @@ void plane::reset_state()
 {
     thrust_time = 0.0;
     rot_speed = vec3();
+    skipped_time = 0;
     vel = rot.rotate(vec3::forward()) * params.move.speed.speedCruising * kmph_to_meps;
 }
 
@@ -696,14 +727,14 @@ void bomb::update(int dt)
 
 //------------------------------------------------------------
 
-vec3 world::instance::transform(const vec3 &v) const
+vec3 world::location::instance::transform(const vec3 &v) const
 {
     return vec3(yaw_c*v.x+yaw_s*v.z, v.y, yaw_c*v.z-yaw_s*v.x) + pos;
 }
 
 //------------------------------------------------------------
 
-vec3 world::instance::transform_inv(const vec3 &v) const
+vec3 world::location::instance::transform_inv(const vec3 &v) const
 {
     vec3 r = v - pos;
     r.set(yaw_c*r.x-yaw_s*r.z, r.y, yaw_s*r.x+yaw_c*r.z);
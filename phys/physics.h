@@ -6,8 +6,8 @@
 
 #include "plane_params.h"
 #include "math/quaternion.h"
-#include "math/quadtree.h"
 #include "mesh.h"
+#include "collision.h"
 #include <functional>
 #include <vector>
 #include <memory>
@@ -62,6 +62,9 @@ struct plane: public object
     plane_params params;
     //col_mesh mesh;
 
+    int update_interval = 0; //ms, coarse tick rate for far bots, moves straight between updates
+    int skipped_time = 0;
+
     void reset_state();
     void update(int dt);
 
@@ -135,6 +138,11 @@ public:
 
     float get_height(float x, float z, bool include_objects) const;
 
+    //location spans from -half_size to half_size on x and z
+    float get_location_half_size() const { return float(location::size / 2 * m_location->height_quad_size * m_location->height_quad_frags); }
+
+    world(): m_location(std::make_shared<location>()) {}
+
 private:
     template<typename t> void update_projectiles(int dt, std::vector<t> &objects, const hit_hunction &on_hit);
 
@@ -144,29 +152,40 @@ private:
     std::vector<bomb_ptr> m_bombs;
     std::vector<bullet> m_bullets;
 
-    const static unsigned int location_size = 16;
-    unsigned char m_height_patches[location_size * location_size];
-    std::vector<float> m_heights;
-    int m_height_quad_size = 0;
-    int m_height_quad_frags = 0;
-    int m_height_subquads_per_quad = 0;
-
-    std::vector<mesh> m_meshes;
-
-    struct instance
+    //heights and collision, read only after loading and shared between worlds
+    struct location
     {
-        int mesh_idx = -1;
-        vec3 pos;
-        float yaw_s, yaw_c = 0.0f;
-        nya_math::aabb bbox;
-
-    public:
-        vec3 transform(const vec3 &v) const;
-        vec3 transform_inv(const vec3 &v) const;
+        const static unsigned int size = 16;
+        unsigned char height_patches[size * size];
+        std::vector<float> heights;
+        int height_quad_size = 1024;
+        int height_quad_frags = 8;
+        int height_subquads_per_quad = 8;
+
+        std::vector<mesh> meshes;
+
+        struct instance
+        {
+            int mesh_idx = -1;
+            vec3 pos;
+            float yaw_s, yaw_c = 0.0f;
+            nya_math::aabb bbox;
+
+        public:
+            vec3 transform(const vec3 &v) const;
+            vec3 transform_inv(const vec3 &v) const;
+        };
+
+        std::vector<instance> instances;
+        collision::grid index;
+
+        void load(const char *name);
+        void set_collision(const collision &c);
     };
 
-    std::vector<instance> m_instances;
-    nya_math::quadtree m_qtree;
+    static std::shared_ptr<const location> get_location(const char *name);
+
+    std::shared_ptr<const location> m_location;
 };
 
 //------------------------------------------------------------
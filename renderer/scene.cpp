@@ -7,6 +7,8 @@
 #include "scene/camera.h"
 #include "util/location.h"
 #include "renderer/texture.h"
+#include "system/system.h"
+#include "util/profiler.h"
 #include <algorithm>
 
 namespace renderer
@@ -156,6 +158,8 @@ void scene::set_location(const char *name)
 
 void scene::update(int dt)
 {
+    profile_scope("scene update");
+
     if (dt > 50)
         dt = 50;
 
@@ -184,16 +188,11 @@ void scene::update(int dt)
             camera.set_ignore_delta_pos(true);
             camera.set_ignore_delta_rot(true);
             camera.set_fixed_dist(50.0f);
-            camera.set_pos(m_player_aircraft->get_pos());
         }
         else
-        {
-            const bool is_camera_third = m_player_aircraft->get_camera_mode() == aircraft::camera_mode_third;
-            camera.set_ignore_delta_pos(!is_camera_third);
-            camera.set_pos(m_player_aircraft->get_bone_pos(is_camera_third ? "camp" : "ckpp"));
-        }
+            camera.set_ignore_delta_pos(m_player_aircraft->get_camera_mode() != aircraft::camera_mode_third);
 
-        camera.set_rot(m_player_aircraft->get_rot());
+        update_camera();
 
         set_shader_param("damage_frame_color", nya_math::vec4(1.0, 0.0, 0.0235, m_player_aircraft->get_damage()));
         if (m_was_dead && !is_dead)
@@ -221,15 +220,21 @@ void scene::update(int dt)
         m_help_time -= dt;
 
     hud.update(dt);
+}
 
-    m_frame_counter_time += dt;
-    ++m_frame_counter;
-    if (m_frame_counter_time > 1000)
-    {
-        m_fps = m_frame_counter;
-        m_frame_counter = 0;
-        m_frame_counter_time -= 1000;
-    }
+//------------------------------------------------------------
+
+void scene::update_camera()
+{
+    if (!m_player_aircraft.is_valid())
+        return;
+
+    if (m_player_aircraft->is_dead())
+        camera.set_pos(m_player_aircraft->get_pos());
+    else
+        camera.set_pos(m_player_aircraft->get_bone_pos(m_player_aircraft->get_camera_mode() == aircraft::camera_mode_third ? "camp" : "ckpp"));
+
+    camera.set_rot(m_player_aircraft->get_rot());
 }
 
 //------------------------------------------------------------
@@ -257,9 +262,23 @@ void scene::resize(unsigned int width,unsigned int height)
 
 void scene::draw()
 {
+    profile_scope("scene draw");
+
+    const unsigned long time = nya_system::get_time();
+    ++m_frame_counter;
+    if (time - m_frame_counter_time > 1000)
+    {
+        m_fps = m_frame_counter;
+        m_frame_counter = 0;
+        m_frame_counter_time = time;
+    }
+
     m_location.update_tree_texture();
 
-    nya_scene::postprocess::draw(0);
+    {
+        profile_scope("postprocess");
+        nya_scene::postprocess::draw(0);
+    }
 
     const auto white = nya_math::vec4(1.0, 1.0, 1.0, 1.0);
 
@@ -270,6 +289,9 @@ void scene::draw()
     swprintf(buf, sizeof(buf), L"FPS: %d", m_fps);
     m_ui_fonts.draw_text(ui_render, buf, "NowGE20", ui_render.get_width() - 90, 0, white);
 
+    if (profiler::is_enabled())
+        draw_profiler();
+
     if (m_loading)
     {
         m_loading = false;
@@ -285,8 +307,32 @@ void scene::draw()
 
 //------------------------------------------------------------
 
+void scene::draw_profiler()
+{
+    const int top_count = 12;
+    static std::vector<profiler::scope_stats> top;
+    profiler::get_top(top_count, 1000000, top);
+
+    const auto color = nya_math::vec4(1.0, 1.0, 0.5, 1.0);
+    const int frames = m_fps > 0 ? m_fps : 1;
+    int y = 20;
+    for (auto &s: top)
+    {
+        const std::string name(s.name);
+        wchar_t buf[255];
+        swprintf(buf, sizeof(buf) / sizeof(buf[0]), L"%ls %.2fms max %.2fms x%u", std::wstring(name.begin(), name.end()).c_str(),
+                 s.total_us / 1000.0f / frames, s.max_us / 1000.0f, s.calls / frames);
+        m_ui_fonts.draw_text(ui_render, buf, "NowGE20", 10, y, color);
+        y += 20;
+    }
+}
+
+//------------------------------------------------------------
+
 void scene::draw_scene(const char *pass,const nya_scene::tags &t)
 {
+    profile_scope_dynamic(pass);
+
     camera.set_near_far(1.0, 21000.0);
 
     if (t.has("location"))
@@ -44,7 +44,8 @@ private:
     nya_scene::camera_proxy m_shadow_camera;
 
 private:
-    int m_frame_counter, m_frame_counter_time, m_fps;
+    int m_frame_counter, m_fps;
+    unsigned long m_frame_counter_time;
 
 public:
     scene(): m_fade_time(0), m_fade_max_time(0), m_help_time(3000), m_frame_counter(0), m_frame_counter_time(0), m_fps(0), m_paused(false), m_loading(false),
@@ -54,6 +55,7 @@ public:
     void switch_camera();
     void resize(unsigned int width,unsigned int height);
     void update(int dt);
+    void update_camera();
     void draw();
     void pause(bool paused) { m_paused = paused; }
     void loading(bool loading) { m_loading = loading; }
@@ -67,6 +69,7 @@ private:
     aircraft_ptr add_aircraft(const char *name, int color, bool player);
     void set_location(const char *name);
     void draw_scene(const char *pass,const nya_scene::tags &t) override;
+    void draw_profiler();
     void setup_shadow_camera(aircraft_ptr a);
 };
 
@@ -8,6 +8,7 @@
 #include "containers/dpl.h"
 #include "render/screen_quad.h"
 #include "util/location.h"
+#include "util/profiler.h"
 #include <algorithm>
 
 namespace renderer
@@ -36,6 +37,8 @@ object_ptr world::add_object(const model &mdl)
 
 aircraft_ptr world::add_aircraft(const char *name, int color, bool player)
 {
+    profile_scope("load aircraft");
+
     aircraft_ptr a(true);
     a->load(name, color, m_location.get_params(), player);
     a->apply_location(m_location.get_ibl(), m_location.get_env(), m_location.get_params());
@@ -77,6 +80,8 @@ void world::spawn_explosion(const nya_math::vec3 &pos,float radius)
 
 void world::set_location(const char *name)
 {
+    profile_scope("load location");
+
     m_location = location();
     m_clouds = effect_clouds();
 
@@ -102,6 +107,8 @@ void world::set_location(const char *name)
 
 void world::update(int dt)
 {
+    profile_scope("render world update");
+
     m_location.update(dt);
 
     if (m_player_aircraft.get_ref_count() == 2)
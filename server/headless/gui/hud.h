@@ -0,0 +1,100 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+//headless stand-in for gui/hud.h, dedicated server has no player to show it to
+
+#include "math/vector.h"
+#include <string>
+
+namespace gui
+{
+//------------------------------------------------------------
+
+class hud
+{
+public:
+    void load(const char *aircraft_name, const char *location_name) {}
+    void update(int dt) {}
+
+    void set_location(const char *location_name) {}
+    void set_hide(bool value) {}
+    void set_project_pos(const nya_math::vec3 &pos) {}
+    void set_pos(const nya_math::vec3 &pos) {}
+    void set_angles(float pitch, float yaw, float roll) {}
+    void set_speed(int value) {}
+    void set_ab(bool value) {}
+    void set_pitch_ladder(bool visible) {}
+    void set_alt(int value) {}
+    void set_missiles(const char *id, int icon) {}
+    void set_missiles_count(int count) {}
+    void set_missile_reload(int idx, float value) {}
+    void set_locks(int count, int icon) {}
+    void set_lock(int idx, bool locked, bool active) {}
+    void set_mgun(bool visible) {}
+    void set_saam_circle(bool visible, float angle) {}
+    void set_saam(bool locked, bool tracking) {}
+    void set_mgp(bool active) {}
+    void set_jammed(bool active) {}
+    void set_target_arrow(bool visible, const nya_math::vec3 &dir = nya_math::vec3()) {}
+    void change_radar() {}
+
+    void clear_zones() {}
+    void add_zone(nya_math::vec3 pos) {}
+
+    bool is_special_selected() const { return false; }
+
+    void clear_scores() {}
+    void set_team_score(int allies, int enemies) {}
+    void set_score(int line, int place, const std::wstring &name, const std::wstring &value) {}
+    void remove_score(int line) {}
+
+    void clear_alerts() {}
+    void add_alert(float v) {}
+
+public:
+    enum color { white, green, red, blue }; //values are unused without rendering
+
+public:
+    enum target_type
+    {
+        target_air,
+        target_air_lock,
+        target_air_ally,
+        target_ground,
+        target_ground_lock,
+        target_ground_ally,
+        target_missile
+    };
+
+    enum select_type
+    {
+        select_not,
+        select_current,
+        select_next
+    };
+
+    void clear_targets() {}
+    void add_target(const nya_math::vec3 &pos, float yaw, target_type target, select_type select) {}
+    void add_target(const std::wstring &name, const std::wstring &player_name, const nya_math::vec3 &pos, float yaw, target_type target, select_type select, bool tgt) {}
+
+    void set_bomb_target(const nya_math::vec3 &pos, float radius, const color &c) {}
+    void clear_bomb_marks() {}
+    void add_bomb_mark(const nya_math::vec3 &pos, float radius, const color &c) {}
+
+    void clear_ecm() {}
+    void add_ecm(const nya_math::vec3 &pos) {}
+
+    void clear_texts() {}
+    void add_text(int idx, const std::wstring &text, const std::string &font, int x, int y, const color &c) {}
+
+    enum { popup_priority_mission_result = 200 };
+    void popup(const std::wstring &text, int priority, const color &c = green, int time = 2000) {}
+
+    void set_radio(std::wstring name, std::wstring message, int time, const color &c = white) {}
+};
+
+//------------------------------------------------------------
+}
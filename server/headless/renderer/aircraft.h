@@ -0,0 +1,112 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+//headless stand-in for renderer/aircraft.h
+//no skeleton on the dedicated server: bays are always ready and weapons launch from the plane origin
+
+#include "model.h"
+#include <string>
+
+namespace renderer
+{
+//------------------------------------------------------------
+
+class aircraft
+{
+public:
+    bool load(const char *name, unsigned int color_idx, const location_params &params, bool player) { return name && name[0]; }
+    void load_missile(const char *name, const location_params &params) { m_missile.load(name, params); }
+    void load_special(const char *name, const location_params &params) { m_special.load(name, params); }
+    int get_lods_count() const { return 0; }
+    void update(int dt) {}
+    void set_hide(bool value) { m_hide = value; }
+    bool is_visible() const { return !m_hide; }
+
+    void set_pos(const nya_math::vec3 &pos) { m_pos = pos; }
+    void set_rot(const nya_math::quat &rot) { m_rot = rot; }
+    const nya_math::vec3 &get_pos() { return m_pos; }
+    nya_math::quat get_rot() { return m_rot; }
+    nya_math::vec3 get_bone_pos(const char *name) { return nya_math::vec3(); }
+    nya_math::vec3 get_wing_offset() { return nya_math::vec3(); }
+
+    void set_damage(float value) { m_damage = value; }
+    float get_damage() const { return m_damage; }
+    void set_dead(bool dead) { m_dead = dead; }
+    bool is_dead() const { return m_dead; }
+
+    //aircraft animations
+    void set_elev(float left, float right) {}
+    void set_rudder(float left, float right, float center) {}
+    void set_aileron(float left, float right) {}
+    void set_flaperon(float value) {}
+    void set_canard(float value) {}
+    void set_brake(float value) {}
+    void set_wing_sweep(float value) {}
+    void set_intake_ramp(float value) {}
+    void set_thrust(float value) {}
+    void set_special_bay(bool value) {}
+    void set_missile_bay(bool value) {}
+    void set_mgun_bay(bool value) {}
+    void set_mgun_fire(bool value) {}
+    void set_mgp_fire(bool value) {}
+
+    //weapons
+    bool has_special_bay() { return false; }
+    bool is_special_bay_opened() { return true; }
+    bool is_special_bay_closed() { return true; }
+    bool is_missile_ready() { return true; }
+    bool is_mgun_ready() { return true; }
+    int get_missile_mount_count() { return mounts_count; }
+    nya_math::vec3 get_missile_mount_pos(int idx) { return m_pos; }
+    nya_math::quat get_missile_mount_rot(int idx) { return m_rot; }
+    void set_missile_visible(int idx, bool visible) {}
+    int get_special_mount_count() { return mounts_count; }
+    nya_math::vec3 get_special_mount_pos(int idx) { return m_pos; }
+    nya_math::quat get_special_mount_rot(int idx) { return m_rot; }
+    void set_special_visible(int idx, bool visible) {}
+    int get_mguns_count() const { return 1; }
+    nya_math::vec3 get_mgun_pos(int idx) { return m_pos; }
+
+    //weapon models
+    const renderer::model &get_missile_model() { return m_missile; }
+    const renderer::model &get_special_model() { return m_special; }
+
+    //cockpit
+    void set_time(unsigned int time) {}
+    void set_speed(float speed) {}
+    void set_aoa(float aoa) {}
+
+    //camera
+    enum camera_mode
+    {
+        camera_mode_third,
+        camera_mode_cockpit,
+        camera_mode_first,
+    };
+    camera_mode get_camera_mode() const { return m_camera_mode; }
+    void set_camera_mode(camera_mode mode) { m_camera_mode = mode; }
+
+    //info
+    static unsigned int get_colors_count(const char *plane_name) { return 1; }
+    static std::string get_color_name(const char *plane_name, int idx) { return ""; }
+    static std::string get_sound_name(const char *plane_name) { return ""; }
+    static std::string get_voice_name(const char *plane_name) { return ""; }
+
+private:
+    enum { mounts_count = 2 };
+
+    nya_math::vec3 m_pos;
+    nya_math::quat m_rot;
+    bool m_hide = false;
+    bool m_dead = false;
+    float m_damage = 0.0f;
+    camera_mode m_camera_mode = camera_mode_third;
+    model m_missile;
+    model m_special;
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,54 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+//headless stand-in for renderer/model.h, dedicated server has no meshes
+
+#include "renderer/location_params.h"
+#include "math/quaternion.h"
+
+namespace renderer
+{
+//------------------------------------------------------------
+
+class model
+{
+public:
+    bool load(const char *name, const location_params &params) { return name && name[0]; }
+    void draw(int lod_idx) {}
+    int get_lods_count() const { return 0; }
+    void update(int dt) {}
+
+    void set_pos(const nya_math::vec3 &pos) { m_pos = pos; }
+    void set_rot(const nya_math::quat &rot) { m_rot = rot; }
+    const nya_math::vec3 &get_pos() const { return m_pos; }
+    const nya_math::quat &get_rot() const { return m_rot; }
+
+public:
+    void set_relative_anim_time(int lod_idx, unsigned int anim_hash_id, float time) {}
+    void set_anim_speed(int lod_idx, unsigned int anim_hash_id, float speed) {}
+    float get_relative_anim_time(int lod_idx, unsigned int anim_hash_id) { return 0.0f; }
+    void set_anim_weight(int lod_idx, unsigned int anim_hash_id, float weight) {}
+    bool has_anim(int lod_idx, unsigned int anim_hash_id) { return false; }
+
+    int get_bones_count(int lod_idx) { return 0; }
+    const char *get_bone_name(int lod_idx, int bone_idx) { return 0; }
+    int get_bone_idx(int lod_idx, const char *name) { return -1; }
+    int find_bone_idx(int lod_idx, const char *name_part) { return -1; }
+    nya_math::vec3 get_bone_pos(int lod_idx, int bone_idx) { return m_pos; }
+    nya_math::quat get_bone_rot(int lod_idx, int bone_idx) { return m_rot; }
+    void set_bone_rot(int lod_idx, int bone_idx, const nya_math::quat &rot) {}
+
+public:
+    model() {}
+    model(const char *name, const location_params &params) { load(name, params); }
+
+private:
+    nya_math::vec3 m_pos;
+    nya_math::quat m_rot;
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,23 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+//headless stand-in for renderer/scene.h
+
+#include "world.h"
+#include "gui/hud.h"
+
+namespace renderer
+{
+//------------------------------------------------------------
+
+class scene: public world
+{
+public:
+    gui::hud hud;
+};
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,112 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+//headless stand-in for renderer/world.h
+//objects only keep their transforms, nothing is loaded or drawn
+
+#include "aircraft.h"
+#include "util/params.h"
+#include "memory/shared_ptr.h"
+#include "model.h"
+#include <vector>
+
+namespace renderer
+{
+//------------------------------------------------------------
+
+typedef nya_math::vec3 vec3;
+typedef nya_math::quat quat;
+typedef params::fvalue fvalue;
+typedef params::value<bool> bvalue;
+
+//------------------------------------------------------------
+
+template<typename t> class ptr: public nya_memory::shared_ptr<t>
+{
+    friend class world;
+
+public:
+    ptr(): nya_memory::shared_ptr<t>() {}
+    ptr(const ptr &p): nya_memory::shared_ptr<t>(p) {}
+
+private:
+    explicit ptr(bool): nya_memory::shared_ptr<t>(t()) {}
+};
+
+//------------------------------------------------------------
+
+struct object
+{
+    bool visible = true;
+    model mdl;
+};
+
+typedef ptr<object> object_ptr;
+
+//------------------------------------------------------------
+
+typedef ptr<aircraft> aircraft_ptr;
+
+//------------------------------------------------------------
+
+struct missile: public object
+{
+    bvalue engine_started;
+    void update(int dt) {}
+};
+
+typedef ptr<missile> missile_ptr;
+
+//------------------------------------------------------------
+
+class bullets
+{
+public:
+    void clear() {}
+    void add_bullet(const nya_math::vec3 &pos, const nya_math::vec3 &vel) {}
+};
+
+//------------------------------------------------------------
+
+class world
+{
+public:
+    virtual void set_location(const char *name) { m_location_name = name ? name : ""; m_player_aircraft = aircraft_ptr(); }
+    const location_params &get_location_params() { return m_location_params; }
+    const char *get_location_name() { return m_location_name.c_str(); }
+
+    object_ptr add_object(const char *name) { object_ptr o(true); o->mdl.load(name, m_location_params); return o; }
+    object_ptr add_object(const model &m) { object_ptr o(true); o->mdl = m; return o; }
+
+    virtual aircraft_ptr add_aircraft(const char *name, int color, bool player)
+    {
+        aircraft_ptr a(true);
+        a->load(name, color, m_location_params, player);
+        if (player)
+            m_player_aircraft = a;
+        return a;
+    }
+
+    aircraft_ptr get_player_aircraft() { return m_player_aircraft; }
+
+    missile_ptr add_missile(const char *name) { missile_ptr m(true); m->mdl.load(name, m_location_params); return m; }
+    missile_ptr add_missile(const model &m) { missile_ptr r(true); r->mdl = m; return r; }
+
+    bullets &get_bullets() { return m_bullets; }
+
+    void spawn_explosion(const nya_math::vec3 &pos, float radius) {}
+
+    virtual void update(int dt) {}
+
+protected:
+    bullets m_bullets;
+    std::string m_location_name;
+    location_params m_location_params;
+    aircraft_ptr m_player_aircraft;
+};
+
+//------------------------------------------------------------
+}
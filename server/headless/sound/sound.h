@@ -0,0 +1,96 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+//headless stand-in for sound/sound.h, nothing is decoded or played
+
+#include "sound/file.h"
+#include "math/vector.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace sound
+{
+//------------------------------------------------------------
+
+typedef nya_math::vec3 vec3;
+
+//------------------------------------------------------------
+
+struct source
+{
+    vec3 pos;
+    vec3 vel;
+    float pitch = 1.0f;
+    float volume = 1.0f;
+};
+
+typedef std::shared_ptr<source> source_ptr;
+
+//------------------------------------------------------------
+
+class world_2d
+{
+public:
+    void set_music(const file &f) {}
+    void set_music(const std::string &name) {}
+    void stop_music() {}
+    void stop_sounds() {}
+
+    void set_music_volume(float volume) {}
+
+    unsigned int play_ui(file &f, float volume = 1.0f, bool loop = false) { return 0; }
+    void stop_ui(unsigned int id) {}
+
+    void update(int dt) {}
+};
+
+//------------------------------------------------------------
+
+class world: public world_2d
+{
+public:
+    source_ptr add(file &f, bool loop) { return std::make_shared<source>(); }
+    void play(file &f, vec3 pos, float volume = 1.0f) {}
+
+    void set_volume(float volume) {}
+
+    void update(int dt) {}
+
+    void stop_sounds() {}
+};
+
+//------------------------------------------------------------
+
+inline bool cache(file &f) { return false; }
+
+//------------------------------------------------------------
+
+inline void release_context() {}
+
+//------------------------------------------------------------
+
+struct pack
+{
+    std::vector<sound::file> waves;
+
+    struct cue
+    {
+        std::string name;
+        std::vector<uint16_t> wave_ids;
+    };
+
+    std::vector<cue> cues;
+
+    bool has(const std::string &name) { return false; }
+    file &get(const std::string &name, int idx = 0) { static file empty; return empty; }
+
+    bool load(const std::string &name) { return false; }
+};
+
+//------------------------------------------------------------
+}
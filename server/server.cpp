@@ -0,0 +1,752 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+//dedicated server, no window, renderer or sound
+//renderer, sound and hud headers are replaced with the ones from server/headless
+
+#include "game/deathmatch.h"
+#include "game/team_deathmatch.h"
+#include "game/network.h"
+#include "game/network_server.h"
+#include "game/network_client.h"
+#include "game/network_helpers.h"
+#include "game/replay.h"
+#include "game/world.h"
+#include "game/fixed_step.h"
+#include "game/match_pool.h"
+
+#include "util/resources.h"
+#include "util/config.h"
+
+#include "system/system.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------
+
+namespace
+{
+
+std::atomic<bool> quit_flag(false);
+void on_quit_signal(int) { quit_flag = true; }
+
+//each load bot is a full client with a network thread and three sockets, a local server
+//adds one more socket per client, so stay well below FD_SETSIZE (1024 on posix)
+const int max_load_clients = 250;
+
+struct server_params
+{
+    std::string name = "OPEN HORIZON";
+    std::string location = "ms01";
+    std::string mode = "dm";
+    int port = 8001;
+    int matches = 1; //on consecutive ports
+    int max_players = 8;
+    int bots = 0;
+    int tick_rate = 60;
+    bool is_public = false;
+    int stats_interval = 0;
+    std::string net_stats_replay;
+
+    int load_clients = 0;
+    int load_step = 4;
+    int load_step_time = 10;
+    std::string load_host; //empty for a server in the same process
+};
+
+void print_usage()
+{
+    printf("usage: open_horizon_server [options]\n"
+           "  --name <server name>\n"
+           "  --location <location id>, default ms01\n"
+           "  --mode <dm|tdm>, default dm\n"
+           "  --port <port>, default 8001\n"
+           "  --matches <count>, independent matches on consecutive ports, default 1\n"
+           "  --max-players <count>, default 8\n"
+           "  --bots <count>, default 0\n"
+           "  --tick <hz>, default 60\n"
+           "  --public, register in the servers list\n"
+           "  --stats <seconds>, print traffic per client\n"
+           "  --net-stats <replay file>, measure state traffic of a recorded match and exit\n"
+           "  --load-test <clients>, connect synthetic clients step by step, report the load and exit\n"
+           "  --load-step <clients>, clients added each step, default 4\n"
+           "  --load-step-time <seconds>, default 10\n"
+           "  --load-host <address>, test a running server instead of one in this process\n");
+}
+
+bool parse_args(int argc, char **argv, server_params &p)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : 0;
+
+        if (strcmp(arg, "--public") == 0)
+        {
+            p.is_public = true;
+            continue;
+        }
+
+        if (!value)
+        {
+            printf("missing value for %s\n", arg);
+            return false;
+        }
+
+        ++i;
+
+        if (strcmp(arg, "--name") == 0)
+            p.name = value;
+        else if (strcmp(arg, "--location") == 0)
+            p.location = value;
+        else if (strcmp(arg, "--mode") == 0)
+            p.mode = value;
+        else if (strcmp(arg, "--port") == 0)
+            p.port = atoi(value);
+        else if (strcmp(arg, "--matches") == 0)
+            p.matches = atoi(value);
+        else if (strcmp(arg, "--max-players") == 0)
+            p.max_players = atoi(value);
+        else if (strcmp(arg, "--bots") == 0)
+            p.bots = atoi(value);
+        else if (strcmp(arg, "--tick") == 0)
+            p.tick_rate = atoi(value);
+        else if (strcmp(arg, "--stats") == 0)
+            p.stats_interval = atoi(value);
+        else if (strcmp(arg, "--net-stats") == 0)
+            p.net_stats_replay = value;
+        else if (strcmp(arg, "--load-test") == 0)
+            p.load_clients = atoi(value);
+        else if (strcmp(arg, "--load-step") == 0)
+            p.load_step = atoi(value);
+        else if (strcmp(arg, "--load-step-time") == 0)
+            p.load_step_time = atoi(value);
+        else if (strcmp(arg, "--load-host") == 0)
+            p.load_host = value;
+        else
+        {
+            printf("unknown option %s\n", arg);
+            return false;
+        }
+    }
+
+    if (p.mode != "dm" && p.mode != "tdm")
+    {
+        printf("unsupported game mode %s\n", p.mode.c_str());
+        return false;
+    }
+
+    if (p.port <= 0 || p.matches <= 0 || p.port + p.matches - 1 > 65535 || p.max_players <= 0 || p.bots < 0 || p.tick_rate <= 0 || p.stats_interval < 0
+        || p.load_clients < 0 || p.load_step <= 0 || p.load_step_time <= 0)
+    {
+        printf("invalid arguments\n");
+        return false;
+    }
+
+    if (p.load_clients > max_load_clients)
+    {
+        printf("too many load test clients, up to %d are supported\n", max_load_clients);
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------
+
+void print_stats(const game::network_server &server, std::vector<game::net_stats> &last, float seconds)
+{
+    const auto stats = server.get_stats();
+    for (auto &s: stats)
+    {
+        game::net_stats l;
+        for (auto &ls: last)
+        {
+            if (ls.client_id == s.client_id)
+                l = ls;
+        }
+
+        const float ticks = seconds * game::net_fps;
+        printf("client %u: udp %u bytes/s out, %u bytes/s in, tcp %.1f messages in %.1f frames, %.0f bytes per net tick\n",
+               s.client_id, s.sent_per_second, s.received_per_second, (s.tcp_messages_sent - l.tcp_messages_sent) / ticks,
+               (s.tcp_frames_sent - l.tcp_frames_sent) / ticks, (s.tcp_bytes_sent - l.tcp_bytes_sent) / ticks);
+    }
+
+    last = stats;
+}
+
+//------------------------------------------------------------
+
+//state traffic of one client: text messages, full binary records and quantized deltas over a lossless channel
+
+class traffic_meter: public game::network_interface
+{
+public:
+    bool is_server() const override { return true; }
+    void set_location_size(float half_size) override { m_quantizer.set_location_size(half_size); }
+
+    void update_post(int dt) override
+    {
+        m_time += dt;
+        m_general_msg_requests.clear(), m_events_requests.clear(), m_game_data_msg_requests.clear();
+
+        if (m_time - m_last_send_time < 1000 / game::net_fps)
+            return;
+        m_last_send_time = m_time;
+
+        measure(m_planes, game::net_packet::type_planes, "plane", full_plane_size);
+        measure(m_missiles, game::net_packet::type_missiles, "missile", full_missile_size);
+    }
+
+    void print() const
+    {
+        const float seconds = m_time * 0.001f;
+        if (seconds <= 0.0f || !m_delta_bytes)
+        {
+            printf("net stats: nothing was sent\n");
+            return;
+        }
+
+        printf("net stats: %.1fs, %llu records\n", seconds, (unsigned long long)m_records);
+        printf("  text:   %10llu bytes, %8.0f bytes per second\n", (unsigned long long)m_text_bytes, m_text_bytes / seconds);
+        printf("  binary: %10llu bytes, %8.0f bytes per second, %.2f times smaller than text\n",
+               (unsigned long long)m_binary_bytes, m_binary_bytes / seconds, double(m_text_bytes) / m_binary_bytes);
+        printf("  delta:  %10llu bytes, %8.0f bytes per second, %.2f times smaller than binary\n",
+               (unsigned long long)m_delta_bytes, m_delta_bytes / seconds, double(m_binary_bytes) / m_delta_bytes);
+    }
+
+private:
+    template<typename rs> void measure(rs &objs, game::net_packet::type type, const std::string &msg, size_t full_record_size)
+    {
+        game::net_packet p;
+        p.t = type;
+        p.time = m_time;
+
+        size_t count = 0;
+        for (auto &o: objs.objects)
+        {
+            if (!o.net->source || o.net.unique())
+                continue;
+
+            m_text_bytes += (msg + " " + std::to_string(m_time) + " " + std::to_string(o.r.id) + " " + game::to_string(o.net)).size();
+
+            p.add(o.r.id, *o.net);
+            if (p.is_full())
+                send(p);
+
+            ++count;
+        }
+
+        send(p);
+
+        //fixed size records without acks or baselines
+        const size_t per_packet = (game::net_packet::max_size - full_header_size) / full_record_size;
+        m_binary_bytes += (count + per_packet - 1) / per_packet * full_header_size + count * full_record_size;
+        m_records += count;
+
+        objs.remove_src_unique();
+        objs.add_requests.clear();
+    }
+
+    void send(game::net_packet &p)
+    {
+        if (p.planes.empty() && p.missiles.empty())
+            return;
+
+        std::string data;
+        p.write(data, m_server, m_quantizer);
+        p.clear_records();
+        m_delta_bytes += data.size();
+
+        game::net_packet r;
+        if (!r.read(data, m_client, m_quantizer))
+            printf("net stats: unable to read packet\n");
+
+        game::net_packet ack;
+        ack.t = game::net_packet::type_ack;
+        ack.write(data, m_client, m_quantizer);
+        r.read(data, m_server, m_quantizer);
+    }
+
+private:
+    enum
+    {
+        full_header_size = 1 + 4 + 4 + 4 + 2,
+        full_plane_size = 4 + 4 * (3 + 3 + 4 + 3 + 1 + 1) + 1,
+        full_missile_size = 4 + 4 * (3 + 3 + 4 + 3) + 4 + 1
+    };
+
+    game::net_quantizer m_quantizer;
+    game::net_channel m_server, m_client;
+    unsigned int m_last_send_time = 0;
+    uint64_t m_records = 0, m_text_bytes = 0, m_binary_bytes = 0, m_delta_bytes = 0;
+};
+
+//------------------------------------------------------------
+
+int measure_net_stats(const char *replay_file)
+{
+    game::replay r;
+    if (!r.load(replay_file))
+        return -1;
+
+    const auto &s = r.get_session();
+    if (s.mode != "dm" && s.mode != "tdm")
+    {
+        printf("net stats: unsupported replay mode %s, only dm and tdm\n", s.mode.c_str());
+        return -1;
+    }
+
+    renderer::world render_world;
+    sound::world sound_world;
+    gui::hud hud;
+    game::world world(render_world, sound_world, hud);
+    game::deathmatch game_mode_dm(world);
+    game::team_deathmatch game_mode_tdm(world);
+    traffic_meter meter;
+
+    game::deathmatch *game_mode = s.mode == "tdm" ? &game_mode_tdm : &game_mode_dm;
+
+    world.set_network(&meter);
+    srand(s.seed);
+    world.set_seed(s.seed);
+    game_mode->start(s.plane.c_str(), s.color, 0, s.location.c_str(), s.bots_count);
+
+    game::plane_controls controls;
+    for (size_t i = 0; i < r.get_ticks_count(); ++i)
+    {
+        const int dt = r.get_tick(i, controls);
+        game_mode->update(dt, controls);
+    }
+
+    game_mode->end();
+    meter.print();
+    return 0;
+}
+
+//------------------------------------------------------------
+
+//sim time of the server ticks, read by the load test
+
+class tick_meter
+{
+public:
+    void add(float ms)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sum += ms, m_max = std::max(m_max, ms), ++m_count;
+    }
+
+    //since the previous call
+    void take(float &avg, float &max, int &count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        avg = m_count ? m_sum / m_count : 0.0f, max = m_max, count = m_count;
+        m_sum = m_max = 0.0f, m_count = 0;
+    }
+
+private:
+    std::mutex m_mutex;
+    float m_sum = 0.0f, m_max = 0.0f;
+    int m_count = 0;
+};
+
+//------------------------------------------------------------
+
+struct match
+{
+    renderer::world render_world;
+    sound::world sound_world;
+    gui::hud hud;
+    game::world world;
+    game::deathmatch game_mode_dm;
+    game::team_deathmatch game_mode_tdm;
+    game::deathmatch *game_mode = 0;
+    game::network_server server;
+    std::vector<game::net_stats> last_stats;
+
+    match(): world(render_world, sound_world, hud), game_mode_dm(world), game_mode_tdm(world) {}
+};
+
+//------------------------------------------------------------
+
+enum server_state { server_starting, server_ready, server_failed };
+
+int run_server(const server_params &params, tick_meter *ticks = 0, std::atomic<int> *state = 0)
+{
+    std::vector<std::unique_ptr<match> > matches;
+    game::match_pool pool;
+
+    auto close = [&matches, &pool]()
+    {
+        pool.set_workers(0);
+        for (auto &m: matches)
+        {
+            m->game_mode->end();
+            m->server.close();
+        }
+    };
+
+    srand((unsigned int)time(0));
+
+    for (int i = 0; i < params.matches; ++i)
+    {
+        std::unique_ptr<match> m(new match);
+        m->game_mode = params.mode == "tdm" ? &m->game_mode_tdm : &m->game_mode_dm;
+
+        const int port = params.port + i;
+        m->world.set_network(&m->server);
+        if (!m->server.open(port, params.name.c_str(), params.mode.c_str(), params.location.c_str(), params.max_players))
+        {
+            printf("unable to open server on port %d\n", port);
+            close();
+            if (state)
+                *state = server_failed;
+            return -1;
+        }
+
+        if (params.is_public)
+            game::servers_list::register_server(port);
+
+        m->world.set_seed(uint32_t(time(0)) + i);
+        m->game_mode->start(0, 0, 0, params.location.c_str(), params.bots);
+
+        printf("server %s: %s on %s, port %d, %d bots, %d hz\n", params.name.c_str(), params.mode.c_str(),
+               params.location.c_str(), port, params.bots, params.tick_rate);
+
+        pool.add(m->game_mode);
+        matches.push_back(std::move(m));
+    }
+
+    if (params.matches > 1)
+        pool.set_workers(std::max(std::min(params.matches, (int)std::thread::hardware_concurrency()), 1));
+
+    if (state)
+        *state = server_ready;
+
+    game::fixed_step sim_step;
+    sim_step.set_rate(params.tick_rate);
+    sim_step.set_max_lag(0);
+    sim_step.set_max_ticks(8); //the rest is caught up in the next loops
+
+    auto is_up = [&matches]()
+    {
+        for (auto &m: matches)
+        {
+            if (!m->server.is_up())
+                return false;
+        }
+        return true;
+    };
+
+    unsigned long last_time = nya_system::get_time(), last_stats_time = last_time;
+    while (!quit_flag && is_up())
+    {
+        const unsigned long time = nya_system::get_time();
+        sim_step.add_time(int(time - last_time));
+        last_time = time;
+
+        for (int dt = sim_step.next_tick(); dt > 0; dt = sim_step.next_tick())
+        {
+            const auto tick_start = std::chrono::steady_clock::now();
+            pool.update(dt);
+            if (ticks)
+                ticks->add(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - tick_start).count());
+        }
+
+        if (params.stats_interval > 0 && time - last_stats_time >= params.stats_interval * 1000ul)
+        {
+            for (size_t i = 0; i < matches.size(); ++i)
+            {
+                if (matches.size() > 1)
+                    printf("port %d:\n", params.port + int(i));
+                print_stats(matches[i]->server, matches[i]->last_stats, (time - last_stats_time) * 0.001f);
+            }
+            last_stats_time = time;
+        }
+
+        //sleep until the next tick
+        const int wait = int(sim_step.get_step() * (1.0f - sim_step.get_alpha()));
+        std::this_thread::sleep_for(std::chrono::milliseconds(wait > 0 ? wait : 1));
+    }
+
+    close();
+    printf("server closed\n");
+    return 0;
+}
+
+//------------------------------------------------------------
+
+//synthetic client: flies a scripted circle, fires a missile now and then
+
+class load_bot
+{
+public:
+    bool connect(const char *host, int port, int index, const std::string &preset)
+    {
+        if (!m_client.connect(host, (short)port))
+        {
+            printf("load test: client %d: %s\n", index, m_client.get_error().c_str());
+            return false;
+        }
+
+        m_index = index;
+        m_client.start();
+
+        game::network_interface &n = m_client;
+        m_plane = n.add_plane(preset, "LOAD" + std::to_string(index), 0);
+        m_up = true;
+        return true;
+    }
+
+    //returns false if the connection was lost since the last call
+    bool update(int dt)
+    {
+        if (!m_up)
+            return true;
+
+        game::network_interface &n = m_client;
+        n.update();
+
+        //remote objects are only tracked to take their states
+        game::network_interface::msg_add_plane mp;
+        while (n.get_add_plane_msg(mp))
+            n.add_plane(mp);
+
+        game::network_interface::msg_add_missile mm;
+        while (n.get_add_missile_msg(mm))
+            n.add_missile(mm);
+
+        game::network_interface::msg_game_data md;
+        while (n.get_game_data_msg(md)) {}
+
+        std::string str;
+        while (n.get_events(str)) {}
+        while (n.get_general_msg(str)) {}
+
+        m_time += dt;
+
+        const float radius = 2000.0f, speed = 200.0f, altitude = 4000.0f;
+        const float a = m_time * 0.001f * speed / radius + m_index;
+        const nya_math::vec3 center((m_index % 8 - 4) * 5000.0f, altitude, (m_index / 8 % 8 - 4) * 5000.0f);
+        m_plane->pos = center + nya_math::vec3(sinf(a), 0.0f, cosf(a)) * radius;
+        m_plane->vel = nya_math::vec3(cosf(a), 0.0f, -sinf(a)) * speed;
+        m_plane->rot = nya_math::quat(0.0f, a + nya_math::constants::pi * 0.5f, 0.0f);
+        m_plane->ctrl_throttle = 1.0f;
+
+        const int missile_interval = 5000, missile_time = 4000;
+        if (m_time >= m_next_missile)
+        {
+            m_next_missile = m_time + missile_interval;
+
+            auto m = n.add_missile(m_plane, false);
+            m->rot = m_plane->rot;
+            m->vel = m_plane->vel * 2.0f;
+            m->pos = m_plane->pos + m->vel * 0.05f;
+            m->engine_started = true;
+            m_missiles.push_back(std::make_pair(m, m_time + missile_time));
+        }
+
+        for (auto &m: m_missiles)
+            m.first->pos += m.first->vel * (dt * 0.001f);
+
+        while (!m_missiles.empty() && m_time >= m_missiles.front().second)
+            m_missiles.pop_front(); //removed on the next send
+
+        n.update_post(dt);
+
+        if (m_client.is_up())
+            return true;
+
+        m_up = false;
+        return false;
+    }
+
+    bool is_up() const { return m_up; }
+    game::network_client &get_client() { return m_client; }
+    game::net_stats last_stats;
+
+private:
+    game::network_client m_client;
+    game::net_plane_ptr m_plane;
+    std::deque<std::pair<game::net_missile_ptr, unsigned int> > m_missiles;
+    int m_index = 0;
+    unsigned int m_time = 0, m_next_missile = 0;
+    bool m_up = false;
+};
+
+//------------------------------------------------------------
+
+//adds clients step by step, prints the load of each step
+//clients are ticked on this thread, each one has its own network thread
+
+int run_load_test(const server_params &params)
+{
+    const auto presets = game::get_aircraft_ids({"fighter", "multirole"});
+    if (presets.empty())
+        return -1;
+
+    tick_meter ticks;
+    std::atomic<int> server(server_starting);
+    std::thread server_thread;
+    const bool local = params.load_host.empty();
+    if (local)
+    {
+        server_params sp = params;
+        sp.max_players = params.load_clients + 1;
+        sp.is_public = false;
+        sp.stats_interval = 0;
+        server_thread = std::thread([sp, &ticks, &server]() { run_server(sp, &ticks, &server); });
+
+        while (server == server_starting && !quit_flag)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        if (server != server_ready)
+        {
+            quit_flag = true;
+            server_thread.join();
+            return -1;
+        }
+    }
+
+    const char *host = local ? "127.0.0.1" : params.load_host.c_str();
+
+    printf("load test: up to %d clients, %d per step, %ds steps, server %s:%d\n", params.load_clients, params.load_step,
+           params.load_step_time, host, params.port);
+    printf("clients  lost | tick ms avg   max | per client bytes/s: udp out    in  tcp out    in | latency ms p50  p90  p99 | rtt ms\n");
+
+    std::vector<std::unique_ptr<load_bot> > bots;
+    int lost = 0;
+    while (!quit_flag && (int)bots.size() < params.load_clients)
+    {
+        for (int i = 0; i < params.load_step && (int)bots.size() < params.load_clients; ++i)
+        {
+            std::unique_ptr<load_bot> b(new load_bot);
+            const int index = (int)bots.size();
+            if (!b->connect(host, params.port, index, presets[index % presets.size()]))
+            {
+                ++lost;
+                continue;
+            }
+
+            b->last_stats = b->get_client().get_stats();
+            bots.push_back(std::move(b));
+        }
+
+        float tick_avg, tick_max;
+        int tick_count;
+        ticks.take(tick_avg, tick_max, tick_count);
+
+        for (auto &b: bots)
+        {
+            b->get_client().reset_latency();
+            b->last_stats = b->get_client().get_stats();
+        }
+
+        const int client_dt = 1000 / 60;
+        const unsigned long step_start = nya_system::get_time();
+        unsigned long last_time = step_start;
+        while (!quit_flag && nya_system::get_time() - step_start < params.load_step_time * 1000ul)
+        {
+            const unsigned long time = nya_system::get_time();
+            const int dt = int(time - last_time);
+            last_time = time;
+
+            for (auto &b: bots)
+            {
+                if (!b->update(dt))
+                    ++lost;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(client_dt));
+        }
+
+        const float seconds = (nya_system::get_time() - step_start) * 0.001f;
+        ticks.take(tick_avg, tick_max, tick_count);
+
+        game::net_latency latency;
+        double udp_out = 0.0, udp_in = 0.0, tcp_out = 0.0, tcp_in = 0.0, rtt = 0.0;
+        int up = 0;
+        for (auto &b: bots)
+        {
+            if (!b->is_up())
+                continue;
+
+            auto &c = b->get_client();
+            const auto s = c.get_stats();
+            const auto &l = b->last_stats;
+            udp_out += s.bytes_sent - l.bytes_sent, udp_in += s.bytes_received - l.bytes_received;
+            tcp_out += s.tcp_bytes_sent - l.tcp_bytes_sent, tcp_in += s.tcp_bytes_received - l.tcp_bytes_received;
+            rtt += s.rtt;
+            latency.merge(c.get_latency());
+            ++up;
+        }
+
+        const double k = up ? 1.0 / (up * seconds) : 0.0;
+        if (local)
+            printf("%7d %5d | %11.2f %5.2f |", up, lost, tick_avg, tick_max);
+        else
+            printf("%7d %5d |         n/a   n/a |", up, lost);
+
+        printf("%31.0f %5.0f %8.0f %5.0f |%16d %4d %4d | %6.0f\n", udp_out * k, udp_in * k, tcp_out * k, tcp_in * k,
+               latency.get_percentile(0.5f), latency.get_percentile(0.9f), latency.get_percentile(0.99f), up ? rtt / up : 0.0);
+    }
+
+    bots.clear();
+
+    quit_flag = true;
+    if (server_thread.joinable())
+        server_thread.join();
+
+    return 0;
+}
+
+}
+
+//------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    server_params params;
+    if (!parse_args(argc, argv, params))
+    {
+        print_usage();
+        return -1;
+    }
+
+    if (!setup_resources(false))
+        return -1;
+
+    config::register_var("difficulty", "hard");
+    config::register_var("ai_budget", "1000");
+    config::register_var("ai_workers", "0");
+    config::register_var("net_text_events", "false");
+    config::register_var("sim_lod_coarse_dist", "8000");
+    config::register_var("sim_lod_dormant_dist", "20000");
+    config::register_var("sim_lod_coarse_interval", "100");
+    config::register_var("sim_lod_dormant_interval", "500");
+
+    if (!params.net_stats_replay.empty())
+        return measure_net_stats(params.net_stats_replay.c_str());
+
+    signal(SIGINT, on_quit_signal);
+    signal(SIGTERM, on_quit_signal);
+
+    if (params.load_clients > 0)
+        return run_load_test(params);
+
+    return run_server(params);
+}
+
+//------------------------------------------------------------
@@ -0,0 +1,136 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "params.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <string.h>
+
+namespace params
+{
+//------------------------------------------------------------
+
+//Arms/ArmsParam.txt compiled by weapon id, speeds in m/s, times in ms, angles in radians
+
+struct arms_param
+{
+    //action
+    float no_accel_time = 0.0f;
+    float accel = 0.0f;
+    float speed_init = 0.0f;
+    float speed_max = 0.0f;
+    float gravity = 0.0f;
+    float rot_max = 0.0f;
+    float rot_max_hi = 0.0f;
+    float rot_max_low = 0.0f;
+    float end_time = 0.0f;
+    float homing_angle = 0.0f; //as is
+    float range = 0.0f;
+
+    //lockon
+    float lockon_range = 0.0f;
+    float lockon_angle = 0.0f;
+    int lockon_count = 0;
+    bool lockon_air = false;
+    bool lockon_ground = false;
+    float reload_time = 0.0f;
+    float lockon_time = 0.0f;
+};
+
+//------------------------------------------------------------
+
+class arms_params
+{
+public:
+    //no allocations, called on every launch
+    static const arms_param &get(const char *id)
+    {
+        static arms_params ap("Arms/ArmsParam.txt");
+        static const arms_param empty;
+
+        if (!id)
+            return empty;
+
+        auto p = std::lower_bound(ap.m_params.begin(), ap.m_params.end(), id, [](const entry &e, const char *id) { return strcmp(e.first.c_str(), id) < 0; });
+        return p == ap.m_params.end() || p->first != id ? empty : p->second;
+    }
+
+    static const arms_param &get(const std::string &id) { return get(id.c_str()); }
+
+private:
+    arms_params(const char *fname)
+    {
+        std::unordered_map<std::string, arms_param> params;
+        const text_params text(fname);
+        for (auto &p: text.m_float_params)
+            set(params, p.first, p.second, false);
+        for (auto &p: text.m_int_params)
+            set(params, p.first, float(p.second), true);
+
+        m_params.assign(params.begin(), params.end());
+        std::sort(m_params.begin(), m_params.end(), [](const entry &a, const entry &b) { return a.first < b.first; });
+    }
+
+    //int fields are taken only from int params and float ones only from float params, as get_int and get_float did
+    static void set(std::unordered_map<std::string, arms_param> &params, const std::string &name, float value, bool is_int)
+    {
+        //.id.section.field
+        if (name.empty() || name[0] != '.')
+            return;
+
+        const auto field_from = name.rfind('.');
+        const auto section_from = name.rfind('.', field_from - 1);
+        if (section_from == 0 || section_from == std::string::npos)
+            return;
+
+        const std::string id = name.substr(1, section_from - 1);
+        const std::string section = name.substr(section_from + 1, field_from - section_from - 1);
+        const std::string field = name.substr(field_from + 1);
+
+        static const float kmph_to_meps = 1.0f / 3.6f;
+        static const float ang_to_rad = nya_math::constants::pi / 180.0f;
+
+        typedef void (*setter)(arms_param &p, float v);
+        static const struct { const char *section, *field; bool is_int; setter set; } fields[] =
+        {
+            { "action", "noAcceleTime", false, [](arms_param &p, float v) { p.no_accel_time = v * 1000.0f; } },
+            { "action", "accele", false, [](arms_param &p, float v) { p.accel = v * kmph_to_meps; } },
+            { "action", "speedInit", false, [](arms_param &p, float v) { p.speed_init = v * kmph_to_meps; } },
+            { "action", "speedMax", false, [](arms_param &p, float v) { p.speed_max = v * kmph_to_meps; } },
+            { "action", "gravity", false, [](arms_param &p, float v) { p.gravity = v; } },
+            { "action", "rotAngMax", false, [](arms_param &p, float v) { p.rot_max = v * ang_to_rad; } },
+            { "action", "rotAngMaxHi", false, [](arms_param &p, float v) { p.rot_max_hi = v * ang_to_rad; } },
+            { "action", "rotAngMaxLow", false, [](arms_param &p, float v) { p.rot_max_low = v * ang_to_rad; } },
+            { "action", "endTime", false, [](arms_param &p, float v) { p.end_time = v * 1000.0f; } },
+            { "action", "hormingAng", false, [](arms_param &p, float v) { p.homing_angle = v; } },
+            { "action", "range", false, [](arms_param &p, float v) { p.range = v; } },
+            { "lockon", "range", false, [](arms_param &p, float v) { p.lockon_range = v; } },
+            { "lockon", "angle", false, [](arms_param &p, float v) { p.lockon_angle = v * ang_to_rad; } },
+            { "lockon", "lockonNum", false, [](arms_param &p, float v) { p.lockon_count = int(v); } },
+            { "lockon", "target_air", true, [](arms_param &p, float v) { p.lockon_air = v > 0.0f; } },
+            { "lockon", "target_grd", true, [](arms_param &p, float v) { p.lockon_ground = v > 0.0f; } },
+            { "lockon", "reload", false, [](arms_param &p, float v) { p.reload_time = v * 1000.0f; } },
+            { "lockon_dfm", "timeLockon", false, [](arms_param &p, float v) { p.lockon_time = v * 1000.0f; } },
+        };
+
+        for (auto &f: fields)
+        {
+            if (f.is_int == is_int && section == f.section && field == f.field)
+            {
+                f.set(params[id], value);
+                return;
+            }
+        }
+    }
+
+private:
+    typedef std::pair<std::string, arms_param> entry;
+    std::vector<entry> m_params; //sorted by id
+};
+
+//------------------------------------------------------------
+}
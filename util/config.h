@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,6 +23,7 @@ class config
 public:
     static void register_var(const std::string &name, const std::string &value)
     {
+        std::lock_guard<std::mutex> lock(cfg().m_mutex);
         auto p = cfg().m_params.find(name);
         if (p == cfg().m_params.end())
         {
@@ -32,6 +34,7 @@ public:
 
     static void set_var(const std::string &name, const std::string &value)
     {
+        std::lock_guard<std::mutex> lock(cfg().m_mutex);
         auto p = cfg().m_params.find(name);
         if (p != cfg().m_params.end() && p->second != value)
         {
@@ -42,6 +45,7 @@ public:
 
     static std::string get_var(const std::string &name)
     {
+        std::lock_guard<std::mutex> lock(cfg().m_mutex); //matches read it from their threads
         auto p = cfg().m_params.find(name);
         if (p == cfg().m_params.end())
             return "";
@@ -151,4 +155,5 @@ private:
 private:
     std::map<std::string, std::string> m_params;
     bool m_changed = false;
+    std::mutex m_mutex;
 };
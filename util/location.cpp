@@ -3,36 +3,51 @@
 //
 
 #include "location.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+//------------------------------------------------------------
+
+namespace
+{
+std::mutex &get_mutex() { static std::mutex m; return m; }
+}
 
 //------------------------------------------------------------
 
 bool is_native_location(std::string name)
 {
-    static std::string cache;
-    if (cache == name)
-        return true;
+    static std::set<std::string> cache;
 
-    if (nya_resources::get_resources_provider().has(("locations/" + name).c_str()))
-    {
-        cache = name;
+    std::lock_guard<std::mutex> lock(get_mutex());
+    if (cache.find(name) != cache.end())
         return true;
-    }
 
-    return false;
+    if (!nya_resources::get_resources_provider().has(("locations/" + name).c_str()))
+        return false;
+
+    cache.insert(name);
+    return true;
 }
 
 //------------------------------------------------------------
 
 nya_resources::zip_resources_provider &get_native_location_provider(std::string name)
 {
-    static std::string cache;
-    static nya_resources::zip_resources_provider zprov;
-    if (cache == name)
-        return zprov;
-
-    zprov.close_archive();
-    zprov.open_archive(("locations/" + name).c_str());
-    return zprov;
+    //one per location, kept open for the other matches
+    static std::map<std::string, std::unique_ptr<nya_resources::zip_resources_provider> > providers;
+
+    std::lock_guard<std::mutex> lock(get_mutex());
+    auto &zprov = providers[name];
+    if (!zprov)
+    {
+        zprov.reset(new nya_resources::zip_resources_provider());
+        zprov->open_archive(("locations/" + name).c_str());
+    }
+
+    return *zprov;
 }
 
 //------------------------------------------------------------
@@ -6,6 +6,17 @@
 #include "GLFW/glfw3.h"
 #include "render/render.h"
 
+#if defined _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+    #pragma comment(lib, "psapi.lib")
+#elif defined __APPLE__
+    #include <mach/mach.h>
+#else
+    #include <stdio.h>
+    #include <unistd.h>
+#endif
+
 //------------------------------------------------------------
 
 std::map<int, bool> platform::m_buttons;
@@ -13,7 +24,7 @@ platform::key_callback platform::m_key_callback;
 
 //------------------------------------------------------------
 
-bool platform::init(int width, int height, const char *title)
+bool platform::init(int width, int height, const char *title, bool visible)
 {
     if (!glfwInit())
         return false;
@@ -26,6 +37,7 @@ bool platform::init(int width, int height, const char *title)
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     }
 
+    glfwWindowHint(GLFW_VISIBLE, visible ? GL_TRUE : GL_FALSE);
     glfwSwapInterval(1);
 
     /*
@@ -178,3 +190,32 @@ void platform::key_func(GLFWwindow *, int key, int scancode, int action, int mod
 }
 
 //------------------------------------------------------------
+
+size_t platform::get_memory_usage()
+{
+#if defined _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return 0;
+
+    return pmc.WorkingSetSize;
+#elif defined __APPLE__
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+        return 0;
+
+    return info.resident_size;
+#else
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+
+    long pages = 0, resident = 0;
+    const bool read = fscanf(f, "%ld %ld", &pages, &resident) == 2;
+    fclose(f);
+    return read ? size_t(resident) * sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
+
+//------------------------------------------------------------
@@ -15,7 +15,7 @@ struct GLFWwindow;
 class platform
 {
 public:
-    bool init(int width, int height, const char *title);
+    bool init(int width, int height, const char *title, bool visible = true); //hidden is only for the gl context
     void terminate();
     bool should_terminate();
     void end_frame();
@@ -37,6 +37,8 @@ public:
     static std::string open_folder_dialog();
     static bool show_msgbox(std::string message);
 
+    static size_t get_memory_usage(); //resident bytes, 0 if unknown
+
     platform(): m_window(0) {}
 
 private:
@@ -0,0 +1,279 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <stdio.h>
+
+namespace profiler
+{
+//------------------------------------------------------------
+
+std::atomic<bool> enabled_flag(false);
+
+//------------------------------------------------------------
+
+namespace
+{
+struct record
+{
+    std::atomic<const char *> name;
+    std::atomic<uint64_t> start_us, end_us;
+};
+
+struct record_copy
+{
+    const char *name;
+    uint64_t start_us, end_us;
+};
+
+//written by one thread without locks, readers drop the records overwritten while they read
+struct thread_ring
+{
+    static const size_t size = 1 << 15;
+
+    std::unique_ptr<record[]> records;
+    std::atomic<size_t> started; //pushes begun, a seqlock for the overwritten slot
+    std::atomic<size_t> count;
+    std::atomic<size_t> cleared;
+    unsigned int thread_idx = 0;
+
+    thread_ring(): records(new record[size]), started(0), count(0), cleared(0) {}
+
+    void push(const char *name, uint64_t start_us, uint64_t end_us)
+    {
+        const size_t idx = count.load(std::memory_order_relaxed);
+        started.store(idx + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        auto &r = records[idx % size];
+        r.name.store(name, std::memory_order_relaxed);
+        r.start_us.store(start_us, std::memory_order_relaxed);
+        r.end_us.store(end_us, std::memory_order_relaxed);
+        count.store(idx + 1, std::memory_order_release);
+    }
+
+    template<typename f> void for_each(f func)
+    {
+        const size_t last = count.load(std::memory_order_acquire);
+        const size_t first = std::max(last > size ? last - size : 0, cleared.load(std::memory_order_relaxed));
+
+        std::vector<record_copy> copy;
+        copy.reserve(last - std::min(first, last));
+        for (size_t i = first; i < last; ++i)
+        {
+            const auto &r = records[i % size];
+            copy.push_back({r.name.load(std::memory_order_relaxed), r.start_us.load(std::memory_order_relaxed), r.end_us.load(std::memory_order_relaxed)});
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const size_t now = started.load(std::memory_order_relaxed);
+        const size_t valid = now > size ? now - size : 0;
+        for (size_t i = std::max(first, valid); i < last; ++i)
+            func(copy[i - first]);
+    }
+
+    void clear() { cleared.store(count.load(std::memory_order_acquire), std::memory_order_relaxed); }
+};
+
+//rings of exited threads are reused by new ones, their records stay readable until then
+const size_t max_rings = 64;
+
+struct rings
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<thread_ring> > list;
+    std::vector<thread_ring *> free;
+    std::set<std::string> names;
+};
+
+rings &get_rings() { static rings r; return r; }
+
+struct thread_ring_holder
+{
+    thread_ring *ring = 0;
+    bool acquired = false;
+
+    thread_ring *get()
+    {
+        if (acquired)
+            return ring;
+
+        acquired = true;
+
+        auto &r = get_rings();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.free.empty())
+        {
+            ring = r.free.back();
+            r.free.pop_back();
+        }
+        else if (r.list.size() < max_rings)
+        {
+            r.list.emplace_back(new thread_ring());
+            ring = r.list.back().get();
+            ring->thread_idx = (unsigned int)r.list.size() - 1;
+        }
+        else
+            printf("profiler: more than %d threads, records dropped\n", (int)max_rings);
+
+        return ring;
+    }
+
+    ~thread_ring_holder()
+    {
+        if (!ring)
+            return;
+
+        auto &r = get_rings();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.free.push_back(ring);
+    }
+};
+
+thread_ring *get_thread_ring()
+{
+    static thread_local thread_ring_holder holder;
+    return holder.get();
+}
+
+std::vector<thread_ring *> get_rings_list()
+{
+    auto &r = get_rings();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<thread_ring *> list;
+    for (auto &ring: r.list)
+        list.push_back(ring.get());
+    return list;
+}
+}
+
+//------------------------------------------------------------
+
+void set_enabled(bool enabled)
+{
+    if (enabled && !is_enabled())
+        clear();
+
+    enabled_flag.store(enabled);
+}
+
+//------------------------------------------------------------
+
+uint64_t get_time_us()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+//------------------------------------------------------------
+
+const char *intern(const char *name)
+{
+    if (!name)
+        return "";
+
+    auto &r = get_rings();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.names.insert(name).first->c_str();
+}
+
+//------------------------------------------------------------
+
+void add_record(const char *name, uint64_t start_us, uint64_t end_us)
+{
+    auto ring = get_thread_ring();
+    if (ring)
+        ring->push(name, start_us, end_us);
+}
+
+//------------------------------------------------------------
+
+void get_top(size_t count, uint64_t window_us, std::vector<scope_stats> &result)
+{
+    result.clear();
+
+    const uint64_t now = get_time_us();
+    const uint64_t from = now > window_us ? now - window_us : 0;
+
+    std::unordered_map<const char *, scope_stats> stats;
+    for (auto &ring: get_rings_list())
+    {
+        ring->for_each([&stats, from](const record_copy &r)
+        {
+            if (r.start_us < from)
+                return;
+
+            auto &s = stats[r.name];
+            s.name = r.name;
+            const uint64_t time = r.end_us - r.start_us;
+            s.total_us += time;
+            s.max_us = std::max(s.max_us, time);
+            ++s.calls;
+        });
+    }
+
+    for (auto &s: stats)
+        result.push_back(s.second);
+
+    std::sort(result.begin(), result.end(), [](const scope_stats &a, const scope_stats &b) { return a.total_us > b.total_us; });
+    if (result.size() > count)
+        result.resize(count);
+}
+
+//------------------------------------------------------------
+
+bool write_chrome_trace(const char *file_name)
+{
+    if (!file_name)
+        return false;
+
+    FILE *f = fopen(file_name, "wb");
+    if (!f)
+    {
+        printf("unable to write profiler trace %s\n", file_name);
+        return false;
+    }
+
+    fprintf(f, "{\"traceEvents\":[\n");
+
+    bool first = true;
+    for (auto &ring: get_rings_list())
+    {
+        const unsigned int tid = ring->thread_idx;
+        ring->for_each([f, tid, &first](const record_copy &r)
+        {
+            std::string name;
+            for (const char *c = r.name; *c; ++c)
+            {
+                if (*c == '"' || *c == '\\')
+                    name.push_back('\\');
+                name.push_back(*c);
+            }
+
+            fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}",
+                    first ? "" : ",\n", name.c_str(), tid, (unsigned long long)r.start_us, (unsigned long long)(r.end_us - r.start_us));
+            first = false;
+        });
+    }
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    return true;
+}
+
+//------------------------------------------------------------
+
+void clear()
+{
+    for (auto &ring: get_rings_list())
+        ring->clear();
+}
+
+//------------------------------------------------------------
+}
@@ -0,0 +1,94 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+//------------------------------------------------------------
+
+namespace profiler
+{
+//------------------------------------------------------------
+
+struct scope_stats
+{
+    const char *name = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    unsigned int calls = 0;
+};
+
+//------------------------------------------------------------
+
+extern std::atomic<bool> enabled_flag;
+
+inline bool is_enabled() { return enabled_flag.load(std::memory_order_relaxed); }
+void set_enabled(bool enabled);
+
+uint64_t get_time_us();
+
+//names are stored by pointer, pass literals or interned names
+const char *intern(const char *name);
+
+//writes to the calling thread's ring, old records are overwritten
+void add_record(const char *name, uint64_t start_us, uint64_t end_us);
+
+//slowest scopes by total time over the last window_us, all threads
+void get_top(size_t count, uint64_t window_us, std::vector<scope_stats> &result);
+
+//chrome://tracing json
+bool write_chrome_trace(const char *file_name);
+
+void clear();
+
+//------------------------------------------------------------
+
+class scope
+{
+public:
+    explicit scope(const char *name, bool copy_name = false): m_name(0)
+    {
+        if (!is_enabled())
+            return;
+
+        m_name = copy_name ? intern(name) : name;
+        m_start = get_time_us();
+    }
+
+    ~scope()
+    {
+        if (m_name)
+            add_record(m_name, m_start, get_time_us());
+    }
+
+private:
+    scope(const scope &);
+    void operator = (const scope &);
+
+private:
+    const char *m_name;
+    uint64_t m_start = 0;
+};
+
+//------------------------------------------------------------
+}
+
+//------------------------------------------------------------
+
+#define profile_concat_impl(a, b) a##b
+#define profile_concat(a, b) profile_concat_impl(a, b)
+
+#ifdef NO_PROFILER
+    #define profile_scope(name)
+    #define profile_scope_dynamic(name)
+#else
+    #define profile_scope(name) profiler::scope profile_concat(profile_scope_, __LINE__)(name)
+    #define profile_scope_dynamic(name) profiler::scope profile_concat(profile_scope_, __LINE__)(name, true)
+#endif
+
+//------------------------------------------------------------
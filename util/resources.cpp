@@ -24,7 +24,7 @@ namespace { nya_resources::zip_resources_provider zprov; }
 
 //------------------------------------------------------------
 
-bool setup_resources()
+bool setup_resources(bool ask_path)
 {
 #ifndef _WIN32
     chdir(nya_system::get_app_path());
@@ -39,6 +39,12 @@ bool setup_resources()
                                       "Please specify the path to the Assault Horizon folder.\n"
                                       "It will be saved automatically.";
 
+        if (!ask_path)
+        {
+            printf("%s\nacah_path: %s\n", message, config::get_var("acah_path").c_str());
+            return false;
+        }
+
         if (platform::show_msgbox(message))
         {
             std::string folder = platform::open_folder_dialog();
@@ -6,7 +6,7 @@
 
 //------------------------------------------------------------
 
-bool setup_resources();
+bool setup_resources(bool ask_path = true); //ask for the Assault Horizon folder if not found
 bool set_zip_mod(const char *name);
 
 //------------------------------------------------------------
@@ -72,6 +72,30 @@ void script::add_callback(std::string name, callback f)
 
 //------------------------------------------------------------
 
+void script::set_user_data(void *data)
+{
+    if (!m_state)
+        return;
+
+    lua_pushlightuserdata(m_state, data);
+    lua_setfield(m_state, LUA_REGISTRYINDEX, "user_data");
+}
+
+//------------------------------------------------------------
+
+void *script::get_user_data(lua_State *state)
+{
+    if (!state)
+        return 0;
+
+    lua_getfield(state, LUA_REGISTRYINDEX, "user_data");
+    void *data = lua_touserdata(state, -1);
+    lua_pop(state, 1);
+    return data;
+}
+
+//------------------------------------------------------------
+
 int script::get_args_count(lua_State *state)
 {
     if (!state)
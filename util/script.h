@@ -20,6 +20,8 @@ public:
 
     typedef int(*callback)(lua_State *);
     void add_callback(std::string name, callback f);
+    void set_user_data(void *data);
+    static void *get_user_data(lua_State *s); //in callbacks
     static int get_args_count(lua_State *s);
     static std::string get_string(lua_State *s, int arg_idx);
     static int get_int(lua_State *s, int arg_idx);
@@ -0,0 +1,237 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include "math/vector.h"
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+#include <math.h>
+
+//------------------------------------------------------------
+
+//objects of a hash area kept up to date by spatial_hash::track
+
+template<typename t> struct spatial_hash_area
+{
+    struct item { const void *id; t value; };
+    std::vector<item> items;
+
+    int x0 = 0, z0 = 0, x1 = -1, z1 = -1;
+    uint64_t change = 0; //next change to apply
+    bool valid = false;
+
+    bool contains(int x, int z) const { return x >= x0 && x <= x1 && z >= z0 && z <= z1; }
+    void reset() { items.clear(); valid = false; }
+};
+
+//------------------------------------------------------------
+
+template<typename t> class spatial_hash //xz grid of points, updated incrementally
+{
+public:
+    //call update for every alive object between begin_update and end_update
+    void begin_update() { ++m_update; }
+
+    void update(const void *id, const t &value, const nya_math::vec3 &pos)
+    {
+        const auto key = get_key(pos.x, pos.z);
+        auto e = m_entries.find(id);
+        if (e == m_entries.end())
+        {
+            entry &ne = m_entries[id];
+            ne.cell = key;
+            ne.update = m_update;
+            m_cells[key].push_back({id, value});
+            m_changes.push_back({id, value, key, key, false, true});
+            return;
+        }
+
+        e->second.update = m_update;
+        if (e->second.cell == key)
+            return;
+
+        m_changes.push_back({id, value, e->second.cell, key, true, true});
+        remove_from_cell(e->second.cell, id);
+        e->second.cell = key;
+        m_cells[key].push_back({id, value});
+    }
+
+    void end_update()
+    {
+        for (auto e = m_entries.begin(); e != m_entries.end();)
+        {
+            if (e->second.update == m_update)
+            {
+                ++e;
+                continue;
+            }
+
+            remove_from_cell(e->second.cell, e->first);
+            m_changes.push_back({e->first, t(), e->second.cell, e->second.cell, true, false});
+            e = m_entries.erase(e);
+        }
+    }
+
+    void clear() { m_entries.clear(); m_cells.clear(); clear_changes(); }
+
+    //cell changes are kept for track until cleared, areas tracked since then are rebuilt
+    void clear_changes() { m_changes_base += m_changes.size(); m_changes.clear(); }
+
+    //objects of the cells around pos, only the changes are applied while the area stays the same
+    template<typename r> void track(const nya_math::vec3 &pos, float radius, spatial_hash_area<r> &area) const
+    {
+        const int x0 = get_cell(pos.x - radius), z0 = get_cell(pos.z - radius);
+        const int x1 = get_cell(pos.x + radius), z1 = get_cell(pos.z + radius);
+        const uint64_t changes_end = m_changes_base + m_changes.size();
+
+        if (!area.valid || area.change < m_changes_base || area.x0 != x0 || area.z0 != z0 || area.x1 != x1 || area.z1 != z1)
+        {
+            area.x0 = x0, area.z0 = z0, area.x1 = x1, area.z1 = z1;
+            area.items.clear();
+            for_each_cell(x0, z0, x1, z1, [&area](const std::vector<item> &items)
+            {
+                for (auto &i: items)
+                    area.items.push_back({i.id, i.value});
+            });
+
+            area.change = changes_end;
+            area.valid = true;
+            return;
+        }
+
+        for (size_t i = size_t(area.change - m_changes_base); i < m_changes.size(); ++i)
+        {
+            const auto &c = m_changes[i];
+            const bool was = c.has_from && area.contains(key_x(c.from), key_z(c.from));
+            const bool is = c.has_to && area.contains(key_x(c.to), key_z(c.to));
+            if (was == is)
+                continue;
+
+            if (is)
+            {
+                area.items.push_back({c.id, c.value});
+                continue;
+            }
+
+            for (size_t j = 0; j < area.items.size(); ++j)
+            {
+                if (area.items[j].id != c.id)
+                    continue;
+
+                area.items[j] = area.items.back();
+                area.items.pop_back();
+                break;
+            }
+        }
+
+        area.change = changes_end;
+    }
+
+    //coarse, returns everything from the cells intersecting the area
+    bool get_objects(const nya_math::vec3 &pos, float radius, std::vector<t> &result) const
+    {
+        return get_objects(pos.x - radius, pos.z - radius, pos.x + radius, pos.z + radius, result);
+    }
+
+    bool get_objects(const nya_math::vec3 &from, const nya_math::vec3 &to, float radius, std::vector<t> &result) const
+    {
+        return get_objects(fminf(from.x, to.x) - radius, fminf(from.z, to.z) - radius,
+                           fmaxf(from.x, to.x) + radius, fmaxf(from.z, to.z) + radius, result);
+    }
+
+    size_t get_count() const { return m_entries.size(); }
+
+    spatial_hash(float cell_size = 1000.0f): m_cell_size(cell_size) {}
+
+private:
+    typedef int64_t cell_key;
+
+    //clamped, nan goes to the cell 0
+    int get_cell(float v) const
+    {
+        const float max_cell = float(1 << 24), c = floorf(v / m_cell_size);
+        return c > -max_cell ? (c < max_cell ? int(c) : int(max_cell)) : (c == c ? -int(max_cell) : 0);
+    }
+
+    static cell_key make_key(int x, int z) { return cell_key((uint64_t(uint32_t(x)) << 32) | uint32_t(z)); }
+    static int key_x(cell_key k) { return int(int32_t(uint64_t(k) >> 32)); }
+    static int key_z(cell_key k) { return int(int32_t(k & 0xffffffff)); }
+    cell_key get_key(float x, float z) const { return make_key(get_cell(x), get_cell(z)); }
+
+    bool get_objects(float min_x, float min_z, float max_x, float max_z, std::vector<t> &result) const
+    {
+        result.clear();
+        for_each_cell(get_cell(min_x), get_cell(min_z), get_cell(max_x), get_cell(max_z), [&result](const std::vector<item> &items)
+        {
+            for (auto &i: items)
+                result.push_back(i.value);
+        });
+
+        return !result.empty();
+    }
+
+    template<typename f> void for_each_cell(int cx0, int cz0, int cx1, int cz1, const f &func) const
+    {
+        if ((int64_t(cx1) - cx0 + 1) * (int64_t(cz1) - cz0 + 1) > (int64_t)m_cells.size())
+        {
+            for (auto &c: m_cells)
+            {
+                const int x = key_x(c.first), z = key_z(c.first);
+                if (x < cx0 || x > cx1 || z < cz0 || z > cz1)
+                    continue;
+
+                func(c.second);
+            }
+
+            return;
+        }
+
+        for (int x = cx0; x <= cx1; ++x)
+        {
+            for (int z = cz0; z <= cz1; ++z)
+            {
+                auto c = m_cells.find(make_key(x, z));
+                if (c != m_cells.end())
+                    func(c->second);
+            }
+        }
+    }
+
+    void remove_from_cell(cell_key key, const void *id)
+    {
+        auto c = m_cells.find(key);
+        if (c == m_cells.end())
+            return;
+
+        auto &items = c->second;
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            if (items[i].id != id)
+                continue;
+
+            items[i] = items.back();
+            items.pop_back();
+            break;
+        }
+
+        if (items.empty())
+            m_cells.erase(c);
+    }
+
+private:
+    struct item { const void *id; t value; };
+    struct entry { cell_key cell; unsigned int update; };
+    struct change { const void *id; t value; cell_key from, to; bool has_from, has_to; };
+
+    std::unordered_map<const void *, entry> m_entries;
+    std::unordered_map<cell_key, std::vector<item> > m_cells;
+    std::vector<change> m_changes;
+    uint64_t m_changes_base = 0;
+    float m_cell_size;
+    unsigned int m_update = 0;
+};
+
+//------------------------------------------------------------
@@ -0,0 +1,49 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <utility>
+
+//------------------------------------------------------------
+
+template<typename t, size_t capacity> class spsc_queue //single writer, single reader, lock-free
+{
+    static_assert(capacity && !(capacity & (capacity - 1)), "capacity should be power of two");
+
+public:
+    //false if the queue is full, value is left untouched
+    bool push(t &&value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= capacity)
+            return false;
+
+        m_items[tail & (capacity - 1)] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //false if there's nothing to pop
+    bool pop(t &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        value = std::move(m_items[head & (capacity - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+private:
+    t m_items[capacity];
+    std::atomic<size_t> m_head{0}, m_tail{0};
+};
+
+//------------------------------------------------------------
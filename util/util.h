@@ -492,3 +492,20 @@ inline float random(float from, float to) { return from + (to - from) * float(ra
 inline int random(int from, int to) { return from +  rand() % (to - from + 1); }
 
 //------------------------------------------------------------
+
+//deterministic sequence for the simulation, rand() is also consumed by the renderer and hud
+
+class random_sequence
+{
+public:
+    void seed(uint32_t s) { m_state = s ? s : default_seed; }
+    uint32_t next() { m_state ^= m_state << 13; m_state ^= m_state >> 17; m_state ^= m_state << 5; return m_state; }
+    uint32_t get(uint32_t count) { return count ? next() % count : 0; } //0..count-1
+    int get(int from, int to) { return from + int(get(uint32_t(to - from + 1))); }
+
+private:
+    enum { default_seed = 0x9e3779b9 };
+    uint32_t m_state = default_seed;
+};
+
+//------------------------------------------------------------
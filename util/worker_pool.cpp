@@ -0,0 +1,101 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#include "worker_pool.h"
+
+//------------------------------------------------------------
+
+void worker_pool::set_workers(int count)
+{
+    if (count < 0)
+        count = 0;
+
+    if (count == (int)m_threads.size())
+        return;
+
+    if (!m_threads.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+
+        m_start.notify_all();
+        for (auto &t: m_threads)
+            t.join();
+        m_threads.clear();
+        m_quit = false;
+    }
+
+    //new threads wait for the next round, not the ones already run
+    unsigned int generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        generation = m_generation;
+    }
+
+    for (int i = 0; i < count; ++i)
+        m_threads.push_back(std::thread(&worker_pool::work, this, generation));
+}
+
+//------------------------------------------------------------
+
+void worker_pool::run(size_t count, const std::function<void(size_t)> &job)
+{
+    if (m_threads.empty() || count < 2)
+    {
+        for (size_t i = 0; i < count; ++i)
+            job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_count = count;
+        m_next = 0;
+        m_working = m_threads.size();
+        ++m_generation;
+    }
+
+    m_start.notify_all();
+    run_jobs();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]{ return m_working == 0; });
+    m_job = 0;
+}
+
+//------------------------------------------------------------
+
+void worker_pool::run_jobs()
+{
+    for (size_t i = m_next++; i < m_count; i = m_next++)
+        (*m_job)(i);
+}
+
+//------------------------------------------------------------
+
+void worker_pool::work(unsigned int generation)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, &generation]{ return m_quit || m_generation != generation; });
+            if (m_quit)
+                return;
+
+            generation = m_generation;
+        }
+
+        run_jobs();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_working == 0)
+            m_done.notify_one();
+    }
+}
+
+//------------------------------------------------------------
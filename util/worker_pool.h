@@ -0,0 +1,50 @@
+//
+// open horizon -- undefined_darkness@outlook.com
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------
+
+//persistent threads for indexed jobs, the calling thread works too
+
+class worker_pool
+{
+public:
+    void set_workers(int count); //threads besides the calling one, 0 to run everything on it
+    int get_workers() const { return (int)m_threads.size(); }
+
+    //job is called once for every index in 0..count-1, returns when all are done
+    void run(size_t count, const std::function<void(size_t)> &job);
+
+    worker_pool() {}
+    ~worker_pool() { set_workers(0); }
+
+private:
+    worker_pool(const worker_pool &);
+    void operator = (const worker_pool &);
+
+    void work(unsigned int generation);
+    void run_jobs();
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start, m_done;
+    unsigned int m_generation = 0;
+    size_t m_working = 0;
+    bool m_quit = false;
+
+    const std::function<void(size_t)> *m_job = 0;
+    size_t m_count = 0;
+    std::atomic<size_t> m_next{0};
+};
+
+//------------------------------------------------------------